@@ -17,6 +17,8 @@
 
 #include <llarp/service/name.hpp>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdlib>
 #include <ios>
@@ -52,6 +54,10 @@ namespace llarp
     constexpr Default DefaultJobQueueSize{1024 * 8};
     constexpr Default DefaultWorkerThreads{0};
     constexpr Default DefaultBlockBogons{true};
+    constexpr Default DefaultBatchedUDP{true};
+    constexpr Default DefaultOutboundControlWeight{4};
+    constexpr Default DefaultOutboundTransitWeight{1};
+    constexpr Default DefaultOutboundLocalWeight{1};
 
     conf.defineOption<int>(
         "router", "job-queue-size", DefaultJobQueueSize, Hidden, [this](int arg) {
@@ -196,6 +202,40 @@ namespace llarp
     conf.defineOption<bool>(
         "router", "block-bogons", DefaultBlockBogons, Hidden, AssignmentAcceptor(m_blockBogons));
 
+    // Hidden option to fall back to libuv's udp handles, which do one syscall per datagram.  Only
+    // has an effect on linux where we otherwise read and write udp in batches.
+    conf.defineOption<bool>(
+        "router", "batched-udp", DefaultBatchedUDP, Hidden, AssignmentAcceptor(m_batchedUDP));
+
+    // Hidden options for the share of outbound bytes each traffic class gets when they compete:
+    // control messages off any path, transit traffic on paths we are a hop on, and traffic on our
+    // own paths.
+    const auto weight = [](const char* name, uint32_t& out) {
+      return [name, &out](int arg) {
+        if (arg < 1 or arg > 1000)
+          throw std::invalid_argument{fmt::format("{} must be between 1 and 1000", name)};
+        out = arg;
+      };
+    };
+    conf.defineOption<int>(
+        "router",
+        "outbound-control-weight",
+        DefaultOutboundControlWeight,
+        Hidden,
+        weight("outbound-control-weight", m_outboundControlWeight));
+    conf.defineOption<int>(
+        "router",
+        "outbound-transit-weight",
+        DefaultOutboundTransitWeight,
+        Hidden,
+        weight("outbound-transit-weight", m_outboundTransitWeight));
+    conf.defineOption<int>(
+        "router",
+        "outbound-local-weight",
+        DefaultOutboundLocalWeight,
+        Hidden,
+        weight("outbound-local-weight", m_outboundLocalWeight));
+
     constexpr auto relative_to_datadir =
         "An absolute path is used as-is, otherwise relative to 'data-dir'.";
 
@@ -613,6 +653,32 @@ namespace llarp
         },
         AssignmentAcceptor(m_ifname));
 
+    conf.defineOption<int>(
+        "network",
+        "ifqueues",
+        Default{1},
+        Comment{
+            "How many packet queues to open on the lokinet interface. On linux more than one",
+            "opens a multi queue tun device with a thread reading each queue, which helps exit",
+            "nodes and clients pushing a lot of traffic. Other platforms always use one.",
+        },
+        [this](int arg) {
+          if (arg < 1)
+            throw std::invalid_argument{"[network]:ifqueues must be at least 1"};
+          m_ifQueues = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "ifoffload",
+        Default{false},
+        Comment{
+            "Let the kernel hand lokinet whole tcp send windows at once and leave checksums to",
+            "lokinet instead of passing it one packet at a time. Cuts the cost of bulk tcp",
+            "traffic on linux, ignored on other platforms.",
+        },
+        AssignmentAcceptor(m_ifOffload));
+
     conf.defineOption<std::string>(
         "network",
         "ifaddr",
@@ -1309,6 +1375,37 @@ namespace llarp
     return true;
   }
 
+  bool
+  PeerSelectionConfig::Acceptable(
+      const path::HopSelectionKey& candidate,
+      const path::HopSelectionKey* hops,
+      size_t numHops) const
+  {
+    if (m_UniqueHopsNetmaskSize == 0)
+      return true;
+    const auto netmask = netmask_ipv6_bits(96 + m_UniqueHopsNetmaskSize);
+    // a path's hops plus the candidate fit in here with room to spare
+    std::array<huint128_t, (path::max_len + 1) * path::HopSelectionKey::MaxAddrs> seenRanges;
+    size_t numSeen = 0;
+    auto add = [&](const path::HopSelectionKey& hop) -> bool {
+      for (size_t idx = 0; idx < hop.numAddrs; ++idx)
+      {
+        const auto network_addr = hop.addrs[idx] & netmask;
+        const auto end = seenRanges.begin() + numSeen;
+        if (numSeen == seenRanges.size() or std::find(seenRanges.begin(), end, network_addr) != end)
+          return false;
+        seenRanges[numSeen++] = network_addr;
+      }
+      return true;
+    };
+    for (size_t idx = 0; idx < numHops; ++idx)
+    {
+      if (not add(hops[idx]))
+        return false;
+    }
+    return add(candidate);
+  }
+
   std::unique_ptr<ConfigGenParameters>
   Config::MakeGenParams() const
   {
@@ -14,6 +14,7 @@
 #include <llarp/net/ip_address.hpp>
 #include <llarp/net/net_int.hpp>
 #include <llarp/net/ip_range_map.hpp>
+#include <llarp/path/hop_selection.hpp>
 #include <llarp/service/address.hpp>
 #include <llarp/service/auth.hpp>
 #include <llarp/dns/srv_data.hpp>
@@ -70,6 +71,13 @@ namespace llarp
 
     size_t m_JobQueueSize = 0;
 
+    bool m_batchedUDP = true;
+
+    /// outbound message weights of the control, transit and local traffic classes
+    uint32_t m_outboundControlWeight = 4;
+    uint32_t m_outboundTransitWeight = 1;
+    uint32_t m_outboundLocalWeight = 1;
+
     std::string m_routerContactFile;
     std::string m_encryptionKeyFile;
     std::string m_identityKeyFile;
@@ -102,6 +110,14 @@ namespace llarp
     /// return true if this set of router contacts is acceptable against this config
     bool
     Acceptable(const std::set<RouterContact>& hops) const;
+
+    /// return true if candidate can join the numHops hops without breaking our rules, the same
+    /// check as above but done on cached selection keys without allocating
+    bool
+    Acceptable(
+        const path::HopSelectionKey& candidate,
+        const path::HopSelectionKey* hops,
+        size_t numHops) const;
   };
 
   struct NetworkConfig
@@ -111,6 +127,8 @@ namespace llarp
     std::set<RouterID> m_strictConnect;
     std::string m_ifname;
     IPRange m_ifaddr;
+    size_t m_ifQueues = 1;
+    bool m_ifOffload = false;
 
     std::optional<fs::path> m_keyfile;
     std::string m_endpointType;
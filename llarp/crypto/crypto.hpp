@@ -18,6 +18,14 @@
 
 namespace llarp
 {
+  /// one buffer of a batched symmetric crypt, crypted in place with its own nonce
+  struct CryptBatchItem
+  {
+    byte_t* data;
+    size_t size;
+    TunnelNonce nonce;
+  };
+
   /// library crypto configuration
   struct Crypto
   {
@@ -36,6 +44,11 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher over many buffers that share one key, does the same as calling
+    /// xchacha20 on each of them but lets the implementation crypt several at once
+    virtual bool
+    xchacha20_batch(const SharedSecret&, const CryptBatchItem* items, size_t num) = 0;
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
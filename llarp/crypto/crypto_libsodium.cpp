@@ -1,4 +1,5 @@
 #include "crypto_libsodium.hpp"
+#include "xchacha20_batch.hpp"
 #include <sodium/crypto_generichash.h>
 #include <sodium/crypto_sign.h>
 #include <sodium/crypto_scalarmult.h>
@@ -11,6 +12,7 @@
 #include <oxenc/endian.h>
 #include <llarp/util/mem.hpp>
 #include <llarp/util/str.hpp>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #ifdef HAVE_CRYPT
@@ -94,6 +96,9 @@ namespace llarp
       else
       {
         ntru_init(0);
+#ifdef LOKINET_XCHACHA20_AVX2
+        m_BatchAVX2 = __builtin_cpu_supports("avx2");
+#endif
       }
       int seed = 0;
       randombytes(reinterpret_cast<unsigned char*>(&seed), sizeof(seed));
@@ -149,6 +154,31 @@ namespace llarp
       return crypto_stream_xchacha20_xor(out.base, in.base, in.sz, n, k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_batch(
+        const SharedSecret& k, const CryptBatchItem* items, size_t num)
+    {
+#ifdef LOKINET_XCHACHA20_AVX2
+      // libsodium already goes wide on a single long buffer, the win here is crypting many short
+      // ones at once so we only bother while at least half the lanes have something to do
+      while (m_BatchAVX2 and num >= XChaCha20Lanes / 2)
+      {
+        const auto n = std::min(num, XChaCha20Lanes);
+        xchacha20_batch_avx2(k, items, n);
+        items += n;
+        num -= n;
+      }
+#endif
+      for (; num > 0; ++items, --num)
+      {
+        if (crypto_stream_xchacha20_xor(
+                items->data, items->data, items->size, items->nonce.data(), k.data())
+            != 0)
+          return false;
+      }
+      return true;
+    }
+
     bool
     CryptoLibSodium::dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
@@ -29,6 +29,10 @@ namespace llarp
           const SharedSecret&,
           const byte_t*) override;
 
+      /// xchacha symmetric cipher over many buffers sharing one key
+      bool
+      xchacha20_batch(const SharedSecret&, const CryptBatchItem* items, size_t num) override;
+
       /// path dh creator's side
       bool
       dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
@@ -107,6 +111,10 @@ namespace llarp
 
       bool
       check_passwd_hash(std::string pwhash, std::string challenge) override;
+
+     private:
+      /// set if we can crypt batches with the avx2 multi buffer xchacha20
+      bool m_BatchAVX2 = false;
     };
   }  // namespace sodium
 
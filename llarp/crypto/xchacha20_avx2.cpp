@@ -0,0 +1,218 @@
+#include "xchacha20_batch.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// This file is only compiled (with -mavx2) when the compiler supports avx2; CryptoLibSodium checks
+// that the cpu we run on does before calling into it.
+
+namespace llarp::sodium
+{
+  namespace
+  {
+    /// one chacha state per lane, word i of every lane lives in vector i
+    struct Lanes_t
+    {
+      __m256i words[16];
+
+      __m256i&
+      operator[](size_t idx)
+      {
+        return words[idx];
+      }
+    };
+
+    inline __m256i
+    rotl(__m256i x, int n)
+    {
+      return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+    }
+
+    inline __m256i
+    rotl16(__m256i x)
+    {
+      const auto mask = _mm256_set_epi8(
+          13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+          13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+      return _mm256_shuffle_epi8(x, mask);
+    }
+
+    inline __m256i
+    rotl8(__m256i x)
+    {
+      const auto mask = _mm256_set_epi8(
+          14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+          14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+      return _mm256_shuffle_epi8(x, mask);
+    }
+
+    inline void
+    quarter_round(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+      a = _mm256_add_epi32(a, b);
+      d = rotl16(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = rotl(_mm256_xor_si256(b, c), 12);
+      a = _mm256_add_epi32(a, b);
+      d = rotl8(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = rotl(_mm256_xor_si256(b, c), 7);
+    }
+
+    /// the 20 chacha rounds on every lane
+    inline void
+    rounds(Lanes_t& x)
+    {
+      for (int i = 0; i < 10; ++i)
+      {
+        quarter_round(x[0], x[4], x[8], x[12]);
+        quarter_round(x[1], x[5], x[9], x[13]);
+        quarter_round(x[2], x[6], x[10], x[14]);
+        quarter_round(x[3], x[7], x[11], x[15]);
+        quarter_round(x[0], x[5], x[10], x[15]);
+        quarter_round(x[1], x[6], x[11], x[12]);
+        quarter_round(x[2], x[7], x[8], x[13]);
+        quarter_round(x[3], x[4], x[9], x[14]);
+      }
+    }
+
+    /// turn 8 vectors each holding one word of 8 lanes into 8 vectors each holding 8 words of
+    /// one lane
+    inline void
+    transpose(__m256i* v)
+    {
+      const auto t0 = _mm256_unpacklo_epi32(v[0], v[1]);
+      const auto t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+      const auto t2 = _mm256_unpacklo_epi32(v[2], v[3]);
+      const auto t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+      const auto t4 = _mm256_unpacklo_epi32(v[4], v[5]);
+      const auto t5 = _mm256_unpackhi_epi32(v[4], v[5]);
+      const auto t6 = _mm256_unpacklo_epi32(v[6], v[7]);
+      const auto t7 = _mm256_unpackhi_epi32(v[6], v[7]);
+
+      const auto u0 = _mm256_unpacklo_epi64(t0, t2);
+      const auto u1 = _mm256_unpackhi_epi64(t0, t2);
+      const auto u2 = _mm256_unpacklo_epi64(t1, t3);
+      const auto u3 = _mm256_unpackhi_epi64(t1, t3);
+      const auto u4 = _mm256_unpacklo_epi64(t4, t6);
+      const auto u5 = _mm256_unpackhi_epi64(t4, t6);
+      const auto u6 = _mm256_unpacklo_epi64(t5, t7);
+      const auto u7 = _mm256_unpackhi_epi64(t5, t7);
+
+      v[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+      v[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+      v[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+      v[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+      v[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+      v[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+      v[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+      v[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    /// load the 32 bit little endian word at offset off of every lane's nonce into one vector
+    inline __m256i
+    load_nonce_word(const std::array<const byte_t*, XChaCha20Lanes>& nonces, size_t off)
+    {
+      std::array<uint32_t, XChaCha20Lanes> words;
+      for (size_t lane = 0; lane < XChaCha20Lanes; ++lane)
+        std::memcpy(&words[lane], nonces[lane] + off, sizeof(uint32_t));
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words.data()));
+    }
+
+    /// xor len bytes of keystream into buf
+    inline void
+    xor_block(byte_t* buf, const byte_t* keystream, size_t len)
+    {
+      if (len == 64)
+      {
+        for (size_t off = 0; off < 64; off += 32)
+        {
+          auto* ptr = reinterpret_cast<__m256i*>(buf + off);
+          const auto ks = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keystream + off));
+          _mm256_storeu_si256(ptr, _mm256_xor_si256(_mm256_loadu_si256(ptr), ks));
+        }
+        return;
+      }
+      for (size_t idx = 0; idx < len; ++idx)
+        buf[idx] ^= keystream[idx];
+    }
+  }  // namespace
+
+  void
+  xchacha20_batch_avx2(const SharedSecret& k, const CryptBatchItem* items, size_t num)
+  {
+    static const TunnelNonce unused_nonce{};
+    num = std::min(num, XChaCha20Lanes);
+
+    std::array<const byte_t*, XChaCha20Lanes> lane_nonce;
+    size_t max_len = 0;
+    for (size_t lane = 0; lane < XChaCha20Lanes; ++lane)
+    {
+      lane_nonce[lane] = lane < num ? items[lane].nonce.data() : unused_nonce.data();
+      if (lane < num)
+        max_len = std::max(max_len, items[lane].size);
+    }
+
+    Lanes_t init;
+    init[0] = _mm256_set1_epi32(0x61707865);
+    init[1] = _mm256_set1_epi32(0x3320646e);
+    init[2] = _mm256_set1_epi32(0x79622d32);
+    init[3] = _mm256_set1_epi32(0x6b206574);
+    for (size_t word = 0; word < 8; ++word)
+    {
+      uint32_t key_word;
+      std::memcpy(&key_word, k.data() + (word * 4), sizeof(key_word));
+      init[4 + word] = _mm256_set1_epi32(key_word);
+    }
+
+    // hchacha20 over the first 16 bytes of every nonce gives us each lane's subkey
+    for (size_t word = 0; word < 4; ++word)
+      init[12 + word] = load_nonce_word(lane_nonce, word * 4);
+    Lanes_t x = init;
+    rounds(x);
+    for (size_t word = 0; word < 4; ++word)
+    {
+      init[4 + word] = x[word];
+      init[8 + word] = x[12 + word];
+    }
+
+    // then plain chacha20 with a 64 bit block counter and the last 8 bytes of the nonce
+    init[12] = _mm256_setzero_si256();
+    init[13] = _mm256_setzero_si256();
+    init[14] = load_nonce_word(lane_nonce, 16);
+    init[15] = load_nonce_word(lane_nonce, 20);
+
+    alignas(32) std::array<byte_t, 64 * XChaCha20Lanes> keystream;
+    for (uint64_t block = 0; block * 64 < max_len; ++block)
+    {
+      init[12] = _mm256_set1_epi32(static_cast<uint32_t>(block));
+      init[13] = _mm256_set1_epi32(static_cast<uint32_t>(block >> 32));
+      x = init;
+      rounds(x);
+      for (size_t word = 0; word < 16; ++word)
+        x[word] = _mm256_add_epi32(x[word], init[word]);
+      transpose(x.words);
+      transpose(x.words + 8);
+      for (size_t lane = 0; lane < XChaCha20Lanes; ++lane)
+      {
+        auto* out = reinterpret_cast<__m256i*>(keystream.data() + (lane * 64));
+        _mm256_store_si256(out, x[lane]);
+        _mm256_store_si256(out + 1, x[8 + lane]);
+      }
+      const size_t off = block * 64;
+      for (size_t lane = 0; lane < num; ++lane)
+      {
+        if (items[lane].size <= off)
+          continue;
+        xor_block(
+            items[lane].data + off,
+            keystream.data() + (lane * 64),
+            std::min<size_t>(64, items[lane].size - off));
+      }
+    }
+  }
+
+}  // namespace llarp::sodium
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "crypto.hpp"
+
+#include <cstddef>
+
+namespace llarp::sodium
+{
+  /// how many buffers the avx2 implementation crypts side by side
+  static constexpr size_t XChaCha20Lanes = 8;
+
+  /// crypt up to XChaCha20Lanes buffers in place sharing the key k, using one avx2 lane per
+  /// buffer.  gives the same output as crypto_stream_xchacha20_xor on each buffer.  only built
+  /// when the compiler supports avx2 and only to be called when the cpu does.
+  void
+  xchacha20_batch_avx2(const SharedSecret& k, const CryptBatchItem* items, size_t num);
+}  // namespace llarp::sodium
@@ -40,10 +40,11 @@ namespace llarp::dns
     explicit UDPReader(Server& dns, const EventLoop_ptr& loop, llarp::SockAddr bindaddr)
         : m_DNS{dns}
     {
-      m_udp = loop->make_udp([&](auto&, SockAddr src, llarp::OwnedBuffer buf) {
+      m_udp = loop->make_udp([&](auto&, SockAddr src, llarp::PacketBuffer buf) {
         if (src == m_LocalAddr)
           return;
-        if (not m_DNS.MaybeHandlePacket(shared_from_this(), m_LocalAddr, src, std::move(buf)))
+        if (not m_DNS.MaybeHandlePacket(
+                shared_from_this(), m_LocalAddr, src, OwnedBuffer{buf.data(), buf.size()}))
         {
           log::warning(logcat, "did not handle dns packet from {} to {}", src, m_LocalAddr);
         }
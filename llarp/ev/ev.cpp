@@ -7,22 +7,57 @@
 #include <string_view>
 
 #include "libuv.hpp"
+#include "udp_handle.hpp"
 #include <llarp/net/net.hpp>
 
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
 namespace llarp
 {
   EventLoop_ptr
-  EventLoop::create(size_t queueLength)
+  EventLoop::create(size_t queueLength, bool batchedUDP)
   {
-    return std::make_shared<llarp::uv::Loop>(queueLength);
+    return std::make_shared<llarp::uv::Loop>(queueLength, batchedUDP);
   }
 
+
   const net::Platform*
   EventLoop::Net_ptr() const
   {
     return net::Platform::Default_ptr();
   }
 
+  bool
+  UDPHandle::set_dont_fragment()
+  {
+#ifdef _WIN32
+    return false;
+#else
+    const auto fd = file_descriptor();
+    if (not fd)
+      return false;
+    // the socket is only one of ipv4 or ipv6, so one of each pair fails and that is fine
+    bool ok = false;
+#if defined(IP_MTU_DISCOVER) && defined(IPV6_MTU_DISCOVER)
+    const int probe = IP_PMTUDISC_PROBE;
+    ok = ::setsockopt(*fd, IPPROTO_IP, IP_MTU_DISCOVER, &probe, sizeof(probe)) == 0 or ok;
+    const int probe6 = IPV6_PMTUDISC_PROBE;
+    ok = ::setsockopt(*fd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &probe6, sizeof(probe6)) == 0 or ok;
+#elif defined(IP_DONTFRAG)
+    const int on = 1;
+    ok = ::setsockopt(*fd, IPPROTO_IP, IP_DONTFRAG, &on, sizeof(on)) == 0 or ok;
+#endif
+#ifdef IPV6_DONTFRAG
+    const int on6 = 1;
+    ok = ::setsockopt(*fd, IPPROTO_IPV6, IPV6_DONTFRAG, &on6, sizeof(on6)) == 0 or ok;
+#endif
+    return ok;
+#endif
+  }
+
   EventLoopWork::EventLoopWork(std::function<void(bool)> cleanup) : _cleanup{std::move(cleanup)}
   {}
 
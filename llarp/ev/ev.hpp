@@ -1,6 +1,7 @@
 #pragma once
 
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/packet_pool.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/constants/evloop.hpp>
@@ -213,7 +214,7 @@ namespace llarp
     virtual const net::Platform*
     Net_ptr() const;
 
-    using UDPReceiveFunc = std::function<void(UDPHandle&, SockAddr src, llarp::OwnedBuffer buf)>;
+    using UDPReceiveFunc = std::function<void(UDPHandle&, SockAddr src, llarp::PacketBuffer buf)>;
 
     // Constructs a UDP socket that can be used for sending and/or receiving
     virtual std::shared_ptr<UDPHandle>
@@ -231,9 +232,11 @@ namespace llarp
     virtual std::shared_ptr<EventLoopRepeater>
     make_repeater() = 0;
 
-    // Constructs and initializes a new default (libuv) event loop
+    // Constructs and initializes a new default (libuv) event loop.  If batchedUDP is set and we
+    // are on linux the udp sockets made by make_udp() use recvmmsg/sendmmsg instead of libuv's
+    // one-syscall-per-datagram udp handles.
     static std::shared_ptr<EventLoop>
-    create(size_t queueLength = event_loop_queue_size);
+    create(size_t queueLength = event_loop_queue_size, bool batchedUDP = false);
 
     // Returns true if called from within the event loop thread, false otherwise.
     virtual bool
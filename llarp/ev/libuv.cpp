@@ -11,6 +11,10 @@
 
 #include <uvw.hpp>
 
+#ifdef __linux__
+#include "udp_batch.hpp"
+#endif
+
 namespace llarp::uv
 {
   std::shared_ptr<uvw::Loop>
@@ -124,7 +128,8 @@ namespace llarp::uv
     FlushLogic();
   }
 
-  Loop::Loop(size_t queue_size) : llarp::EventLoop{}, m_LogicCalls{queue_size}
+  Loop::Loop(size_t queue_size, bool batched_udp)
+      : llarp::EventLoop{}, m_LogicCalls{queue_size}, m_BatchedUDP{batched_udp}
   {
     if (!(m_Impl = uvw::Loop::create()))
       throw std::runtime_error{"Failed to construct libuv loop"};
@@ -171,10 +176,16 @@ namespace llarp::uv
   std::shared_ptr<llarp::UDPHandle>
   Loop::make_udp(UDPReceiveFunc on_recv)
   {
+#ifdef __linux__
+    if (m_BatchedUDP)
+      return std::static_pointer_cast<llarp::UDPHandle>(
+          std::make_shared<BatchedUDPHandle>(*this, std::move(on_recv)));
+#endif
     return std::static_pointer_cast<llarp::UDPHandle>(
         std::make_shared<llarp::uv::UDPHandle>(*m_Impl, std::move(on_recv)));
   }
 
+
   static void
   setup_oneshot_timer(uvw::Loop& loop, llarp_time_t delay, std::function<void()> callback)
   {
@@ -313,7 +324,8 @@ namespace llarp::uv
       on_recv(
           *this,
           SockAddr{event.sender.ip, huint16_t{static_cast<uint16_t>(event.sender.port)}},
-          OwnedBuffer{std::move(event.data), event.length});
+          PacketPool::Local().Copy(
+              reinterpret_cast<const byte_t*>(event.data.get()), event.length));
     });
   }
 
@@ -23,7 +23,7 @@ namespace llarp::uv
    public:
     using Callback = std::function<void()>;
 
-    Loop(size_t queue_size);
+    Loop(size_t queue_size, bool batched_udp = false);
 
     virtual void
     run() override;
@@ -100,6 +100,9 @@ namespace llarp::uv
 
     std::unordered_map<int, std::shared_ptr<uvw::PollHandle>> m_Polls;
 
+    /// use recvmmsg/sendmmsg backed udp handles where available
+    const bool m_BatchedUDP;
+
     void
     wakeup() override;
   };
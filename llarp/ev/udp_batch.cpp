@@ -0,0 +1,413 @@
+#include "udp_batch.hpp"
+
+#include <llarp/util/exceptions.hpp>
+#include <llarp/util/logging.hpp>
+
+#include <uvw/loop.h>
+#include <uvw/poll.h>
+#include <uvw/prepare.h>
+
+#include <netinet/udp.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+// older libc headers do not know about udp segmentation offload yet
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace llarp::uv
+{
+  static auto logcat = log::Cat("udp-batch");
+
+  BatchedUDPHandle::BatchedUDPHandle(EventLoop& loop, ReceiveFunc rf)
+      : llarp::UDPHandle{std::move(rf)}
+      , m_Owner{loop}
+      , m_Loop{*loop.MaybeGetUVWLoop()}
+      , m_SendSlab(BatchSize * SlotSize)
+      , m_Handoff{HandoffQueueSize}
+      , m_HandoffWakeup{loop.make_waker([this] { drain_handoff(); })}
+  {
+    m_PendingSends.reserve(BatchSize);
+  }
+
+  BatchedUDPHandle::~BatchedUDPHandle()
+  {
+    close();
+  }
+
+  bool
+  BatchedUDPHandle::open_socket(int family)
+  {
+    if (m_FD != -1)
+      return true;
+    m_FD = ::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_FD == -1)
+    {
+      log::error(logcat, "cannot create udp socket: {}", strerror(errno));
+      return false;
+    }
+
+    int on = 1;
+    m_GRO = ::setsockopt(m_FD, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+    int seg{};
+    socklen_t seglen = sizeof(seg);
+    m_GSO = ::getsockopt(m_FD, SOL_UDP, UDP_SEGMENT, &seg, &seglen) == 0;
+    log::debug(logcat, "opened udp socket fd={} gro={} gso={}", m_FD, m_GRO, m_GSO);
+
+    // without gro the kernel writes straight into pooled packet buffers that we hand upwards, with
+    // gro we need room for coalesced segments and split them into pooled buffers as we deliver
+    if (m_GRO)
+    {
+      m_RecvSlab.resize(BatchSize * GROSlotSize);
+      for (size_t idx = 0; idx < BatchSize; ++idx)
+      {
+        m_RecvIOV[idx].iov_base = m_RecvSlab.data() + (idx * GROSlotSize);
+        m_RecvIOV[idx].iov_len = GROSlotSize;
+      }
+    }
+    start_polling();
+    return true;
+  }
+
+  void
+  BatchedUDPHandle::start_polling()
+  {
+    m_Poll = m_Loop.resource<uvw::PollHandle>(m_FD);
+    m_Poll->on<uvw::PollEvent>([this](const auto&, auto&) { on_readable(); });
+    m_Poll->start(uvw::PollHandle::Event::READABLE);
+
+    m_Flusher = m_Loop.resource<uvw::PrepareHandle>();
+    m_Flusher->on<uvw::PrepareEvent>([this](const auto&, auto&) { flush(); });
+  }
+
+  bool
+  BatchedUDPHandle::listen(const SockAddr& addr)
+  {
+    if (m_FD != -1)
+      close();
+    if (not open_socket(addr.Family()))
+      return false;
+    const auto* sa = static_cast<const sockaddr*>(addr);
+    if (::bind(m_FD, sa, addr.sockaddr_len()) == -1)
+    {
+      const auto err = errno;
+      close();
+      throw llarp::util::bind_socket_error{
+          fmt::format("failed to bind udp socket on {}: {}", addr, strerror(err))};
+    }
+    return true;
+  }
+
+  void
+  BatchedUDPHandle::on_readable()
+  {
+    for (size_t round = 0; round < MaxRecvRounds; ++round)
+    {
+      for (size_t idx = 0; idx < BatchSize; ++idx)
+      {
+        if (not m_GRO and not m_RecvBuffers[idx])
+        {
+          m_RecvBuffers[idx] = PacketPool::Local().Acquire(SlotSize);
+          m_RecvIOV[idx].iov_base = m_RecvBuffers[idx].data();
+          m_RecvIOV[idx].iov_len = SlotSize;
+        }
+        auto& hdr = m_RecvMsgs[idx].msg_hdr;
+        hdr.msg_name = &m_RecvFrom[idx];
+        hdr.msg_namelen = sizeof(sockaddr_storage);
+        hdr.msg_iov = &m_RecvIOV[idx];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = m_GRO ? m_RecvControl[idx].data : nullptr;
+        hdr.msg_controllen = m_GRO ? sizeof(m_RecvControl[idx].data) : 0;
+        hdr.msg_flags = 0;
+        m_RecvMsgs[idx].msg_len = 0;
+      }
+      const int got = ::recvmmsg(m_FD, m_RecvMsgs.data(), BatchSize, MSG_DONTWAIT, nullptr);
+      if (got <= 0)
+      {
+        if (got == -1 and errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR)
+          log::warning(logcat, "recvmmsg failed: {}", strerror(errno));
+        return;
+      }
+      for (int idx = 0; idx < got; ++idx)
+      {
+        auto& hdr = m_RecvMsgs[idx].msg_hdr;
+        if (hdr.msg_flags & MSG_TRUNC)
+        {
+          log::debug(logcat, "dropping truncated datagram");
+          continue;
+        }
+        if (not m_GRO)
+        {
+          auto buf = std::move(m_RecvBuffers[idx]);
+          buf.resize(m_RecvMsgs[idx].msg_len);
+          if (not deliver(m_RecvFrom[idx], std::move(buf)))
+            return;
+          continue;
+        }
+        size_t segment = 0;
+        {
+          for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+          {
+            if (cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO)
+            {
+              int gso_size{};
+              std::memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+              segment = gso_size;
+            }
+          }
+        }
+        // without a gro segment size the whole thing is one datagram, otherwise the kernel glued
+        // together equally sized datagrams where only the last one may be shorter.
+        const auto* ptr = static_cast<const byte_t*>(m_RecvIOV[idx].iov_base);
+        size_t len = m_RecvMsgs[idx].msg_len;
+        if (segment == 0)
+          segment = len;
+        while (len > 0)
+        {
+          const auto sz = std::min(segment, len);
+          if (not deliver(m_RecvFrom[idx], PacketPool::Local().Copy(ptr, sz)))
+            return;
+          ptr += sz;
+          len -= sz;
+        }
+      }
+      // a short read means the socket is drained
+      if (static_cast<size_t>(got) < BatchSize)
+        return;
+    }
+  }
+
+  bool
+  BatchedUDPHandle::deliver(const sockaddr_storage& from, PacketBuffer buf)
+  {
+    SockAddr src;
+    try
+    {
+      src = *reinterpret_cast<const sockaddr*>(&from);
+    }
+    catch (std::exception& ex)
+    {
+      log::warning(logcat, "dropping datagram: {}", ex.what());
+      return true;
+    }
+    on_recv(*this, src, std::move(buf));
+    // the receive handler can close us
+    return m_FD != -1;
+  }
+
+  bool
+  BatchedUDPHandle::send(const SockAddr& to, const llarp_buffer_t& buf)
+  {
+    if (m_Owner.inEventLoop())
+      return enqueue(to, buf.base, buf.sz);
+    // the slab, the pending sends and the flusher all belong to the event loop
+    if (buf.sz == 0 or buf.sz > std::numeric_limits<uint16_t>::max())
+      return false;
+    if (m_Handoff.tryPushBack(Datagram{to, PacketPool::Local().Copy(buf.base, buf.sz)})
+        != llarp::thread::QueueReturn::Success)
+    {
+      m_Dropped++;
+      return false;
+    }
+    m_HandoffWakeup->Trigger();
+    return true;
+  }
+
+  void
+  BatchedUDPHandle::drain_handoff()
+  {
+    while (auto pkt = m_Handoff.tryPopFront())
+      enqueue(pkt->addr, pkt->buf.data(), pkt->buf.size());
+  }
+
+  bool
+  BatchedUDPHandle::enqueue(const SockAddr& to, const byte_t* data, size_t sz)
+  {
+    if (m_FD == -1 and not open_socket(to.Family()))
+      return false;
+    if (sz == 0 or sz > std::numeric_limits<uint16_t>::max())
+      return false;
+    if (m_SendSlabUsed + sz > m_SendSlab.size() or m_PendingSends.size() == BatchSize)
+      flush();
+
+    const auto* sa = static_cast<const sockaddr*>(to);
+    const auto salen = static_cast<socklen_t>(to.sockaddr_len());
+    const size_t maxPayload = sa->sa_family == AF_INET6 ? MaxPayloadV6 : MaxPayloadV4;
+
+    std::copy_n(data, sz, m_SendSlab.data() + m_SendSlabUsed);
+
+    // try gluing this datagram onto the previous one to the same peer, which the kernel permits
+    // as long as every segment but the last has the same size
+    if (m_GSO and not m_PendingSends.empty())
+    {
+      auto& last = m_PendingSends.back();
+      if (last.tolen == salen and std::memcmp(&last.to, sa, salen) == 0
+          and sz <= last.segment and last.len % last.segment == 0
+          and last.len / last.segment < MaxGSOSegments
+          and last.offset + last.len == m_SendSlabUsed and last.len + sz <= maxPayload)
+      {
+        last.len += sz;
+        m_SendSlabUsed += sz;
+        return true;
+      }
+    }
+    auto& pending = m_PendingSends.emplace_back();
+    std::memcpy(&pending.to, sa, salen);
+    pending.tolen = salen;
+    pending.offset = m_SendSlabUsed;
+    pending.len = sz;
+    pending.segment = static_cast<uint16_t>(sz);
+    m_SendSlabUsed += sz;
+
+    if (not m_FlushScheduled)
+    {
+      m_Flusher->start();
+      m_FlushScheduled = true;
+    }
+    return true;
+  }
+
+  void
+  BatchedUDPHandle::send_individually(const PendingSend& pending)
+  {
+    for (size_t off = 0; off < pending.len; off += pending.segment)
+    {
+      const auto sz = std::min<size_t>(pending.segment, pending.len - off);
+      if (::sendto(
+              m_FD,
+              m_SendSlab.data() + pending.offset + off,
+              sz,
+              0,
+              reinterpret_cast<const sockaddr*>(&pending.to),
+              pending.tolen)
+          == -1)
+        log::debug(logcat, "sendto failed: {}", strerror(errno));
+    }
+  }
+
+  void
+  BatchedUDPHandle::flush()
+  {
+    if (m_FlushScheduled)
+    {
+      m_Flusher->stop();
+      m_FlushScheduled = false;
+    }
+    if (m_PendingSends.empty() or m_FD == -1)
+      return;
+
+    const size_t num = m_PendingSends.size();
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      auto& pending = m_PendingSends[idx];
+      m_SendIOV[idx].iov_base = m_SendSlab.data() + pending.offset;
+      m_SendIOV[idx].iov_len = pending.len;
+      auto& hdr = m_SendMsgs[idx].msg_hdr;
+      hdr.msg_name = &pending.to;
+      hdr.msg_namelen = pending.tolen;
+      hdr.msg_iov = &m_SendIOV[idx];
+      hdr.msg_iovlen = 1;
+      hdr.msg_flags = 0;
+      hdr.msg_control = nullptr;
+      hdr.msg_controllen = 0;
+      if (pending.len > pending.segment)
+      {
+        hdr.msg_control = m_SendControl[idx].data;
+        hdr.msg_controllen = sizeof(m_SendControl[idx].data);
+        auto* cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        std::memcpy(CMSG_DATA(cmsg), &pending.segment, sizeof(uint16_t));
+      }
+    }
+
+    size_t sent = 0;
+    while (sent < num)
+    {
+      const int n = ::sendmmsg(m_FD, m_SendMsgs.data() + sent, num - sent, MSG_DONTWAIT);
+      if (n > 0)
+      {
+        sent += n;
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN or errno == EWOULDBLOCK)
+      {
+        // same as a failed trySend, the rest of the batch is dropped and the link layer will
+        // retransmit
+        log::debug(logcat, "udp socket full, dropping {} queued sends", num - sent);
+        break;
+      }
+      // the message at the head of what remains failed, if it was a gso send the nic or route
+      // probably cannot do segmentation offload so we stop trying and split it up ourselves
+      const auto& failed = m_PendingSends[sent];
+      if (failed.len > failed.segment)
+      {
+        log::info(logcat, "disabling udp gso: {}", strerror(errno));
+        m_GSO = false;
+        send_individually(failed);
+      }
+      else
+        log::debug(logcat, "sendmmsg failed: {}", strerror(errno));
+      ++sent;
+    }
+    m_PendingSends.clear();
+    m_SendSlabUsed = 0;
+  }
+
+  void
+  BatchedUDPHandle::close()
+  {
+    if (m_FD == -1)
+      return;
+    flush();
+    if (m_Poll)
+    {
+      m_Poll->close();
+      m_Poll.reset();
+    }
+    if (m_Flusher)
+    {
+      m_Flusher->close();
+      m_Flusher.reset();
+    }
+    ::close(m_FD);
+    m_FD = -1;
+    m_RecvBuffers.fill(PacketBuffer{});
+  }
+
+  std::optional<int>
+  BatchedUDPHandle::file_descriptor()
+  {
+    if (m_FD != -1)
+      return m_FD;
+    return std::nullopt;
+  }
+
+  std::optional<SockAddr>
+  BatchedUDPHandle::LocalAddr() const
+  {
+    if (m_FD == -1)
+      return std::nullopt;
+    sockaddr_storage addr{};
+    socklen_t addrlen = sizeof(addr);
+    if (::getsockname(m_FD, reinterpret_cast<sockaddr*>(&addr), &addrlen) == -1)
+      return std::nullopt;
+    return SockAddr{*reinterpret_cast<const sockaddr*>(&addr)};
+  }
+
+}  // namespace llarp::uv
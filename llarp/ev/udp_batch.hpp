@@ -0,0 +1,167 @@
+#pragma once
+
+#include "udp_handle.hpp"
+
+#include <llarp/net/sock_addr.hpp>
+#include <llarp/util/packet_pool.hpp>
+#include <llarp/util/thread/queue.hpp>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace uvw
+{
+  class Loop;
+  class PollHandle;
+  class PrepareHandle;
+}  // namespace uvw
+
+namespace llarp::uv
+{
+  /// Linux only udp handle that reads datagrams in batches with recvmmsg() straight into pooled
+  /// packet buffers and coalesces everything sent during an event loop iteration into a single
+  /// sendmmsg() right before the loop goes back to sleep.  When the kernel supports it we
+  /// additionally enable UDP_GRO on the receive side and glue equal sized datagrams to the same
+  /// peer together with UDP_SEGMENT on the send side.  Sends may come from any thread, those not
+  /// made on the event loop are handed to it through a queue.
+  class BatchedUDPHandle final : public llarp::UDPHandle
+  {
+   public:
+    /// how many datagrams we move per syscall
+    static constexpr size_t BatchSize = 64;
+    /// size of a receive slot when we have no GRO, must fit any link layer packet
+    static constexpr size_t SlotSize = PacketPool::SlabSize;
+    /// size of a receive slot with GRO enabled, the kernel hands us up to 64k of coalesced segments
+    static constexpr size_t GROSlotSize = 65535;
+    /// max number of recvmmsg calls we do per readable event so we do not starve the event loop
+    static constexpr size_t MaxRecvRounds = 8;
+    /// max number of segments we glue together into a single UDP_SEGMENT send
+    static constexpr size_t MaxGSOSegments = 64;
+    /// the most a udp datagram can carry over ipv4 and ipv6, a UDP_SEGMENT send is one datagram
+    /// as far as these limits go
+    static constexpr size_t MaxPayloadV4 = 65507;
+    static constexpr size_t MaxPayloadV6 = 65527;
+    /// how many sends from other threads can wait for the event loop
+    static constexpr size_t HandoffQueueSize = 4096;
+
+    BatchedUDPHandle(EventLoop& loop, ReceiveFunc rf);
+
+    ~BatchedUDPHandle() override;
+
+    bool
+    listen(const SockAddr& addr) override;
+
+    /// queues the packet into our send slab, it is put on the wire with the rest of the batch at
+    /// the end of this event loop iteration (or right away if the batch is full).  called off the
+    /// event loop it is queued for the event loop instead, fails if that queue is full.
+    bool
+    send(const SockAddr& dest, const llarp_buffer_t& buf) override;
+
+    void
+    close() override;
+
+    std::optional<int>
+    file_descriptor() override;
+
+    std::optional<SockAddr>
+    LocalAddr() const override;
+
+    /// put every queued packet on the wire now, event loop only
+    void
+    flush();
+
+    /// number of sends from other threads dropped because the handoff queue was full
+    uint64_t
+    dropped() const
+    {
+      return m_Dropped.load();
+    }
+
+   private:
+    /// cmsg buffer for a single control message carrying a T
+    template <typename T>
+    struct alignas(cmsghdr) Control
+    {
+      byte_t data[CMSG_SPACE(sizeof(T))];
+    };
+
+    /// a send made off the event loop, waiting in m_Handoff
+    struct Datagram
+    {
+      SockAddr addr;
+      PacketBuffer buf;
+    };
+
+    /// a pending send, one entry in the next sendmmsg() call.  with GSO one entry can hold many
+    /// equally sized datagrams to the same peer laid out back to back in the send slab.
+    struct PendingSend
+    {
+      sockaddr_storage to;
+      socklen_t tolen;
+      size_t offset;
+      size_t len;
+      uint16_t segment;
+    };
+
+    bool
+    open_socket(int family);
+
+    void
+    start_polling();
+
+    void
+    on_readable();
+
+    /// hands a datagram to the receive handler, returns false if the handler closed us
+    bool
+    deliver(const sockaddr_storage& from, PacketBuffer buf);
+
+    /// send() on the event loop
+    bool
+    enqueue(const SockAddr& dest, const byte_t* data, size_t sz);
+
+    /// called on the event loop to queue what other threads sent
+    void
+    drain_handoff();
+
+    void
+    send_individually(const PendingSend& pending);
+
+    EventLoop& m_Owner;
+    uvw::Loop& m_Loop;
+    int m_FD{-1};
+    bool m_GRO{false};
+    bool m_GSO{false};
+
+    std::shared_ptr<uvw::PollHandle> m_Poll;
+    /// fires right before the event loop blocks for io, this is where we flush the send batch
+    std::shared_ptr<uvw::PrepareHandle> m_Flusher;
+    bool m_FlushScheduled{false};
+
+    /// pooled buffers the kernel receives into when we have no gro, refilled as we hand them off
+    std::array<PacketBuffer, BatchSize> m_RecvBuffers;
+    std::vector<byte_t> m_RecvSlab;
+    std::array<mmsghdr, BatchSize> m_RecvMsgs;
+    std::array<iovec, BatchSize> m_RecvIOV;
+    std::array<sockaddr_storage, BatchSize> m_RecvFrom;
+    std::array<Control<int>, BatchSize> m_RecvControl;
+
+    std::vector<byte_t> m_SendSlab;
+    size_t m_SendSlabUsed{0};
+    std::vector<PendingSend> m_PendingSends;
+
+    llarp::thread::Queue<Datagram> m_Handoff;
+    std::shared_ptr<EventLoopWakeup> m_HandoffWakeup;
+    std::atomic<uint64_t> m_Dropped{0};
+    std::array<mmsghdr, BatchSize> m_SendMsgs;
+    std::array<iovec, BatchSize> m_SendIOV;
+    std::array<Control<uint16_t>, BatchSize> m_SendControl;
+  };
+
+}  // namespace llarp::uv
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "ev.hpp"
 #include "../util/buffer.hpp"
 
@@ -33,6 +35,13 @@ namespace llarp
       return std::nullopt;
     }
 
+    // Sets the don't fragment bit on everything sent from the socket and stops the kernel from
+    // fragmenting or refusing sends by what it thinks the path mtu is, so a datagram too large for
+    // the path is lost rather than arriving in pieces.  Path mtu probes need this to mean anything.
+    // Returns false if the socket is not open or the platform cannot do it.
+    virtual bool
+    set_dont_fragment();
+
     /// returns the local address we are bound on
     virtual std::optional<SockAddr>
     LocalAddr() const = 0;
@@ -110,7 +110,7 @@ namespace llarp
 
     bool
     Endpoint::QueueOutboundTraffic(
-        PathID_t path, std::vector<byte_t> buf, uint64_t counter, service::ProtocolType t)
+        PathID_t path, const llarp_buffer_t& buf, uint64_t counter, service::ProtocolType t)
     {
       const service::ConvoTag tag{path.as_array()};
       if (t == service::ProtocolType::QUIC)
@@ -118,8 +118,8 @@ namespace llarp
         auto quic = m_Parent->GetQUICTunnel();
         if (not quic)
           return false;
-        m_TxRate += buf.size();
-        quic->receive_packet(tag, std::move(buf));
+        m_TxRate += buf.sz;
+        quic->receive_packet(tag, buf.copy());
         m_LastActive = m_Parent->Now();
         return true;
       }
@@ -127,44 +127,45 @@ namespace llarp
       if (m_UpstreamQueue.size() > MaxUpstreamQueueSize)
         return false;
 
-      llarp::net::IPPacket pkt{std::move(buf)};
+      llarp::net::IPPacket pkt{byte_view_t{buf.base, buf.sz}};
       if (pkt.empty())
         return false;
 
+      // the address rewrite itself is left to Flush, which does the whole queue at once
+      huint128_t dst;
       if (pkt.IsV6() && m_Parent->SupportsV6())
       {
-        huint128_t dst;
         if (m_RewriteSource)
           dst = m_Parent->GetIfAddr();
         else
           dst = pkt.dstv6();
-        pkt.UpdateIPv6Address(m_IP, dst);
       }
       else if (pkt.IsV4() && !m_Parent->SupportsV6())
       {
-        huint32_t dst;
         if (m_RewriteSource)
-          dst = net::TruncateV6(m_Parent->GetIfAddr());
+          dst = net::ExpandV4(net::TruncateV6(m_Parent->GetIfAddr()));
         else
-          dst = pkt.dstv4();
-        pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(m_IP)), xhtonl(dst));
+          dst = net::ExpandV4(pkt.dstv4());
       }
       else
       {
         return false;
       }
       m_TxRate += pkt.size();
-      m_UpstreamQueue.emplace(std::move(pkt), counter);
+      m_UpstreamQueue.emplace(std::move(pkt), counter, m_IP, dst);
       m_LastActive = m_Parent->Now();
       return true;
     }
 
     bool
-    Endpoint::QueueInboundTraffic(std::vector<byte_t> buf, service::ProtocolType type)
+    Endpoint::QueueInboundTraffic(const llarp_buffer_t& data, service::ProtocolType type)
     {
+      byte_view_t view{data.base, data.sz};
+      llarp::net::IPPacket pkt;
       if (type != service::ProtocolType::QUIC)
       {
-        llarp::net::IPPacket pkt{std::move(buf)};
+        // rewrite a pooled copy and queue from that, the caller's buffer is left alone
+        pkt = llarp::net::IPPacket{view};
         if (pkt.empty())
           return false;
 
@@ -178,10 +179,11 @@ namespace llarp
         else
           pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(src)), xhtonl(net::TruncateV6(m_IP)));
 
-        buf = pkt.steal();
+        view = pkt.view();
       }
+      const llarp_buffer_t buf{view.data(), view.size()};
 
-      const uint8_t queue_idx = buf.size() / llarp::routing::ExitPadSize;
+      const uint8_t queue_idx = buf.sz / llarp::routing::ExitPadSize;
       if (m_DownstreamQueues.find(queue_idx) == m_DownstreamQueues.end())
         m_DownstreamQueues.emplace(queue_idx, InboundTrafficQueue_t{});
       auto& queue = m_DownstreamQueues.at(queue_idx);
@@ -189,29 +191,37 @@ namespace llarp
       {
         queue.emplace_back();
         queue.back().protocol = type;
-        return queue.back().PutBuffer(std::move(buf), m_Counter++);
+        return queue.back().PutBuffer(buf, m_Counter++);
       }
       auto& msg = queue.back();
-      if (msg.Size() + buf.size() > llarp::routing::ExitPadSize)
+      if (msg.Size() + buf.sz > llarp::routing::ExitPadSize)
       {
         queue.emplace_back();
         queue.back().protocol = type;
-        return queue.back().PutBuffer(std::move(buf), m_Counter++);
+        return queue.back().PutBuffer(buf, m_Counter++);
       }
       msg.protocol = type;
-      return msg.PutBuffer(std::move(buf), m_Counter++);
+      return msg.PutBuffer(buf, m_Counter++);
     }
 
     bool
     Endpoint::Flush()
     {
-      // flush upstream queue
+      // flush upstream queue, rewriting the addresses of all of it in one go
+      std::vector<UpstreamBuffer> upstream;
+      upstream.reserve(m_UpstreamQueue.size());
       while (m_UpstreamQueue.size())
       {
-        m_Parent->QueueOutboundTraffic(
-            const_cast<net::IPPacket&>(m_UpstreamQueue.top().pkt).steal());
+        upstream.emplace_back(std::move(const_cast<UpstreamBuffer&>(m_UpstreamQueue.top())));
         m_UpstreamQueue.pop();
       }
+      std::vector<net::AddressRewrite> rewrites;
+      rewrites.reserve(upstream.size());
+      for (auto& item : upstream)
+        rewrites.push_back(net::AddressRewrite{&item.pkt, item.src, item.dst});
+      net::RewriteAddresses(rewrites.data(), rewrites.size());
+      for (auto& item : upstream)
+        m_Parent->QueueOutboundTraffic(std::move(item.pkt));
       // flush downstream queue
       auto path = GetCurrentPath();
       bool sent = path != nullptr;
@@ -58,7 +58,7 @@ namespace llarp
 
       /// queue traffic from service node / internet to be transmitted
       bool
-      QueueInboundTraffic(std::vector<byte_t> data, service::ProtocolType t);
+      QueueInboundTraffic(const llarp_buffer_t& data, service::ProtocolType t);
 
       /// flush inbound and outbound traffic queues
       bool
@@ -68,7 +68,7 @@ namespace llarp
       /// does ip rewrite here
       bool
       QueueOutboundTraffic(
-          PathID_t txid, std::vector<byte_t> data, uint64_t counter, service::ProtocolType t);
+          PathID_t txid, const llarp_buffer_t& data, uint64_t counter, service::ProtocolType t);
 
       /// update local path id and cascade information to parent
       /// return true if success
@@ -122,11 +122,15 @@ namespace llarp
 
       struct UpstreamBuffer
       {
-        UpstreamBuffer(llarp::net::IPPacket p, uint64_t c) : pkt{std::move(p)}, counter(c)
+        UpstreamBuffer(llarp::net::IPPacket p, uint64_t c, huint128_t s, huint128_t d)
+            : pkt{std::move(p)}, counter(c), src{s}, dst{d}
         {}
 
         llarp::net::IPPacket pkt;
         uint64_t counter;
+        /// the addresses pkt gets, rewritten in batches when we flush
+        huint128_t src;
+        huint128_t dst;
 
         bool
         operator<(const UpstreamBuffer& other) const
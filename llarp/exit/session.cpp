@@ -331,7 +331,10 @@ namespace llarp
       while (m_Downstream.size())
       {
         if (m_WritePacket)
-          m_WritePacket(const_cast<net::IPPacket&>(m_Downstream.top().second).steal());
+        {
+          const auto& pkt = m_Downstream.top().second;
+          m_WritePacket(llarp_buffer_t{pkt.data(), pkt.size()});
+        }
         m_Downstream.pop();
       }
     }
@@ -109,7 +109,7 @@ namespace llarp
           {
             if (not itr->second->LooksDead(Now()))
             {
-              if (itr->second->QueueInboundTraffic(payload.copy(), type))
+              if (itr->second->QueueInboundTraffic(payload, type))
                 return true;
             }
           }
@@ -384,8 +384,9 @@ namespace llarp
             maybe_pk = itr->second;
         }
 
-        auto buf = const_cast<net::IPPacket&>(top).steal();
+        auto pkt = std::move(const_cast<net::IPPacket&>(top));
         m_InetToNetwork.pop();
+        const llarp_buffer_t buf{pkt.data(), pkt.size()};
         // we have no session for public key so drop
         if (not maybe_pk)
           continue;  // we are in a while loop
@@ -401,13 +402,13 @@ namespace llarp
           auto itr = m_SNodeSessions.find(pk);
           if (itr != m_SNodeSessions.end())
           {
-            itr->second->SendPacketToRemote(std::move(buf), service::ProtocolType::TrafficV4);
+            itr->second->SendPacketToRemote(buf, service::ProtocolType::TrafficV4);
             // we are in a while loop
             continue;
           }
         }
         auto tryFlushingTraffic =
-            [this, buf = std::move(buf), pk](exit::Endpoint* const ep) -> bool {
+            [this, &buf, pk](exit::Endpoint* const ep) -> bool {
           if (!ep->QueueInboundTraffic(buf, service::ProtocolType::TrafficV4))
           {
             LogWarn(
@@ -461,6 +462,8 @@ namespace llarp
       {
         vpn::InterfaceInfo info;
         info.ifname = m_ifname;
+        info.queues = m_ifQueues;
+        info.offload = m_ifOffload;
         info.addrs.emplace_back(m_OurRange);
 
         m_NetIf = GetRouter()->GetVPNPlatform()->CreateInterface(std::move(info), m_Router);
@@ -752,6 +755,8 @@ namespace llarp
         m_ifname = *maybe;
       }
       LogInfo(Name(), " set ifname to ", m_ifname);
+      m_ifQueues = networkConfig.m_ifQueues;
+      m_ifOffload = networkConfig.m_ifOffload;
       if (auto* quic = GetQUICTunnel())
       {
         quic->listen([ifaddr = net::TruncateV6(m_IfAddr)](std::string_view, uint16_t port) {
@@ -223,6 +223,8 @@ namespace llarp
       huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
+      size_t m_ifQueues = 1;
+      bool m_ifOffload = false;
 
       std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
 
@@ -30,7 +30,7 @@ namespace llarp::handlers
         const service::ConvoTag tag,
         const llarp_buffer_t& buf,
         service::ProtocolType t,
-        uint64_t) override
+        std::optional<uint64_t>) override
     {
       LogTrace("Inbound ", t, " packet (", buf.sz, "B) on convo ", tag);
       if (t == service::ProtocolType::Control)
@@ -136,7 +136,9 @@ namespace llarp
       {
         auto ptr = std::make_shared<DnsInterceptor>(
             [ep = m_Endpoint](auto pkt) {
-              ep->HandleWriteIPPacket(pkt.ConstBuffer(), pkt.srcv6(), pkt.dstv6(), 0);
+              const auto src = pkt.srcv6();
+              const auto dst = pkt.dstv6();
+              ep->HandleWriteIPPacket(std::move(pkt), src, dst, 0, std::nullopt);
             },
             m_OurIP,
             conf);
@@ -252,6 +254,17 @@ namespace llarp
       obj["ourIP"] = m_OurIP.ToString();
       obj["nextIP"] = m_NextIP.ToString();
       obj["maxIP"] = m_MaxIP.ToString();
+      obj["packetCopies"] = net::IPPacket::Copies();
+      obj["networkToUser"] = util::StatusObject{
+          {"ready", m_NetworkToUserReady.size()},
+          {"held", m_NetworkToUserReorder.Held()},
+          {"flows", m_NetworkToUserReorder.Flows()},
+          {"skippedGaps", m_NetworkToUserReorder.Skipped()},
+          {"late", m_NetworkToUserReorder.Late()},
+          {"written", m_NetworkToUserWritten},
+          {"dropped", m_NetworkToUserDropped},
+          {"maxBatch", m_NetworkToUserMaxBatch},
+          {"latency", m_NetworkToUserLatency.ExtractStatus()}};
       return obj;
     }
 
@@ -321,6 +334,8 @@ namespace llarp
           throw std::runtime_error("cannot find free interface name");
         m_IfName = *maybe;
       }
+      m_IfQueues = conf.m_ifQueues;
+      m_IfOffload = conf.m_ifOffload;
 
       m_OurRange = conf.m_ifaddr;
       if (!m_OurRange.addr.h)
@@ -458,14 +473,58 @@ namespace llarp
     void
     TunEndpoint::Pump(llarp_time_t now)
     {
-      // flush network to user
-      while (not m_NetworkToUserPktQueue.empty())
+      service::Endpoint::Pump(now);
+
+      // stop waiting on gaps in flows that held packets back for long enough
+      m_NetworkToUserReorder.Expire(now, [this](auto ready) {
+        m_NetworkToUserReady.emplace_back(std::move(ready));
+      });
+      FlushWrite();
+
+      // whatever is still held has to go out when it times out even if nothing else wakes us
+      const auto expiry = m_NetworkToUserReorder.NextExpiry();
+      if (expiry and not m_NetworkToUserWakeup)
       {
-        m_NetIf->WritePacket(m_NetworkToUserPktQueue.top().pkt);
-        m_NetworkToUserPktQueue.pop();
+        m_NetworkToUserWakeup = true;
+        Loop()->call_later(
+            std::max<llarp_time_t>(*expiry - now, 1ms), [self = weak_from_this()]() {
+              if (auto ptr = self.lock())
+              {
+                ptr->m_NetworkToUserWakeup = false;
+                ptr->Router()->TriggerPump();
+              }
+            });
       }
+    }
 
-      service::Endpoint::Pump(now);
+    void
+    TunEndpoint::FlushWrite()
+    {
+      if (m_NetworkToUserReady.empty())
+        return;
+      // rewrite the addresses of everything we write in one go then hand it all to the interface
+      auto writes = std::move(m_NetworkToUserReady);
+      m_NetworkToUserReady.clear();
+      std::vector<net::AddressRewrite> rewrites;
+      rewrites.reserve(writes.size());
+      for (auto& write : writes)
+        rewrites.push_back(net::AddressRewrite{&write.pkt, write.src, write.dst});
+      net::RewriteAddresses(rewrites.data(), rewrites.size());
+
+      const auto now = std::chrono::steady_clock::now();
+      std::vector<net::IPPacket> pkts;
+      pkts.reserve(writes.size());
+      for (auto& write : writes)
+      {
+        m_NetworkToUserLatency.Add(
+            std::chrono::duration_cast<util::LatencyHistogram::Time_t>(now - write.queued));
+        pkts.emplace_back(std::move(write.pkt));
+      }
+      m_NetworkToUserMaxBatch = std::max(m_NetworkToUserMaxBatch, pkts.size());
+      const auto num = pkts.size();
+      const auto dropped = m_NetIf->WritePackets(std::move(pkts));
+      m_NetworkToUserWritten += num - dropped;
+      m_NetworkToUserDropped += dropped;
     }
 
     static bool
@@ -1001,6 +1060,8 @@ namespace llarp
       }
 
       info.ifname = m_IfName;
+      info.queues = m_IfQueues;
+      info.offload = m_IfOffload;
 
       LogInfo(Name(), " setting up network...");
 
@@ -1121,14 +1182,12 @@ namespace llarp
       // build up our candidates to choose
 
       std::unordered_set<service::Address> candidates;
-      for (const auto& entry : m_ExitMap.FindAllEntries(ip))
-      {
+      m_ExitMap.ForEachMatch(ip, [&](const auto& range, const auto& exit) {
         // in the event the exit's range is a bogon range, make sure the ip is located in that range
         // to allow it
-        if ((is_bogon and net.IsBogonRange(entry.first) and entry.first.Contains(ip))
-            or entry.first.Contains(ip))
-          candidates.emplace(entry.second);
-      }
+        if ((is_bogon and net.IsBogonRange(range) and range.Contains(ip)) or range.Contains(ip))
+          candidates.emplace(exit);
+      });
       // no candidates? bail.
       if (candidates.empty())
         return std::nullopt;
@@ -1164,7 +1223,7 @@ namespace llarp
       {
         if (dst == m_OurIP)
         {
-          HandleWriteIPPacket(pkt.ConstBuffer(), src, dst, 0);
+          HandleWriteIPPacket(std::move(pkt), src, dst, 0, std::nullopt);
           return;
         }
       }
@@ -1183,8 +1242,8 @@ namespace llarp
         else
         {
           // send icmp unreachable as we dont have any exits for this ip
-          if (const auto icmp = pkt.MakeICMPUnreachable())
-            HandleWriteIPPacket(icmp->ConstBuffer(), dst, src, 0);
+          if (auto icmp = pkt.MakeICMPUnreachable())
+            HandleWriteIPPacket(std::move(*icmp), dst, src, 0, std::nullopt);
 
           return;
         }
@@ -1279,9 +1338,10 @@ namespace llarp
     bool
     TunEndpoint::ShouldAllowTraffic(const net::IPPacket& pkt) const
     {
-      if (const auto exitPolicy = GetExitPolicy())
+      // look at our own policy rather than copy it out of GetExitPolicy for every packet
+      if (m_TrafficPolicy)
       {
-        if (not exitPolicy->AllowsTraffic(pkt))
+        if (not m_TrafficPolicy->AllowsTraffic(pkt))
           return false;
       }
 
@@ -1293,11 +1353,20 @@ namespace llarp
         const service::ConvoTag tag,
         const llarp_buffer_t& buf,
         service::ProtocolType t,
-        uint64_t seqno)
+        std::optional<uint64_t> seqno)
     {
       LogTrace("Inbound ", t, " packet (", buf.sz, "B) on convo ", tag);
+      // only packets we write to the user go through the reorder window, anything else that
+      // used up a seqno must not leave the packets after it waiting on it
+      const auto drop = [&]() {
+        if (seqno)
+          PassInboundSeqNo(tag, *seqno);
+        return false;
+      };
       if (t == service::ProtocolType::QUIC)
       {
+        if (seqno)
+          PassInboundSeqNo(tag, *seqno);
         auto* quic = GetQUICTunnel();
         if (!quic)
         {
@@ -1316,19 +1385,19 @@ namespace llarp
 
       if (t != service::ProtocolType::TrafficV4 && t != service::ProtocolType::TrafficV6
           && t != service::ProtocolType::Exit)
-        return false;
+        return drop();
       std::variant<service::Address, RouterID> addr;
       if (auto maybe = GetEndpointWithConvoTag(tag))
       {
         addr = *maybe;
       }
       else
-        return false;
+        return drop();
       huint128_t src, dst;
 
       net::IPPacket pkt;
       if (not pkt.Load(buf))
-        return false;
+        return drop();
 
       if (m_state->m_ExitEnabled)
       {
@@ -1336,7 +1405,7 @@ namespace llarp
 
         // check packet against exit policy and if as needed
         if (not ShouldAllowTraffic(pkt))
-          return false;
+          return drop();
 
         src = ObtainIPForAddr(addr);
         if (t == service::ProtocolType::Exit)
@@ -1375,15 +1444,15 @@ namespace llarp
           fromAddr = *ptr;
         }
         else  // don't allow snode
-          return false;
+          return drop();
         // make sure the mapping matches
         if (auto itr = m_ExitIPToExitAddress.find(src); itr != m_ExitIPToExitAddress.end())
         {
           if (itr->second != fromAddr)
-            return false;
+            return drop();
         }
         else
-          return false;
+          return drop();
       }
       else
       {
@@ -1391,32 +1460,48 @@ namespace llarp
         src = ObtainIPForAddr(addr);
         dst = m_OurIP;
       }
-      HandleWriteIPPacket(buf, src, dst, seqno);
+      // the packet we checked is the one we write, no need to load it again
+      if (seqno)
+        HandleWriteIPPacket(std::move(pkt), src, dst, *seqno, tag);
+      else
+        HandleWriteIPPacket(std::move(pkt), src, dst, 0, std::nullopt);
       return true;
     }
 
+    void
+    TunEndpoint::PassInboundSeqNo(const service::ConvoTag& tag, uint64_t seqno)
+    {
+      m_NetworkToUserReorder.Pass(tag, seqno, Now(), [this](auto ready) {
+        m_NetworkToUserReady.emplace_back(std::move(ready));
+      });
+      if (not m_NetworkToUserReady.empty())
+        Router()->TriggerPump();
+    }
+
     bool
     TunEndpoint::HandleWriteIPPacket(
-        const llarp_buffer_t& b, huint128_t src, huint128_t dst, uint64_t seqno)
+        net::IPPacket pkt,
+        huint128_t src,
+        huint128_t dst,
+        uint64_t seqno,
+        std::optional<service::ConvoTag> flow)
     {
-      ManagedBuffer buf(b);
-      WritePacket write;
-      write.seqno = seqno;
-      auto& pkt = write.pkt;
-      // load
-      if (!pkt.Load(buf))
-      {
+      if (pkt.empty())
         return false;
-      }
-      if (pkt.IsV4())
-      {
-        pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(src)), xhtonl(net::TruncateV6(dst)));
-      }
-      else if (pkt.IsV6())
+      WritePacket write;
+      write.pkt = std::move(pkt);
+      // the address rewrite is left to Pump, which does every queued packet at once
+      write.src = src;
+      write.dst = dst;
+      write.queued = std::chrono::steady_clock::now();
+      if (flow)
       {
-        pkt.UpdateIPv6Address(src, dst);
+        m_NetworkToUserReorder.Push(*flow, seqno, std::move(write), Now(), [this](auto ready) {
+          m_NetworkToUserReady.emplace_back(std::move(ready));
+        });
       }
-      m_NetworkToUserPktQueue.push(std::move(write));
+      else
+        m_NetworkToUserReady.emplace_back(std::move(write));
       // wake up so we ensure that all packets are written to user
       Router()->TriggerPump();
       return true;
@@ -7,7 +7,8 @@
 #include <llarp/net/net.hpp>
 #include <llarp/service/endpoint.hpp>
 #include <llarp/service/protocol_type.hpp>
-#include <llarp/util/priority_queue.hpp>
+#include <llarp/util/latency_histogram.hpp>
+#include <llarp/util/reorder_window.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/vpn/packet_router.hpp>
 #include <llarp/vpn/platform.hpp>
@@ -137,12 +138,21 @@ namespace llarp
           const service::ConvoTag tag,
           const llarp_buffer_t& pkt,
           service::ProtocolType t,
-          uint64_t seqno) override;
+          std::optional<uint64_t> seqno) override;
 
-      /// handle inbound traffic
+      /// overrides Endpoint
+      void
+      PassInboundSeqNo(const service::ConvoTag& tag, uint64_t seqno) override;
+
+      /// handle inbound traffic, packets of one flow are put back in seqno order before they are
+      /// written, packets with no flow go out as they come
       bool
       HandleWriteIPPacket(
-          const llarp_buffer_t& buf, huint128_t src, huint128_t dst, uint64_t seqno);
+          net::IPPacket pkt,
+          huint128_t src,
+          huint128_t dst,
+          uint64_t seqno,
+          std::optional<service::ConvoTag> flow);
 
       /// we got a packet from the user
       void
@@ -206,18 +216,30 @@ namespace llarp
      protected:
       struct WritePacket
       {
-        uint64_t seqno;
         net::IPPacket pkt;
-
-        bool
-        operator>(const WritePacket& other) const
-        {
-          return seqno > other.seqno;
-        }
+        /// the addresses pkt gets once it is written, rewritten in batches when we flush
+        huint128_t src;
+        huint128_t dst;
+        std::chrono::steady_clock::time_point queued;
       };
 
-      /// queue for sending packets to user from network
-      util::ascending_priority_queue<WritePacket> m_NetworkToUserPktQueue;
+      /// how long a packet waits on the ones sent before it on its flow
+      static constexpr auto NetworkToUserReorderDelay = 10ms;
+
+      /// packets from the network to the user held back per convo tag until they are in the
+      /// order they were sent
+      util::ReorderWindows<service::ConvoTag, WritePacket> m_NetworkToUserReorder{
+          NetworkToUserReorderDelay};
+      /// packets from the network ready to be written to the user on the next pump
+      std::vector<WritePacket> m_NetworkToUserReady;
+      /// set while we have a pump scheduled for when held packets time out
+      bool m_NetworkToUserWakeup = false;
+
+      uint64_t m_NetworkToUserWritten = 0;
+      uint64_t m_NetworkToUserDropped = 0;
+      size_t m_NetworkToUserMaxBatch = 0;
+      /// from queueing a packet to it being written
+      util::LatencyHistogram m_NetworkToUserLatency;
 
       void
       Pump(llarp_time_t now) override;
@@ -304,6 +326,8 @@ namespace llarp
       /// use v6?
       bool m_UseV6;
       std::string m_IfName;
+      size_t m_IfQueues = 1;
+      bool m_IfOffload = false;
 
       std::optional<huint128_t> m_BaseV6Address;
 
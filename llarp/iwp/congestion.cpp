@@ -0,0 +1,134 @@
+#include "congestion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    CongestionControl::CongestionControl(Time_t maxRTO) : m_MaxRTO{maxRTO}, m_RTO{maxRTO}
+    {}
+
+    void
+    CongestionControl::OnRTTSample(Time_t rtt)
+    {
+      const double sample = std::max<double>(rtt.count(), 0);
+      if (not m_HaveSample)
+      {
+        m_SRTT = sample;
+        m_RTTVar = sample / 2;
+        m_HaveSample = true;
+      }
+      else
+      {
+        m_RTTVar = 0.75 * m_RTTVar + 0.25 * std::abs(m_SRTT - sample);
+        m_SRTT = 0.875 * m_SRTT + 0.125 * sample;
+      }
+      const auto rto = Time_t{static_cast<Time_t::rep>(std::ceil(m_SRTT + 4 * m_RTTVar))};
+      m_RTO = std::clamp(rto, MinRTO, m_MaxRTO);
+    }
+
+    void
+    CongestionControl::OnSent(size_t num, Time_t now)
+    {
+      Refill(now);
+      m_InFlight += num;
+      m_Tokens = std::max(m_Tokens - num, 0.);
+    }
+
+    void
+    CongestionControl::OnAcked(size_t num, Time_t now)
+    {
+      OnDiscarded(num);
+      if (num == 0)
+        return;
+      if (m_Window < m_SlowStartThreshold)
+      {
+        m_Window = std::min(m_Window + num, MaxWindow);
+        return;
+      }
+      if (not m_EpochStart)
+      {
+        m_EpochStart = now;
+        m_WindowMax = std::max(m_WindowMax, m_Window);
+        m_K = std::cbrt((m_WindowMax - m_Window) / C);
+      }
+      // where the cubic curve through the last cut wants us an rtt from now
+      const double t = std::chrono::duration<double>(now - *m_EpochStart + SRTT()).count();
+      const double target = C * std::pow(t - m_K, 3) + m_WindowMax;
+      if (target > m_Window)
+        m_Window += (target - m_Window) / m_Window * num;
+      else
+        m_Window += 0.01 * num / m_Window;
+      m_Window = std::min(m_Window, MaxWindow);
+    }
+
+    void
+    CongestionControl::OnLost(size_t num, Time_t sentAt, Time_t now)
+    {
+      OnDiscarded(num);
+      if (sentAt <= m_RecoveryStart)
+        return;
+      m_WindowMax = m_Window;
+      m_Window = std::max(m_Window * Beta, MinWindow);
+      m_SlowStartThreshold = m_Window;
+      m_EpochStart.reset();
+      m_RecoveryStart = now;
+    }
+
+    void
+    CongestionControl::OnDiscarded(size_t num)
+    {
+      m_InFlight -= std::min(num, m_InFlight);
+    }
+
+    void
+    CongestionControl::BackoffRTO()
+    {
+      m_RTO = std::min(m_RTO * 2, m_MaxRTO);
+    }
+
+    size_t
+    CongestionControl::SendBudget(Time_t now)
+    {
+      Refill(now);
+      const auto window = static_cast<size_t>(m_Window);
+      if (m_InFlight >= window)
+        return 0;
+      const auto room = window - m_InFlight;
+      if (PacingRate() <= 0)
+        return room;
+      return std::min(room, static_cast<size_t>(m_Tokens));
+    }
+
+    std::optional<CongestionControl::Time_t>
+    CongestionControl::NextSendAt() const
+    {
+      // with a full window we wait on acks, not the pacer
+      const auto rate = PacingRate();
+      if (rate <= 0 or m_Tokens >= 1 or m_InFlight >= static_cast<size_t>(m_Window))
+        return std::nullopt;
+      return m_LastRefill + Time_t{static_cast<Time_t::rep>(std::ceil((1 - m_Tokens) / rate))};
+    }
+
+    double
+    CongestionControl::PacingRate() const
+    {
+      if (not m_HaveSample)
+        return 0;
+      return PacingGain * m_Window / std::max(m_SRTT, 1.);
+    }
+
+    void
+    CongestionControl::Refill(Time_t now)
+    {
+      const auto burst = std::max(MinBurst, m_Window / 4);
+      if (const auto rate = PacingRate(); rate > 0 and now > m_LastRefill)
+        m_Tokens = std::min(m_Tokens + (now - m_LastRefill).count() * rate, burst);
+      else if (rate <= 0)
+        m_Tokens = burst;
+      m_LastRefill = std::max(m_LastRefill, now);
+    }
+  }  // namespace iwp
+}  // namespace llarp
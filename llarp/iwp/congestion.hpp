@@ -0,0 +1,145 @@
+#pragma once
+
+#include <llarp/util/time.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// works out when and how much a session may send, counted in fragments.
+    ///
+    /// keeps a smoothed rtt and rtt variance from ack timing the way tcp does (rfc 6298) to get a
+    /// retransmission timeout, grows and shrinks a congestion window the way cubic does (rfc 8312)
+    /// and paces what the window lets out over an rtt so we do not put it all on the wire at once.
+    /// not thread safe, lives on the session's event loop.
+    struct CongestionControl
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      /// window we start with and the least we ever cut it to
+      static constexpr double InitialWindow = 32;
+      static constexpr double MinWindow = 4;
+      /// more than this would never be in flight anyways
+      static constexpr double MaxWindow = 4096;
+      /// cubic's multiplicative decrease and scaling constant, the latter in fragments per second^3
+      static constexpr double Beta = 0.7;
+      static constexpr double C = 0.4;
+      /// we pace a little faster than cwnd/srtt so the window fills
+      static constexpr double PacingGain = 1.25;
+      /// least number of fragments the pacer lets go at once
+      static constexpr double MinBurst = 4;
+      /// floor of the rto, we only have ms resolution timers
+      static constexpr Time_t MinRTO = 20ms;
+
+      /// maxRTO is both the rto we use before we have a sample and the most we back off to
+      explicit CongestionControl(Time_t maxRTO);
+
+      /// we got a clean measurement of how long a round trip took
+      void
+      OnRTTSample(Time_t rtt);
+
+      /// num fragments went out at now
+      void
+      OnSent(size_t num, Time_t now);
+
+      /// num fragments we had in flight got acked at now
+      void
+      OnAcked(size_t num, Time_t now);
+
+      /// num fragments we had in flight are not coming back, the last of them went out at sentAt.
+      /// cuts the window once per round of losses.
+      void
+      OnLost(size_t num, Time_t sentAt, Time_t now);
+
+      /// num fragments we had in flight are no longer our concern, without saying anything about
+      /// the network
+      void
+      OnDiscarded(size_t num);
+
+      /// a retransmission timer went off, double the rto until we get a new sample
+      void
+      BackoffRTO();
+
+      /// how many fragments we may send at now, both the window and the pacer allowing
+      size_t
+      SendBudget(Time_t now);
+
+      /// when the pacer lets the next fragment go, nullopt if it does right now or if we are held
+      /// up by the window instead
+      std::optional<Time_t>
+      NextSendAt() const;
+
+      Time_t
+      RTO() const
+      {
+        return m_RTO;
+      }
+
+      /// smoothed rtt, 0 until we have a sample
+      Time_t
+      SRTT() const
+      {
+        return Time_t{static_cast<Time_t::rep>(m_SRTT)};
+      }
+
+      Time_t
+      RTTVar() const
+      {
+        return Time_t{static_cast<Time_t::rep>(m_RTTVar)};
+      }
+
+      /// how long after we sent something an ack that does not cover it means it got lost
+      Time_t
+      AckDeadline() const
+      {
+        return SRTT() + RTTVar();
+      }
+
+      double
+      Window() const
+      {
+        return m_Window;
+      }
+
+      size_t
+      InFlight() const
+      {
+        return m_InFlight;
+      }
+
+     private:
+      /// fragments per ms the pacer lets out, 0 for no pacing
+      double
+      PacingRate() const;
+
+      void
+      Refill(Time_t now);
+
+      const Time_t m_MaxRTO;
+      Time_t m_RTO;
+      /// in ms, kept as doubles so the smoothing does not round away small changes
+      double m_SRTT = 0;
+      double m_RTTVar = 0;
+      bool m_HaveSample = false;
+
+      double m_Window = InitialWindow;
+      double m_SlowStartThreshold = MaxWindow;
+      /// window before the last cut and when the cubic epoch since then started
+      double m_WindowMax = 0;
+      /// seconds from the start of the epoch until the curve is back at m_WindowMax
+      double m_K = 0;
+      std::optional<Time_t> m_EpochStart;
+      /// losses of fragments sent before this do not cut the window again
+      Time_t m_RecoveryStart = 0s;
+
+      size_t m_InFlight = 0;
+
+      double m_Tokens = MinBurst;
+      Time_t m_LastRefill = 0s;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -48,7 +48,7 @@ namespace llarp::iwp
   }
 
   void
-  LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+  LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::RXPacket_t pkt)
   {
     std::shared_ptr<ILinkSession> session;
     auto itr = m_AuthedAddrs.find(from);
@@ -63,6 +63,7 @@ namespace llarp::iwp
           return;
         isNewSession = true;
         it = m_Pending.emplace(from, std::make_shared<Session>(this, from)).first;
+        MarkDirty(it->second);
       }
       session = it->second;
     }
@@ -97,18 +98,30 @@ namespace llarp::iwp
     m_Wakeup->Trigger();
   }
 
+  void
+  LinkLayer::WakeupPlaintext(std::weak_ptr<ILinkSession> session)
+  {
+    {
+      std::lock_guard lock{m_PlaintextMutex};
+      m_PlaintextReady.emplace_back(std::move(session));
+    }
+    m_Wakeup->Trigger();
+  }
+
   void
   LinkLayer::HandleWakeupPlaintext()
   {
-    // Copy bare pointers out first because HandlePlaintext can end up removing themselves from the
-    // structures.
+    // only visit the sessions that told us they have plaintext waiting
+    {
+      std::lock_guard lock{m_PlaintextMutex};
+      m_WakingUp.swap(m_PlaintextReady);
+    }
+    for (const auto& weak : m_WakingUp)
+    {
+      if (auto session = weak.lock())
+        session->HandlePlaintext();
+    }
     m_WakingUp.clear();  // Reused to minimize allocations.
-    for (const auto& [router_id, session] : m_AuthedLinks)
-      m_WakingUp.push_back(session.get());
-    for (const auto& [addr, session] : m_Pending)
-      m_WakingUp.push_back(session.get());
-    for (auto* session : m_WakingUp)
-      session->HandlePlaintext();
     PumpDone();
   }
 
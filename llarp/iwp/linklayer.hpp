@@ -42,11 +42,16 @@ namespace llarp::iwp
     Rank() const override;
 
     void
-    RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) override;
+    RecvFrom(const SockAddr& from, ILinkSession::RXPacket_t pkt) override;
 
     void
     WakeupPlaintext();
 
+    /// wake up the plaintext handler for a session that has decrypted packets waiting, can be
+    /// called from any thread
+    void
+    WakeupPlaintext(std::weak_ptr<ILinkSession> session);
+
     std::string
     PrintableName() const;
 
@@ -55,7 +60,9 @@ namespace llarp::iwp
     HandleWakeupPlaintext();
 
     const std::shared_ptr<EventLoopWakeup> m_Wakeup;
-    std::vector<ILinkSession*> m_WakingUp;
+    std::mutex m_PlaintextMutex;
+    std::vector<std::weak_ptr<ILinkSession>> m_PlaintextReady;
+    std::vector<std::weak_ptr<ILinkSession>> m_WakingUp;
     const bool m_Inbound;
   };
 
@@ -11,23 +11,24 @@ namespace llarp
         ILinkSession::Message_t msg,
         llarp_time_t now,
         ILinkSession::CompletionHandler handler,
-        uint16_t priority)
+        uint16_t priority,
+        size_t fragmentSize)
         : m_Data{std::move(msg)}
         , m_MsgID{msgid}
         , m_Completed{handler}
         , m_LastFlush{now}
         , m_StartedAt{now}
         , m_ResendPriority{priority}
+        , m_FragmentSize{std::max(fragmentSize, FragmentSize)}
     {
       const llarp_buffer_t buf(m_Data);
       CryptoManager::instance()->shorthash(m_Digest, buf);
-      m_Acks.set(0);
     }
 
     ILinkSession::Packet_t
     OutboundMessage::XMIT() const
     {
-      size_t extra = std::min(m_Data.size(), FragmentSize);
+      size_t extra = std::min(m_Data.size(), m_FragmentSize);
       auto xmit = CreatePacket(Command::eXMIT, 10 + 32 + extra, 0, 0);
       oxenc::write_host_as_big(
           static_cast<uint16_t>(m_Data.size()), xmit.data() + CommandOverhead + PacketOverhead);
@@ -48,52 +49,94 @@ namespace llarp
       m_Completed = nullptr;
     }
 
-    bool
-    OutboundMessage::ShouldFlush(llarp_time_t now) const
+    size_t
+    OutboundMessage::Ack(byte_t bitmask)
     {
-      return now - m_LastFlush >= TXFlushInterval;
+      const auto before = InFlight();
+      m_Acks |= Fragments_t{bitmask};
+      return before - InFlight();
     }
 
-    void
-    OutboundMessage::Ack(byte_t bitmask)
+    size_t
+    OutboundMessage::Fragments() const
     {
-      m_Acks = std::bitset<8>(bitmask);
+      return std::max<size_t>(1, (m_Data.size() + m_FragmentSize - 1) / m_FragmentSize);
     }
 
-    void
-    OutboundMessage::FlushUnAcked(
-        std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    size_t
+    OutboundMessage::InFlight() const
+    {
+      return (m_Sent & ~m_Acks).count();
+    }
+
+    bool
+    OutboundMessage::HasUnsent() const
+    {
+      return (m_Sent | m_Acks).count() < Fragments();
+    }
+
+    size_t
+    OutboundMessage::SendUnsent(
+        std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now, size_t budget)
     {
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
-      uint16_t idx = 0;
       const auto datasz = m_Data.size();
-      while (idx < datasz)
+      const auto num = Fragments();
+      size_t sent = 0;
+      for (size_t frag = 0; frag < num and sent < budget; ++frag)
       {
-        if (not m_Acks[idx / FragmentSize])
+        if (m_Acks[frag] or m_Sent[frag])
+          continue;
+        m_Sent.set(frag);
+        sent++;
+        // the first fragment rides along in the XMIT, which also tells them about the message
+        if (frag == 0)
         {
-          const size_t fragsz = idx + FragmentSize < datasz ? FragmentSize : datasz - idx;
-          auto frag = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
-          oxenc::write_host_as_big(idx, frag.data() + 2 + PacketOverhead);
-          oxenc::write_host_as_big(m_MsgID, frag.data() + 4 + PacketOverhead);
-          std::copy(
-              m_Data.begin() + idx,
-              m_Data.begin() + idx + fragsz,
-              frag.data() + PacketOverhead + Overhead + 2);
-          sendpkt(std::move(frag));
+          sendpkt(XMIT());
+          continue;
         }
-        idx += FragmentSize;
+        const uint16_t idx = frag * m_FragmentSize;
+        const size_t fragsz = idx + m_FragmentSize < datasz ? m_FragmentSize : datasz - idx;
+        auto pkt = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
+        oxenc::write_host_as_big(idx, pkt.data() + 2 + PacketOverhead);
+        oxenc::write_host_as_big(m_MsgID, pkt.data() + 4 + PacketOverhead);
+        std::copy(
+            m_Data.begin() + idx,
+            m_Data.begin() + idx + fragsz,
+            pkt.data() + PacketOverhead + Overhead + 2);
+        sendpkt(std::move(pkt));
+      }
+      if (sent)
+        m_LastFlush = now;
+      return sent;
+    }
+
+    bool
+    OutboundMessage::ShouldRetransmit(llarp_time_t now, llarp_time_t timeout) const
+    {
+      return InFlight() > 0 and now - m_LastFlush >= timeout;
+    }
+
+    size_t
+    OutboundMessage::MarkLost()
+    {
+      const auto lost = InFlight();
+      if (lost)
+      {
+        m_Sent &= m_Acks;
+        m_Retransmits++;
       }
-      m_LastFlush = now;
+      return lost;
     }
 
     bool
     OutboundMessage::IsTransmitted() const
     {
       const auto sz = m_Data.size();
-      for (uint16_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx < sz; idx += m_FragmentSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragmentSize))
           return false;
       }
       return true;
@@ -116,22 +159,27 @@ namespace llarp
       m_Completed = nullptr;
     }
 
-    InboundMessage::InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now)
-        : m_Data(size_t{sz}), m_Digset{std::move(h)}, m_MsgID(msgid), m_LastActiveAt{now}
+    InboundMessage::InboundMessage(
+        uint64_t msgid, uint16_t sz, ShortHash h, size_t fragmentSize, llarp_time_t now)
+        : m_Data(size_t{sz})
+        , m_Digset{std::move(h)}
+        , m_MsgID(msgid)
+        , m_LastActiveAt{now}
+        , m_FragmentSize{std::max(fragmentSize, FragmentSize)}
     {}
 
     void
     InboundMessage::HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now)
     {
-      if (idx + buf.sz > m_Data.size())
+      if (idx + buf.sz > m_Data.size() or idx % m_FragmentSize)
       {
         LogWarn("invalid fragment offset ", idx);
         return;
       }
       byte_t* dst = m_Data.data() + idx;
       std::copy_n(buf.base, buf.sz, dst);
-      m_Acks.set(idx / FragmentSize);
-      LogTrace("got fragment ", idx / FragmentSize);
+      m_Acks.set(idx / m_FragmentSize);
+      LogTrace("got fragment ", idx / m_FragmentSize);
       m_LastActiveAt = now;
     }
 
@@ -154,9 +202,9 @@ namespace llarp
     InboundMessage::IsCompleted() const
     {
       const auto sz = m_Data.size();
-      for (size_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx < sz; idx += m_FragmentSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragmentSize))
           return false;
       }
       return true;
@@ -24,11 +24,15 @@ namespace llarp
       eNACK = 4,
       /// multiack
       eMACK = 5,
+      /// path mtu probe or the reply to one
+      eMTUP = 6,
       /// close session
       eCLOS = 0xff,
     };
 
-    /// max size of data fragments
+    /// size of data fragments every peer takes, we only cut messages into larger ones once path
+    /// mtu discovery says the remote takes them.  it is also the smallest we use so that a whole
+    /// message fits in the 8 bits of an ack.
     static constexpr size_t FragmentSize = 1024;
     /// plaintext header overhead size
     static constexpr size_t CommandOverhead = 2;
@@ -41,16 +45,28 @@ namespace llarp
           ILinkSession::Message_t data,
           llarp_time_t now,
           ILinkSession::CompletionHandler handler,
-          uint16_t priority);
+          uint16_t priority,
+          size_t fragmentSize = FragmentSize);
+
+      using Fragments_t = std::bitset<MAX_LINK_MSG_SIZE / FragmentSize>;
 
       ILinkSession::Message_t m_Data;
       uint64_t m_MsgID = 0;
-      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      /// fragments the remote told us it has
+      Fragments_t m_Acks;
+      /// fragments we sent that are not known to be lost
+      Fragments_t m_Sent;
       ILinkSession::CompletionHandler m_Completed;
+      /// when we last sent a fragment
       llarp_time_t m_LastFlush = 0s;
       ShortHash m_Digest;
       llarp_time_t m_StartedAt = 0s;
       uint16_t m_ResendPriority;
+      /// how large the pieces we cut m_Data into are
+      size_t m_FragmentSize = FragmentSize;
+      /// how many times we gave up on fragments in flight, rtt samples are only taken off
+      /// messages that were never retransmitted
+      uint32_t m_Retransmits = 0;
 
       bool
       operator<(const OutboundMessage& other) const
@@ -64,14 +80,35 @@ namespace llarp
       ILinkSession::Packet_t
       XMIT() const;
 
-      void
+      /// take the acks the remote has, returns how many of our fragments in flight that acks
+      size_t
       Ack(byte_t bitmask);
 
-      void
-      FlushUnAcked(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+      /// how many fragments we cut the message into, the first one goes out in the XMIT
+      size_t
+      Fragments() const;
+
+      /// how many fragments we sent that are not acked yet
+      size_t
+      InFlight() const;
 
+      /// return true if we have fragments that are neither acked nor in flight
       bool
-      ShouldFlush(llarp_time_t now) const;
+      HasUnsent() const;
+
+      /// send up to budget of the fragments that are neither acked nor in flight, in order,
+      /// returns how many we sent
+      size_t
+      SendUnsent(
+          std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now, size_t budget);
+
+      /// return true if we have fragments in flight and sent nothing for timeout
+      bool
+      ShouldRetransmit(llarp_time_t now, llarp_time_t timeout) const;
+
+      /// give up on the fragments in flight so they are sent again, returns how many
+      size_t
+      MarkLost();
 
       void
       Completed();
@@ -89,14 +126,17 @@ namespace llarp
     struct InboundMessage
     {
       InboundMessage() = default;
-      InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now);
+      InboundMessage(
+          uint64_t msgid, uint16_t sz, ShortHash h, size_t fragmentSize, llarp_time_t now);
 
-      ILinkSession::Message_t m_Data;
+      std::vector<byte_t> m_Data;
       ShortHash m_Digset;
       uint64_t m_MsgID = 0;
       llarp_time_t m_LastACKSent = 0s;
       llarp_time_t m_LastActiveAt = 0s;
       std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      /// how large the pieces the remote cut the message into are, the XMIT tells us
+      size_t m_FragmentSize = FragmentSize;
 
       void
       HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now);
@@ -0,0 +1,88 @@
+#include "pmtu.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    PathMTU::PathMTU(size_t base, Time_t now) : m_Base{base}, m_PacketSize{base}
+    {
+      Search(now);
+    }
+
+    void
+    PathMTU::Search(Time_t when)
+    {
+      // candidates are largest first, we start from the largest one and work our way down to
+      // what we already have
+      m_Probe = Candidates[0] > m_PacketSize ? 0 : Candidates.size();
+      m_Attempts = 0;
+      m_Outstanding.reset();
+      m_NextProbeAt = m_Probe < Candidates.size() ? when : Time_t::max();
+    }
+
+    std::optional<size_t>
+    PathMTU::NextProbe(Time_t now)
+    {
+      if (now < m_NextProbeAt)
+        return std::nullopt;
+      if (not m_RemoteAnswers)
+      {
+        // a probe of the base size gets through for sure, if that goes unanswered the remote
+        // does not know about probes and we stop bothering it with them
+        if (m_Attempts >= Attempts)
+        {
+          m_Outstanding.reset();
+          m_NextProbeAt = Time_t::max();
+          return std::nullopt;
+        }
+        m_Attempts++;
+        m_NextProbeAt = now + ProbeInterval;
+        return m_Outstanding = m_Base;
+      }
+      if (m_Probe >= Candidates.size())
+        return std::nullopt;
+      if (m_Attempts >= Attempts)
+      {
+        m_Probe++;
+        m_Attempts = 0;
+        if (m_Probe >= Candidates.size() or Candidates[m_Probe] <= m_PacketSize)
+        {
+          // nothing larger than what we have gets through, look again later
+          Search(now + RaiseInterval);
+          return std::nullopt;
+        }
+      }
+      m_Attempts++;
+      m_NextProbeAt = now + ProbeInterval;
+      return m_Outstanding = Candidates[m_Probe];
+    }
+
+    bool
+    PathMTU::ProbeAcked(size_t size, Time_t now)
+    {
+      // anything but the probe we wait on is either stale or made up
+      if (size != m_Outstanding)
+        return false;
+      if (not m_RemoteAnswers)
+      {
+        m_RemoteAnswers = true;
+        Search(now);
+        return true;
+      }
+      m_PacketSize = std::max(m_PacketSize, size);
+      Search(now + RaiseInterval);
+      return true;
+    }
+
+    void
+    PathMTU::BlackHole(Time_t now)
+    {
+      if (m_PacketSize == m_Base)
+        return;
+      m_PacketSize = m_Base;
+      Search(now + ProbeInterval);
+    }
+  }  // namespace iwp
+}  // namespace llarp
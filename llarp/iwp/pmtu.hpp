@@ -0,0 +1,87 @@
+#pragma once
+
+#include <llarp/util/time.hpp>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// finds how large a packet we can get to the remote, the way rfc 8899 (dplpmtud) does it:
+    /// we send padded probes of the sizes we would like to use and only go up to one once the
+    /// remote says it got a probe of that size.  probes only tell us anything if they cannot be
+    /// fragmented on the way, see UDPHandle::set_dont_fragment.  before searching we check that
+    /// the remote answers a probe of the base size at all; remotes that do not know about probes
+    /// are left alone at the base size everyone can take.  not thread safe.
+    struct PathMTU
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      /// udp payload sizes we try, largest first: a 1500 byte mtu over ipv4 and ipv6, and a
+      /// size that gets through most tunnels
+      static constexpr std::array<size_t, 3> Candidates{1472, 1452, 1380};
+      /// how many probes of one size go unanswered before we try the next smaller one
+      static constexpr size_t Attempts = 2;
+      /// time between probes
+      static constexpr Time_t ProbeInterval = 1s;
+      /// how long we stay put after a search before looking for a larger size again
+      static constexpr Time_t RaiseInterval = 10min;
+
+      /// base is the packet size we may always send
+      PathMTU(size_t base, Time_t now);
+
+      /// the largest packet we know gets through
+      size_t
+      PacketSize() const
+      {
+        return m_PacketSize;
+      }
+
+      /// the size of the probe to send at now if one is due
+      std::optional<size_t>
+      NextProbe(Time_t now);
+
+      /// when we next want to send a probe
+      Time_t
+      NextProbeAt() const
+      {
+        return m_NextProbeAt;
+      }
+
+      /// the remote got our probe of size bytes, returns false if that is not the probe we are
+      /// waiting on
+      bool
+      ProbeAcked(size_t size, Time_t now);
+
+      /// false until the remote answered a probe, and for good once it ignored the first ones
+      bool
+      RemoteAnswers() const
+      {
+        return m_RemoteAnswers;
+      }
+
+      /// what we send at our packet size stopped getting through, drop back to the base size and
+      /// search again
+      void
+      BlackHole(Time_t now);
+
+     private:
+      /// start looking for a larger size at when
+      void
+      Search(Time_t when);
+
+      const size_t m_Base;
+      size_t m_PacketSize;
+      bool m_RemoteAnswers = false;
+      /// the size of the last probe we sent until it is acked or we move on
+      std::optional<size_t> m_Outstanding;
+      /// index into Candidates of what we probe next
+      size_t m_Probe = 0;
+      size_t m_Attempts = 0;
+      Time_t m_NextProbeAt;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -39,6 +39,7 @@ namespace llarp
         , m_RemoteAddr{ai}
         , m_ChosenAI(ai)
         , m_RemoteRC(rc)
+        , m_PathMTU{FragmentSize + XMITOverhead, p->Now()}
         , m_PlaintextRecv{PlaintextQueueSize}
     {
       token.Zero();
@@ -53,6 +54,7 @@ namespace llarp
         , m_Parent(p)
         , m_CreatedAt{p->Now()}
         , m_RemoteAddr{from}
+        , m_PathMTU{FragmentSize + XMITOverhead, p->Now()}
         , m_PlaintextRecv{PlaintextQueueSize}
     {
       token.Randomize();
@@ -123,8 +125,9 @@ namespace llarp
         LogError("failed to sign our RC for ", m_RemoteAddr);
         return;
       }
-      ILinkSession::Message_t data(LinkIntroMessage::MaxSize + PacketOverhead);
-      llarp_buffer_t buf(data);
+      auto data = PacketPool::LocalLarge().Acquire(LinkIntroMessage::MaxSize + PacketOverhead);
+      std::fill(data.begin(), data.end(), 0);
+      llarp_buffer_t buf{data.data(), data.size()};
       if (not msg.BEncode(&buf))
       {
         LogError("failed to encode LIM for ", m_RemoteAddr);
@@ -196,16 +199,17 @@ namespace llarp
       }
       const auto now = m_Parent->Now();
       const auto msgid = m_TXID++;
-      const auto bufsz = buf.size();
-      auto& msg =
-          m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed, priority})
-              .first->second;
+      m_TXMsgs.emplace(
+          msgid,
+          OutboundMessage{
+              msgid,
+              std::move(buf),
+              now,
+              completed,
+              priority,
+              m_PathMTU.PacketSize() - XMITOverhead});
       TriggerPump();
-      EncryptAndSend(msg.XMIT());
-      if (bufsz > FragmentSize)
-      {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
-      }
+      SendPending(now);
       m_Stats.totalInFlightTX++;
       LogDebug("send message ", msgid, " to ", m_RemoteAddr);
       return true;
@@ -236,15 +240,115 @@ namespace llarp
       }
     }
 
+    void
+    Session::SendPending(llarp_time_t now)
+    {
+      auto budget = m_Congestion.SendBudget(now);
+      if (budget == 0)
+        return;
+      std::priority_queue<
+          OutboundMessage*,
+          std::vector<OutboundMessage*>,
+          ComparePtr<OutboundMessage*>>
+          pending;
+      for (auto& [id, msg] : m_TXMsgs)
+      {
+        if (msg.HasUnsent())
+          pending.push(&msg);
+      }
+      for (; budget > 0 and not pending.empty(); pending.pop())
+      {
+        const auto sent =
+            pending.top()->SendUnsent(util::memFn(&Session::EncryptAndSend, this), now, budget);
+        m_Congestion.OnSent(sent, now);
+        m_Stats.totalFragmentsTX += sent;
+        budget -= sent;
+      }
+      if (m_State == State::Ready)
+        SendMTUProbe(now);
+    }
+
+    void
+    Session::RetransmitTimedOut(llarp_time_t now)
+    {
+      const auto rto = m_Congestion.RTO();
+      bool timedOut = false;
+      for (auto& [id, msg] : m_TXMsgs)
+      {
+        if (not msg.ShouldRetransmit(now, rto))
+          continue;
+        RetransmitTXMsg(msg, now);
+        timedOut = true;
+      }
+      if (timedOut)
+        m_Congestion.BackoffRTO();
+    }
+
+    void
+    Session::RetransmitTXMsg(OutboundMessage& msg, llarp_time_t now)
+    {
+      const auto sentAt = msg.m_LastFlush;
+      const auto lost = msg.MarkLost();
+      m_Congestion.OnLost(lost, sentAt, now);
+      m_Stats.totalRetransmitsTX += lost;
+    }
+
+    void
+    Session::SendMTUProbe(llarp_time_t now)
+    {
+      // a probe that is not back by the time we would send the next one is gone, but that says
+      // something about its size and not about congestion
+      if (m_MTUProbeSentAt and *m_MTUProbeSentAt + PathMTU::ProbeInterval <= now)
+      {
+        m_Congestion.OnDiscarded(1);
+        m_MTUProbeSentAt.reset();
+      }
+      if (now < m_PathMTU.NextProbeAt() or m_MTUProbeSentAt)
+        return;
+      // probes go through the congestion window like everything else we send
+      if (m_Congestion.SendBudget(now) == 0)
+        return;
+      const auto size = m_PathMTU.NextProbe(now);
+      if (not size)
+        return;
+      m_Congestion.OnSent(1, now);
+      m_MTUProbeSentAt = now;
+      // pad the probe out to exactly the size we want to know about
+      auto probe =
+          CreatePacket(Command::eMTUP, 3, *size - (PacketOverhead + CommandOverhead + 3), 0);
+      probe[PacketOverhead + CommandOverhead] = 0;
+      oxenc::write_host_as_big(
+          static_cast<uint16_t>(*size), probe.data() + PacketOverhead + CommandOverhead + 1);
+      LogTrace("send ", *size, " byte mtu probe to ", m_RemoteAddr);
+      EncryptAndSend(std::move(probe));
+    }
+
+    void
+    Session::HandleTXMsgAcked(OutboundMessage& msg, llarp_time_t now)
+    {
+      if (msg.m_FragmentSize > FragmentSize)
+        m_LargeFragmentTimeouts = 0;
+      m_Congestion.OnAcked(msg.InFlight(), now);
+      // karn: we cannot tell which send of a retransmitted message an ack is for
+      if (msg.m_Retransmits == 0)
+        m_Congestion.OnRTTSample(now - msg.m_LastFlush);
+      m_Stats.totalAckedTX++;
+      m_Stats.totalInFlightTX--;
+      msg.Completed();
+    }
+
     void
     Session::TriggerPump()
     {
+      if (not m_PumpQueued.test_and_set())
+        m_Parent->MarkDirty(weak_from_this());
       m_Parent->Router()->TriggerPump();
     }
 
     void
     Session::Pump()
     {
+      m_PumpQueued.clear();
       const auto now = m_Parent->Now();
       if (m_State == State::Ready || m_State == State::LinkIntro)
       {
@@ -257,22 +361,13 @@ namespace llarp
             msg.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
           }
         }
-        std::priority_queue<
-            OutboundMessage*,
-            std::vector<OutboundMessage*>,
-            ComparePtr<OutboundMessage*>>
-            to_resend;
-        for (auto& [id, msg] : m_TXMsgs)
-        {
-          if (msg.ShouldFlush(now))
-            to_resend.push(&msg);
-        }
-        if (not to_resend.empty())
-        {
-          for (auto& msg = to_resend.top(); not to_resend.empty(); to_resend.pop())
-            msg->FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
-        }
+        RetransmitTimedOut(now);
+        SendPending(now);
       }
+      // SendPending only gets to the probe when the window has room, this also lets go of a lost
+      // probe when it has not
+      if (m_State == State::Ready)
+        SendMTUProbe(now);
       if (not m_EncryptNext.empty())
       {
         m_Parent->QueueWork(
@@ -282,8 +377,9 @@ namespace llarp
 
       if (not m_DecryptNext.empty())
       {
-        m_Parent->QueueWork(
-            [self = shared_from_this(), data = m_DecryptNext] { self->DecryptWorker(data); });
+        m_Parent->QueueWork([self = shared_from_this(), data = std::move(m_DecryptNext)]() mutable {
+          self->DecryptWorker(std::move(data));
+        });
         m_DecryptNext.clear();
       }
     }
@@ -313,11 +409,64 @@ namespace llarp
       return false;
     }
 
+    llarp_time_t
+    Session::NextPumpAt(llarp_time_t now) const
+    {
+      auto next = m_CreatedAt + LinkLayerConnectTimeout;
+      if (m_State == State::Ready)
+      {
+        next = std::min(
+            m_LastRX
+                + (m_Inbound and not m_RemoteRC.IsPublicRouter() ? DefaultLinkSessionLifetime
+                                                                 : SessionAliveTimeout),
+            m_LastTX + PingInterval);
+      }
+      if (m_State == State::Ready or m_State == State::LinkIntro)
+      {
+        // in flight messages need acks sent on time
+        if (not m_RXMsgs.empty())
+          next = std::min(next, now + ACKResendInterval);
+        // and retransmissions, and whatever the pacer holds back has to go when it says so
+        bool unsent = false;
+        for (const auto& [id, msg] : m_TXMsgs)
+        {
+          if (msg.InFlight())
+            next = std::min(next, msg.m_LastFlush + m_Congestion.RTO());
+          unsent = unsent or msg.HasUnsent();
+        }
+        if (unsent)
+        {
+          if (const auto at = m_Congestion.NextSendAt())
+            next = std::min(next, *at);
+        }
+      }
+      if (m_State == State::Ready)
+      {
+        // a probe held up by a full window goes out with whatever the acks let out, see
+        // SendPending, and one held up by the pacer when the pacer says so
+        auto probeAt = m_PathMTU.NextProbeAt();
+        if (m_MTUProbeSentAt)
+          probeAt = std::min(probeAt, *m_MTUProbeSentAt + PathMTU::ProbeInterval);
+        else if (
+            probeAt <= now
+            and m_Congestion.InFlight() >= static_cast<size_t>(m_Congestion.Window()))
+          probeAt = next;
+        else if (const auto at = m_Congestion.NextSendAt(); probeAt <= now and at)
+          probeAt = *at;
+        next = std::min(next, probeAt);
+      }
+      return next;
+    }
+
     SessionStats
     Session::GetSessionStats() const
     {
       // TODO: thread safety
-      return m_Stats;
+      auto stats = m_Stats;
+      stats.congestionWindow = m_Congestion.Window();
+      stats.smoothedRTT = m_Congestion.SRTT();
+      stats.rttVariance = m_Congestion.RTTVar();
+      return stats;
     }
 
     util::StatusObject
@@ -337,6 +486,19 @@ namespace llarp
           {"txPktsAcked", m_Stats.totalAckedTX},
           {"txPktsDropped", m_Stats.totalDroppedTX},
           {"txPktsInFlight", m_Stats.totalInFlightTX},
+          {"txFrags", m_Stats.totalFragmentsTX},
+          {"txFragsInFlight", m_Congestion.InFlight()},
+          {"txRetransmits", m_Stats.totalRetransmitsTX},
+          {"txRetransmitRatio",
+           m_Stats.totalFragmentsTX
+               ? double(m_Stats.totalRetransmitsTX) / m_Stats.totalFragmentsTX
+               : 0.},
+          {"cwnd", m_Congestion.Window()},
+          {"srtt", to_json(m_Congestion.SRTT())},
+          {"rttvar", to_json(m_Congestion.RTTVar())},
+          {"rto", to_json(m_Congestion.RTO())},
+          {"pmtu", m_PathMTU.PacketSize()},
+          {"fragmentSize", m_PathMTU.PacketSize() - XMITOverhead},
 
           {"state", StateToString(m_State)},
           {"inbound", m_Inbound},
@@ -395,6 +557,9 @@ namespace llarp
           {
             m_Stats.totalDroppedTX++;
             m_Stats.totalInFlightTX--;
+            m_Congestion.OnDiscarded(itr->second.InFlight());
+            if (itr->second.m_FragmentSize > FragmentSize)
+              m_LargeFragmentTimeouts++;
             LogTrace("Dropped unacked packet to ", m_RemoteAddr);
             itr->second.InformTimeout();
             itr = m_TXMsgs.erase(itr);
@@ -402,6 +567,13 @@ namespace llarp
           else
             ++itr;
         }
+        // large fragments stopped getting through, the path got narrower under us
+        if (m_LargeFragmentTimeouts >= MaxLargeFragmentTimeouts)
+        {
+          LogInfo("path mtu black hole to ", m_RemoteAddr, ", going back to the base size");
+          m_PathMTU.BlackHole(now);
+          m_LargeFragmentTimeouts = 0;
+        }
       }
       {
         // remove pending inbound messages that timed out
@@ -471,7 +643,7 @@ namespace llarp
     }
 
     void
-    Session::HandleCreateSessionRequest(Packet_t pkt)
+    Session::HandleCreateSessionRequest(RXPacket_t pkt)
     {
       if (not DecryptMessageInPlace(pkt))
       {
@@ -503,7 +675,7 @@ namespace llarp
     }
 
     void
-    Session::HandleGotIntro(Packet_t pkt)
+    Session::HandleGotIntro(RXPacket_t pkt)
     {
       if (pkt.size() < (Introduction::SIZE + PacketOverhead))
       {
@@ -553,7 +725,7 @@ namespace llarp
     }
 
     void
-    Session::HandleGotIntroAck(Packet_t pkt)
+    Session::HandleGotIntroAck(RXPacket_t pkt)
     {
       if (pkt.size() < (token.size() + PacketOverhead))
       {
@@ -584,7 +756,7 @@ namespace llarp
     }
 
     bool
-    Session::DecryptMessageInPlace(Packet_t& pkt)
+    Session::DecryptMessageInPlace(RXPacket_t& pkt)
     {
       if (pkt.size() <= PacketOverhead)
       {
@@ -634,14 +806,14 @@ namespace llarp
     }
 
     void
-    Session::HandleSessionData(Packet_t pkt)
+    Session::HandleSessionData(RXPacket_t pkt)
     {
       m_DecryptNext.emplace_back(std::move(pkt));
       TriggerPump();
     }
 
     void
-    Session::DecryptWorker(CryptoQueue_t msgs)
+    Session::DecryptWorker(RXQueue_t msgs)
     {
       auto itr = msgs.begin();
       while (itr != msgs.end())
@@ -667,7 +839,7 @@ namespace llarp
       }
       m_PlaintextRecv.tryPushBack(std::move(msgs));
       m_PlaintextEmpty.clear();
-      m_Parent->WakeupPlaintext();
+      m_Parent->WakeupPlaintext(weak_from_this());
     }
 
     void
@@ -703,6 +875,9 @@ namespace llarp
             case Command::eMACK:
               HandleMACK(std::move(result));
               break;
+            case Command::eMTUP:
+              HandleMTUP(std::move(result));
+              break;
             default:
               LogError("invalid command ", int(result[PacketOverhead + 1]), " from ", m_RemoteAddr);
           }
@@ -713,7 +888,7 @@ namespace llarp
     }
 
     void
-    Session::HandleMACK(Packet_t data)
+    Session::HandleMACK(RXPacket_t data)
     {
       if (data.size() < (3 + PacketOverhead))
       {
@@ -727,30 +902,34 @@ namespace llarp
         return;
       }
       LogTrace("got ", int(numAcks), " mack from ", m_RemoteAddr);
+      const auto now = m_Parent->Now();
+      bool acked = false;
       byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
       while (numAcks > 0)
       {
-        auto acked = oxenc::load_big_to_host<uint64_t>(ptr);
-        LogTrace("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
+        auto txid = oxenc::load_big_to_host<uint64_t>(ptr);
+        LogTrace("mack containing txid=", txid, " from ", m_RemoteAddr);
+        auto itr = m_TXMsgs.find(txid);
         if (itr != m_TXMsgs.end())
         {
-          m_Stats.totalAckedTX++;
-          m_Stats.totalInFlightTX--;
-          itr->second.Completed();
+          HandleTXMsgAcked(itr->second, now);
           m_TXMsgs.erase(itr);
+          acked = true;
         }
         else
         {
-          LogTrace("ignored mack for txid=", acked, " from ", m_RemoteAddr);
+          LogTrace("ignored mack for txid=", txid, " from ", m_RemoteAddr);
         }
         ptr += sizeof(uint64_t);
         numAcks--;
       }
+      // the window opened up
+      if (acked)
+        SendPending(now);
     }
 
     void
-    Session::HandleNACK(Packet_t data)
+    Session::HandleNACK(RXPacket_t data)
     {
       if (data.size() < (CommandOverhead + sizeof(uint64_t) + PacketOverhead))
       {
@@ -759,20 +938,22 @@ namespace llarp
       }
       auto txid = oxenc::load_big_to_host<uint64_t>(data.data() + CommandOverhead + PacketOverhead);
       LogTrace("got nack on ", txid, " from ", m_RemoteAddr);
+      const auto now = m_Parent->Now();
       auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      // they got data for a message they do not know about, so they never got the XMIT and
+      // dropped what we sent.  we get a nack for every fragment of it, only the ones for what we
+      // sent an rtt or more ago are news.
+      if (itr != m_TXMsgs.end() and itr->second.ShouldRetransmit(now, m_Congestion.AckDeadline()))
       {
-        EncryptAndSend(itr->second.XMIT());
+        RetransmitTXMsg(itr->second, now);
+        SendPending(now);
       }
-      m_LastRX = m_Parent->Now();
+      m_LastRX = now;
     }
 
     void
-    Session::HandleXMIT(Packet_t data)
+    Session::HandleXMIT(RXPacket_t data)
     {
-      static constexpr size_t XMITOverhead =
-          (CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t)
-           + ShortHash::SIZE);
       if (data.size() < XMITOverhead)
       {
         LogError("short XMIT from ", m_RemoteAddr);
@@ -802,15 +983,21 @@ namespace llarp
         auto itr = m_RXMsgs.find(rxid);
         if (itr == m_RXMsgs.end())
         {
-          itr = m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, ShortHash{pos}, m_Parent->Now()})
+          // the XMIT carries the first fragment, which tells us how large the rest are
+          const size_t extra = data.size() - XMITOverhead;
+          if (extra > sz or (extra < sz and extra < FragmentSize))
+          {
+            LogError("bad first fragment size ", extra, " in XMIT from ", m_RemoteAddr);
+            return;
+          }
+          itr = m_RXMsgs
+                    .emplace(rxid, InboundMessage{rxid, sz, ShortHash{pos}, extra, m_Parent->Now()})
                     .first;
           TriggerPump();
 
-          sz = std::min(sz, uint16_t{FragmentSize});
-          if ((data.size() - XMITOverhead) == sz)
           {
             {
-              const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
+              const llarp_buffer_t buf(data.data() + XMITOverhead, extra);
               itr->second.HandleData(0, buf, now);
               if (not itr->second.IsCompleted())
               {
@@ -832,7 +1019,7 @@ namespace llarp
     }
 
     void
-    Session::HandleDATA(Packet_t data)
+    Session::HandleDATA(RXPacket_t data)
     {
       if (data.size() < (CommandOverhead + sizeof(uint16_t) + sizeof(uint64_t) + PacketOverhead))
       {
@@ -894,7 +1081,7 @@ namespace llarp
     }
 
     void
-    Session::HandleACKS(Packet_t data)
+    Session::HandleACKS(RXPacket_t data)
     {
       if (data.size() < (11 + PacketOverhead))
       {
@@ -910,29 +1097,69 @@ namespace llarp
         LogTrace("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      auto& msg = itr->second;
+      m_Congestion.OnAcked(msg.Ack(data[10 + PacketOverhead]), now);
 
-      if (itr->second.IsTransmitted())
+      if (msg.IsTransmitted())
       {
         LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
+        HandleTXMsgAcked(msg, now);
+        m_TXMsgs.erase(itr);
       }
-      else
+      else if (msg.ShouldRetransmit(now, m_Congestion.AckDeadline()))
       {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        // they told us what they have after everything we sent should have gotten there
+        RetransmitTXMsg(msg, now);
       }
+      SendPending(now);
     }
 
     void
-    Session::HandleCLOS(Packet_t)
+    Session::HandleCLOS(RXPacket_t)
     {
       LogInfo("remote closed by ", m_RemoteAddr);
       Close();
     }
 
     void
-    Session::HandlePING(Packet_t)
+    Session::HandleMTUP(RXPacket_t data)
+    {
+      if (data.size() < 3 + CommandOverhead + PacketOverhead)
+      {
+        LogError("short mtu probe from ", m_RemoteAddr);
+        return;
+      }
+      const byte_t* ptr = data.data() + CommandOverhead + PacketOverhead;
+      const auto size = oxenc::load_big_to_host<uint16_t>(ptr + 1);
+      if (ptr[0] == 0)
+      {
+        // a probe, only say we got it if it made it here whole
+        if (data.size() != size)
+          return;
+        auto ack = CreatePacket(Command::eMTUP, 3);
+        ack[PacketOverhead + CommandOverhead] = 1;
+        oxenc::write_host_as_big(size, ack.data() + PacketOverhead + CommandOverhead + 1);
+        EncryptAndSend(std::move(ack));
+        return;
+      }
+      const auto now = m_Parent->Now();
+      const auto before = m_PathMTU.PacketSize();
+      if (not m_PathMTU.ProbeAcked(size, now))
+      {
+        LogDebug("unexpected ", size, " byte mtu probe ack from ", m_RemoteAddr);
+        return;
+      }
+      if (m_MTUProbeSentAt)
+      {
+        m_Congestion.OnAcked(1, now);
+        m_MTUProbeSentAt.reset();
+      }
+      if (m_PathMTU.PacketSize() != before)
+        LogDebug("path mtu to ", m_RemoteAddr, " is now ", m_PathMTU.PacketSize());
+    }
+
+    void
+    Session::HandlePING(RXPacket_t)
     {
       m_LastRX = m_Parent->Now();
     }
@@ -955,7 +1182,7 @@ namespace llarp
     }
 
     bool
-    Session::Recv_LL(ILinkSession::Packet_t data)
+    Session::Recv_LL(ILinkSession::RXPacket_t data)
     {
       m_RXRate += data.size();
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <llarp/link/session.hpp>
+#include "congestion.hpp"
 #include "linklayer.hpp"
 #include "message_buffer.hpp"
+#include "pmtu.hpp"
 #include <llarp/net/ip_address.hpp>
 
 #include <map>
@@ -18,6 +20,10 @@ namespace llarp
   {
     /// packet crypto overhead size
     static constexpr size_t PacketOverhead = HMACSIZE + TUNNONCESIZE;
+    /// wire size of an XMIT besides the first fragment it carries, the largest packet we send
+    /// is an XMIT with a full fragment
+    static constexpr size_t XMITOverhead =
+        CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t) + ShortHash::SIZE;
     /// creates a packet with plaintext size + wire overhead + random pad
     ILinkSession::Packet_t
     CreatePacket(Command cmd, size_t plainsize, size_t min_pad = 16, size_t pad_variance = 16);
@@ -29,7 +35,8 @@ namespace llarp
     static constexpr auto ReplayWindow = (ReceivalTimeout * 3) / 2;
     /// How often to acks RX messages
     static constexpr auto ACKResendInterval = DeliveryTimeout / 2;
-    /// How often to retransmit TX fragments
+    /// Longest we wait to retransmit TX fragments, the retransmission timeout before we have
+    /// an rtt estimate
     static constexpr auto TXFlushInterval = (DeliveryTimeout / 5) * 4;
     /// How often we send a keepalive
     static constexpr std::chrono::milliseconds PingInterval = 5s;
@@ -43,6 +50,10 @@ namespace llarp
       /// maximum number of messages we can ack in a multiack
       static constexpr std::size_t MaxACKSInMACK = 1024 / sizeof(uint64_t);
 
+      /// how many TX messages with large fragments time out in a row before we take it that the
+      /// path mtu went down
+      static constexpr std::size_t MaxLargeFragmentTimeouts = 3;
+
       /// outbound session
       Session(LinkLayer* parent, const RouterContact& rc, const AddressInfo& ai);
       /// inbound session
@@ -76,7 +87,7 @@ namespace llarp
       void
       Close() override;
 
-      bool Recv_LL(ILinkSession::Packet_t) override;
+      bool Recv_LL(ILinkSession::RXPacket_t) override;
 
       bool
       SendKeepAlive() override;
@@ -123,6 +134,9 @@ namespace llarp
       bool
       ShouldPing() const override;
 
+      llarp_time_t
+      NextPumpAt(llarp_time_t now) const override;
+
       SessionStats
       GetSessionStats() const override;
 
@@ -194,47 +208,80 @@ namespace llarp
       std::map<uint64_t, InboundMessage> m_RXMsgs;
       std::map<uint64_t, OutboundMessage> m_TXMsgs;
 
+      /// decides how many fragments of m_TXMsgs go out and when
+      CongestionControl m_Congestion{TXFlushInterval};
+      /// decides how large the fragments of new TX messages are
+      PathMTU m_PathMTU;
+      /// when the mtu probe we count in m_Congestion went out, until it is acked or given up on
+      std::optional<llarp_time_t> m_MTUProbeSentAt;
+      /// TX messages with fragments larger than FragmentSize that timed out in a row
+      size_t m_LargeFragmentTimeouts = 0;
+
       /// maps rxid to time recieved
       std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
       /// rx messages to send in next round of multiacks
       util::ascending_priority_queue<uint64_t> m_SendMACKs;
 
       using CryptoQueue_t = std::vector<Packet_t>;
+      using RXQueue_t = std::vector<RXPacket_t>;
 
       CryptoQueue_t m_EncryptNext;
-      CryptoQueue_t m_DecryptNext;
+      RXQueue_t m_DecryptNext;
 
       std::atomic_flag m_PlaintextEmpty;
-      llarp::thread::Queue<CryptoQueue_t> m_PlaintextRecv;
+      llarp::thread::Queue<RXQueue_t> m_PlaintextRecv;
       std::atomic_flag m_SentClosed;
+      /// set while we are on our link layer's dirty list
+      std::atomic_flag m_PumpQueued = ATOMIC_FLAG_INIT;
 
       void
       EncryptWorker(CryptoQueue_t msgs);
 
       void
-      DecryptWorker(CryptoQueue_t msgs);
+      DecryptWorker(RXQueue_t msgs);
 
       void
-      HandleGotIntro(Packet_t pkt);
+      HandleGotIntro(RXPacket_t pkt);
 
       void
-      HandleGotIntroAck(Packet_t pkt);
+      HandleGotIntroAck(RXPacket_t pkt);
 
       void
-      HandleCreateSessionRequest(Packet_t pkt);
+      HandleCreateSessionRequest(RXPacket_t pkt);
 
       void
-      HandleAckSession(Packet_t pkt);
+      HandleAckSession(RXPacket_t pkt);
 
       void
-      HandleSessionData(Packet_t pkt);
+      HandleSessionData(RXPacket_t pkt);
 
       bool
-      DecryptMessageInPlace(Packet_t& pkt);
+      DecryptMessageInPlace(RXPacket_t& pkt);
 
       void
       SendMACK();
 
+      /// send the fragments of our TX messages that the congestion control lets out, most
+      /// important messages first
+      void
+      SendPending(llarp_time_t now);
+
+      /// give up on the TX fragments that the retransmission timeout passed on
+      void
+      RetransmitTimedOut(llarp_time_t now);
+
+      /// give up on the fragments of msg in flight so they are sent again
+      void
+      RetransmitTXMsg(OutboundMessage& msg, llarp_time_t now);
+
+      /// send a path mtu probe if one is due
+      void
+      SendMTUProbe(llarp_time_t now);
+
+      /// msg is fully acked, take an rtt sample off it if we can
+      void
+      HandleTXMsgAcked(OutboundMessage& msg, llarp_time_t now);
+
       void
       HandleRecvMsgCompleted(const InboundMessage& msg);
 
@@ -254,25 +301,28 @@ namespace llarp
       SendOurLIM(ILinkSession::CompletionHandler h = nullptr);
 
       void
-      HandleXMIT(Packet_t msg);
+      HandleXMIT(RXPacket_t msg);
+
+      void
+      HandleDATA(RXPacket_t msg);
 
       void
-      HandleDATA(Packet_t msg);
+      HandleACKS(RXPacket_t msg);
 
       void
-      HandleACKS(Packet_t msg);
+      HandleNACK(RXPacket_t msg);
 
       void
-      HandleNACK(Packet_t msg);
+      HandlePING(RXPacket_t msg);
 
       void
-      HandlePING(Packet_t msg);
+      HandleCLOS(RXPacket_t msg);
 
       void
-      HandleCLOS(Packet_t msg);
+      HandleMACK(RXPacket_t msg);
 
       void
-      HandleMACK(Packet_t msg);
+      HandleMTUP(RXPacket_t msg);
     };
   }  // namespace iwp
 }  // namespace llarp
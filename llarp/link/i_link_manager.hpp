@@ -26,10 +26,12 @@ namespace llarp
     virtual IOutboundSessionMaker*
     GetSessionMaker() const = 0;
 
+    /// send an encoded link message to remote, the buffer is shared with the session that
+    /// fragments it rather than copied
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
+        ILinkSession::Message_t msg,
         ILinkSession::CompletionHandler completed,
         uint16_t priority = 0) = 0;
 
@@ -0,0 +1,62 @@
+#include "pump_timers.hpp"
+
+#include <llarp/ev/ev.hpp>
+
+namespace llarp
+{
+  SessionPumpTimers::SessionPumpTimers(std::function<void(llarp_time_t)> onDue)
+      : m_OnDue{std::move(onDue)}
+  {}
+
+  void
+  SessionPumpTimers::Start(std::shared_ptr<EventLoop> loop)
+  {
+    m_Loop = std::move(loop);
+    m_Keepalive = std::make_shared<int>(0);
+    m_ArmedAt.reset();
+    if (const auto next = m_Wheel.NextDue())
+      Arm(*next, m_Loop->time_now());
+  }
+
+  void
+  SessionPumpTimers::Stop()
+  {
+    m_Keepalive.reset();
+    m_ArmedAt.reset();
+  }
+
+  void
+  SessionPumpTimers::Schedule(
+      const std::shared_ptr<ILinkSession>& session, llarp_time_t when, llarp_time_t now)
+  {
+    auto [itr, inserted] = m_DueAt.try_emplace(session, when);
+    if (not inserted)
+    {
+      // the entry already on the wheel fires first, we get rescheduled from there
+      if (itr->second <= when)
+        return;
+      itr->second = when;
+    }
+    Arm(m_Wheel.Schedule(when, session), now);
+  }
+
+  void
+  SessionPumpTimers::Arm(llarp_time_t at, llarp_time_t now)
+  {
+    if (not m_Keepalive)
+      return;
+    if (m_ArmedAt and *m_ArmedAt <= at)
+      return;
+    m_ArmedAt = at;
+    m_Loop->call_later(
+        at > now ? at - now : 0ms, [this, alive = std::weak_ptr<int>{m_Keepalive}, at]() {
+          if (not alive.lock())
+            return;
+          // an earlier timer took over from this one
+          if (m_ArmedAt != at)
+            return;
+          m_ArmedAt.reset();
+          m_OnDue(m_Loop->time_now());
+        });
+  }
+}  // namespace llarp
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <llarp/util/time.hpp>
+#include <llarp/util/timer_wheel.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+
+namespace llarp
+{
+  class EventLoop;
+  struct ILinkSession;
+
+  /// pumps link sessions by the time they ask for, see ILinkSession::NextPumpAt.
+  ///
+  /// due times go on a timer wheel finer than the shortest rto and a one shot timer on the event
+  /// loop goes off for the earliest of them, so retransmissions and paced sends go out when they
+  /// are due rather than on the next link layer tick.  not thread safe, lives on the event loop.
+  class SessionPumpTimers
+  {
+   public:
+    /// how late past its due time a session may be pumped
+    static constexpr auto Resolution = 5ms;
+
+    /// onDue is called on the event loop when sessions are due and should call Advance
+    explicit SessionPumpTimers(std::function<void(llarp_time_t)> onDue);
+
+    /// arm timers on loop from now on
+    void
+    Start(std::shared_ptr<EventLoop> loop);
+
+    /// stop arming timers, the ones already armed do nothing when they go off
+    void
+    Stop();
+
+    /// make sure session is pumped by when
+    void
+    Schedule(const std::shared_ptr<ILinkSession>& session, llarp_time_t when, llarp_time_t now);
+
+    /// call visit(session) on every session due at now
+    template <typename Visit_t>
+    void
+    Advance(llarp_time_t now, Visit_t&& visit)
+    {
+      m_Wheel.Advance(now, [this, &visit](auto when, auto weak) {
+        auto itr = m_DueAt.find(weak);
+        // stale entry, the session went back on the wheel since this one was scheduled
+        if (itr == m_DueAt.end() or itr->second != when)
+          return;
+        m_DueAt.erase(itr);
+        if (auto session = weak.lock())
+          visit(session);
+      });
+      // whatever visit did not put back on the wheel still needs a timer
+      if (const auto next = m_Wheel.NextDue())
+        Arm(*next, now);
+    }
+
+    /// how many sessions are waiting on a pump
+    size_t
+    Size() const
+    {
+      return m_DueAt.size();
+    }
+
+   private:
+    /// make sure a timer goes off by at
+    void
+    Arm(llarp_time_t at, llarp_time_t now);
+
+    std::function<void(llarp_time_t)> m_OnDue;
+    std::shared_ptr<EventLoop> m_Loop;
+    /// armed timers only go off while this lives
+    std::shared_ptr<int> m_Keepalive;
+    /// when the earliest armed timer goes off
+    std::optional<llarp_time_t> m_ArmedAt;
+
+    util::TimerWheel<std::weak_ptr<ILinkSession>> m_Wheel{Resolution};
+    /// the earliest time each session is on the timer wheel for, later entries are stale
+    std::map<std::weak_ptr<ILinkSession>, llarp_time_t, std::owner_less<>> m_DueAt;
+  };
+}  // namespace llarp
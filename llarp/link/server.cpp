@@ -38,6 +38,7 @@ namespace llarp
       , QueueWork(std::move(work))
       , m_RouterEncSecret(keyManager->encryptionKey)
       , m_SecretKey(keyManager->transportKey)
+      , m_PumpTimers{[this](llarp_time_t now) { PumpDue(now); }}
   {}
 
   llarp_time_t
@@ -137,15 +138,17 @@ namespace llarp
     m_ourAddr = bind_addr;
     m_Router = router;
     m_udp = m_Router->loop()->make_udp(
-        [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, llarp_buffer_t buf) {
-          ILinkSession::Packet_t pkt;
-          pkt.resize(buf.sz);
-          std::copy_n(buf.base, buf.sz, pkt.data());
+        [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, PacketBuffer pkt) {
           RecvFrom(from, std::move(pkt));
         });
 
     if (m_udp->listen(m_ourAddr))
+    {
+      // sessions probe for the path mtu, which only works if nothing fragments the probes
+      if (not m_udp->set_dont_fragment())
+        LogInfo(Name(), " cannot set don't fragment on its udp socket, path mtu probes may lie");
       return;
+    }
 
     throw std::runtime_error{
         fmt::format("failed to listen {} udp socket on {}", Name(), m_ourAddr)};
@@ -154,53 +157,99 @@ namespace llarp
   void
   ILinkLayer::Pump()
   {
-    std::unordered_set<RouterID> closedSessions;
-    std::vector<std::shared_ptr<ILinkSession>> closedPending;
-    auto _now = Now();
+    {
+      std::lock_guard lock{m_DirtyMutex};
+      m_Pumping.swap(m_Dirty);
+    }
+    ClosedSessions closed;
+    const auto now = Now();
+    for (const auto& weak : m_Pumping)
+    {
+      if (auto session = weak.lock())
+        PumpSession(session, now, closed);
+    }
+    m_Pumping.clear();
+    HandleClosed(closed);
+  }
+
+  void
+  ILinkLayer::MarkDirty(std::weak_ptr<ILinkSession> session)
+  {
+    std::lock_guard lock{m_DirtyMutex};
+    m_Dirty.emplace_back(std::move(session));
+  }
+
+  void
+  ILinkLayer::PumpSession(
+      const std::shared_ptr<ILinkSession>& session, llarp_time_t now, ClosedSessions& closed)
+  {
+    // sessions we no longer track still get pumped so they can flush what they have queued, but
+    // they do not time out or get rescheduled
+    bool tracked = false;
     {
       Lock_t l(m_AuthedLinksMutex);
-      auto itr = m_AuthedLinks.begin();
-      while (itr != m_AuthedLinks.end())
+      const RouterID pk{session->GetPubKey()};
+      for (auto [itr, end] = m_AuthedLinks.equal_range(pk); itr != end; ++itr)
       {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
+        if (itr->second != session)
+          continue;
+        if (session->TimedOut(now))
         {
-          llarp::LogInfo("session to ", RouterID(itr->second->GetPubKey()), " timed out");
-          itr->second->Close();
-          closedSessions.emplace(itr->first);
-          UnmapAddr(itr->second->GetRemoteEndpoint());
-          itr = m_AuthedLinks.erase(itr);
+          llarp::LogInfo("session to ", pk, " timed out");
+          session->Close();
+          closed.authed.emplace(pk);
+          UnmapAddr(session->GetRemoteEndpoint());
+          m_AuthedLinks.erase(itr);
+          return;
         }
+        tracked = true;
+        break;
       }
     }
+    if (not tracked)
     {
       Lock_t l(m_PendingMutex);
-
-      auto itr = m_Pending.begin();
-      while (itr != m_Pending.end())
+      const auto addr = session->GetRemoteEndpoint();
+      if (auto itr = m_Pending.find(addr); itr != m_Pending.end() and itr->second == session)
       {
-        if (not itr->second->TimedOut(_now))
-        {
-          itr->second->Pump();
-          ++itr;
-        }
-        else
+        if (session->TimedOut(now))
         {
-          LogInfo("pending session at ", itr->first, " timed out");
-          UnmapAddr(itr->second->GetRemoteEndpoint());
+          LogInfo("pending session at ", addr, " timed out");
+          UnmapAddr(addr);
           // defer call so we can acquire mutexes later
-          closedPending.emplace_back(std::move(itr->second));
-          itr = m_Pending.erase(itr);
+          closed.pending.emplace_back(session);
+          m_Pending.erase(itr);
+          return;
         }
+        tracked = true;
       }
     }
+    session->Pump();
+    if (tracked)
+      SchedulePump(session, now);
+  }
+
+  void
+  ILinkLayer::SchedulePump(const std::shared_ptr<ILinkSession>& session, llarp_time_t now)
+  {
+    m_PumpTimers.Schedule(session, std::max(session->NextPumpAt(now), now), now);
+  }
+
+  void
+  ILinkLayer::PumpDue(llarp_time_t now)
+  {
+    ClosedSessions closed;
+    m_PumpTimers.Advance(
+        now, [this, now, &closed](const auto& session) { PumpSession(session, now, closed); });
+    HandleClosed(closed);
+  }
+
+  void
+  ILinkLayer::HandleClosed(const ClosedSessions& closed)
+  {
     {
       Lock_t l(m_AuthedLinksMutex);
-      for (const auto& r : closedSessions)
+      for (const auto& r : closed.authed)
       {
         if (m_AuthedLinks.count(r) == 0)
         {
@@ -208,7 +257,7 @@ namespace llarp
         }
       }
     }
-    for (const auto& pending : closedPending)
+    for (const auto& pending : closed.pending)
     {
       if (pending->IsInbound())
         continue;
@@ -283,11 +332,19 @@ namespace llarp
           [](const auto& item) -> util::StatusObject { return item.second->ExtractStatus(); });
     }
 
+    const auto pool = PacketPool::GlobalStats();
+
     return {
         {"name", Name()},
         {"rank", uint64_t(Rank())},
         {"addr", m_ourAddr.ToString()},
-        {"sessions", util::StatusObject{{"pending", pending}, {"established", established}}}};
+        {"sessions", util::StatusObject{{"pending", pending}, {"established", established}}},
+        {"packetPool",
+         util::StatusObject{
+             {"hits", pool.hits},
+             {"misses", pool.misses},
+             {"oversized", pool.oversized},
+             {"outstanding", pool.outstanding}}}};
   }
 
   bool
@@ -341,12 +398,16 @@ namespace llarp
     m_repeater_keepalive = std::make_shared<int>(0);
     m_Router->loop()->call_every(
         LINK_LAYER_TICK_INTERVAL, m_repeater_keepalive, [this] { Tick(Now()); });
+    m_PumpTimers.Start(m_Router->loop());
     return true;
   }
 
   void
   ILinkLayer::Tick(const llarp_time_t now)
   {
+    // the pump timers go off on their own, this is only a backstop for them
+    PumpDue(now);
+
     {
       Lock_t l(m_AuthedLinksMutex);
       for (const auto& [routerid, link] : m_AuthedLinks)
@@ -376,6 +437,7 @@ namespace llarp
   ILinkLayer::Stop()
   {
     m_repeater_keepalive.reset();  // make the repeater kill itself
+    m_PumpTimers.Stop();
     {
       Lock_t l(m_AuthedLinksMutex);
       for (const auto& [router, link] : m_AuthedLinks)
@@ -431,7 +493,7 @@ namespace llarp
   bool
   ILinkLayer::SendTo(
       const RouterID& remote,
-      const llarp_buffer_t& buf,
+      ILinkSession::Message_t msg,
       ILinkSession::CompletionHandler completed,
       uint16_t priority)
   {
@@ -450,9 +512,7 @@ namespace llarp
         }
       }
     }
-    ILinkSession::Message_t pkt(buf.sz);
-    std::copy_n(buf.base, buf.sz, pkt.begin());
-    return s && s->SendMessageBuffer(std::move(pkt), completed, priority);
+    return s && s->SendMessageBuffer(std::move(msg), completed, priority);
   }
 
   bool
@@ -485,6 +545,7 @@ namespace llarp
     if (m_Pending.count(address))
       return false;
     m_Pending.emplace(address, s);
+    MarkDirty(s);
     return true;
   }
 
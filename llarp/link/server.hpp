@@ -2,6 +2,7 @@
 
 #include <llarp/crypto/types.hpp>
 #include <llarp/ev/ev.hpp>
+#include "pump_timers.hpp"
 #include "session.hpp"
 #include <llarp/net/sock_addr.hpp>
 #include <llarp/router_contact.hpp>
@@ -11,7 +12,9 @@
 
 #include <list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace llarp
 {
@@ -117,11 +120,16 @@ namespace llarp
     std::shared_ptr<ILinkSession>
     FindSessionByPubkey(RouterID pk);
 
+    /// pump every session that marked itself dirty since the last pump
     virtual void
     Pump();
 
+    /// mark a session as having work to do on the next Pump(), can be called from any thread
+    void
+    MarkDirty(std::weak_ptr<ILinkSession> session);
+
     virtual void
-    RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
+    RecvFrom(const SockAddr& from, ILinkSession::RXPacket_t pkt) = 0;
 
     bool
     PickAddress(const RouterContact& rc, AddressInfo& picked) const;
@@ -150,7 +158,7 @@ namespace llarp
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
+        ILinkSession::Message_t msg,
         ILinkSession::CompletionHandler completed,
         uint16_t priority);
 
@@ -256,6 +264,30 @@ namespace llarp
     bool
     PutSession(const std::shared_ptr<ILinkSession>& s);
 
+    /// sessions that timed out during a pump, handled once we are done pumping
+    struct ClosedSessions
+    {
+      std::unordered_set<RouterID> authed;
+      std::vector<std::shared_ptr<ILinkSession>> pending;
+    };
+
+    /// pump a single session, dropping it if it timed out
+    void
+    PumpSession(
+        const std::shared_ptr<ILinkSession>& session, llarp_time_t now, ClosedSessions& closed)
+        EXCLUDES(m_AuthedLinksMutex, m_PendingMutex);
+
+    /// make sure a session gets pumped again by the time it asks for
+    void
+    SchedulePump(const std::shared_ptr<ILinkSession>& session, llarp_time_t now);
+
+    /// pump the sessions whose pump timers are due
+    void
+    PumpDue(llarp_time_t now);
+
+    void
+    HandleClosed(const ClosedSessions& closed) EXCLUDES(m_AuthedLinksMutex);
+
     AbstractRouter* m_Router;
     SockAddr m_ourAddr;
     std::shared_ptr<llarp::UDPHandle> m_udp;
@@ -272,6 +304,14 @@ namespace llarp
 
    private:
     std::shared_ptr<int> m_repeater_keepalive;
+
+    std::mutex m_DirtyMutex;
+    /// sessions to visit on the next pump
+    std::vector<std::weak_ptr<ILinkSession>> m_Dirty;
+    /// the batch of dirty sessions being pumped right now, kept around to reuse its allocation
+    std::vector<std::weak_ptr<ILinkSession>> m_Pumping;
+    /// sessions that need a pump at some later time even if they never get dirty
+    SessionPumpTimers m_PumpTimers;
   };
 
   using LinkLayer_ptr = std::shared_ptr<ILinkLayer>;
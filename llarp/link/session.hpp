@@ -4,6 +4,7 @@
 #include <llarp/net/net.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/router_contact.hpp>
+#include <llarp/util/packet_pool.hpp>
 #include <llarp/util/types.hpp>
 
 #include <functional>
@@ -25,6 +26,15 @@ namespace llarp
     uint64_t totalAckedTX = 0;
     uint64_t totalDroppedTX = 0;
     uint64_t totalInFlightTX = 0;
+
+    // fragments sent, and the ones of those we gave up on and had to send again
+    uint64_t totalFragmentsTX = 0;
+    uint64_t totalRetransmitsTX = 0;
+
+    // congestion control as of when the stats were taken
+    uint64_t congestionWindow = 0;
+    llarp_time_t smoothedRTT = 0s;
+    llarp_time_t rttVariance = 0s;
   };
 
   struct ILinkSession
@@ -53,7 +63,11 @@ namespace llarp
     using CompletionHandler = std::function<void(DeliveryStatus)>;
 
     using Packet_t = std::vector<byte_t>;
-    using Message_t = std::vector<byte_t>;
+    /// packets we receive from the wire, backed by the packet pool
+    using RXPacket_t = PacketBuffer;
+    /// link messages we send, encoded once into a pooled buffer that is shared with whatever
+    /// fragments them
+    using Message_t = PacketBuffer;
 
     /// send a message buffer to the remote endpoint
     virtual bool
@@ -69,7 +83,7 @@ namespace llarp
     /// recv packet on low layer
     /// not used by utp
     virtual bool
-    Recv_LL(Packet_t)
+    Recv_LL(RXPacket_t)
     {
       return true;
     }
@@ -125,6 +139,11 @@ namespace llarp
     virtual bool
     ShouldPing() const = 0;
 
+    /// the latest time we must be pumped again even if no new work shows up, this covers
+    /// keepalives, retransmissions and timing out
+    virtual llarp_time_t
+    NextPumpAt(llarp_time_t now) const = 0;
+
     /// return the current stats for this session
     virtual SessionStats
     GetSessionStats() const = 0;
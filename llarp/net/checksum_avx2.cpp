@@ -0,0 +1,45 @@
+#include "checksum_batch.hpp"
+
+#include <immintrin.h>
+
+// This file is only compiled (with -mavx2) when the compiler supports avx2; RewriteAddresses
+// checks that the cpu we run on does before calling into it.
+
+namespace llarp::net
+{
+  namespace
+  {
+    /// per lane, the one's complement sum of the two 16 bit halves of old and of ~now
+    inline __m256i
+    lane_deltas(const uint32_t* old, const uint32_t* now)
+    {
+      const auto mask = _mm256_set1_epi32(0xFFff);
+      const auto o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(old));
+      const auto n = _mm256_xor_si256(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(now)), _mm256_set1_epi32(-1));
+      return _mm256_add_epi32(
+          _mm256_add_epi32(_mm256_and_si256(o, mask), _mm256_srli_epi32(o, 16)),
+          _mm256_add_epi32(_mm256_and_si256(n, mask), _mm256_srli_epi32(n, 16)));
+    }
+  }  // namespace
+
+  void
+  address_deltas_avx2(const uint32_t* old, const uint32_t* now, uint32_t* out, size_t num)
+  {
+    static_assert(AddressLanes == 8, "one packet per 256 bit vector");
+    for (; num >= 4; num -= 4, old += 4 * AddressLanes, now += 4 * AddressLanes, out += 4)
+    {
+      const auto d0 = lane_deltas(old, now);
+      const auto d1 = lane_deltas(old + AddressLanes, now + AddressLanes);
+      const auto d2 = lane_deltas(old + 2 * AddressLanes, now + 2 * AddressLanes);
+      const auto d3 = lane_deltas(old + 3 * AddressLanes, now + 3 * AddressLanes);
+      // each 128 bit half ends up holding the sums of its own lanes for all 4 packets in order
+      const auto h = _mm256_hadd_epi32(_mm256_hadd_epi32(d0, d1), _mm256_hadd_epi32(d2, d3));
+      const auto sums =
+          _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), sums);
+    }
+    if (num)
+      address_deltas(old, now, out, num);
+  }
+}  // namespace llarp::net
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp::net
+{
+  /// 32 bit address words we keep per packet when working out checksum changes for many packets
+  /// at once, enough for an ipv6 source and destination.  v4 packets only use the first two, the
+  /// rest have to be 0 in old and all ones in now so they add nothing.
+  static constexpr size_t AddressLanes = 8;
+
+  /// for each of num packets, how much its checksums move by when its addresses change from old to
+  /// now, as a sum still to be folded.  old and now hold AddressLanes words per packet.
+  void
+  address_deltas(const uint32_t* old, const uint32_t* now, uint32_t* out, size_t num);
+
+  /// the same as address_deltas using avx2, 4 packets to a step.  only built when the compiler
+  /// supports avx2 and only to be called when the cpu does.
+  void
+  address_deltas_avx2(const uint32_t* old, const uint32_t* now, uint32_t* out, size_t num);
+}  // namespace llarp::net
@@ -1,4 +1,5 @@
 #include "ip_packet.hpp"
+#include "checksum_batch.hpp"
 #include "ip.hpp"
 #include <llarp/constants/net.hpp>
 #include <llarp/util/buffer.hpp>
@@ -11,8 +12,14 @@
 #include <oxenc/endian.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <map>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace llarp::net
 {
   constexpr uint32_t ipv6_flowlabel_mask = 0b0000'0000'0000'1111'1111'1111'1111'1111;
@@ -89,22 +96,65 @@ namespace llarp::net
     return ExpandV4(dstv4());
   }
 
+  static std::atomic<uint64_t> packet_copies{0};
+
+  PacketBuffer
+  IPPacket::AcquireBuffer()
+  {
+    return PacketPool::Local().Acquire(MaxSize, Headroom);
+  }
+
+  uint64_t
+  IPPacket::Copies()
+  {
+    return packet_copies.load();
+  }
+
   IPPacket::IPPacket(byte_view_t view)
   {
     if (view.size() < MinSize)
-    {
-      _buf.resize(0);
       return;
-    }
-    _buf.resize(view.size());
-    std::copy_n(view.data(), size(), data());
+    packet_copies++;
+    _buf = PacketPool::Local().Copy(view.data(), view.size(), Headroom);
   }
 
   IPPacket::IPPacket(size_t sz)
   {
     if (sz and sz < MinSize)
       throw std::invalid_argument{"buffer size is too small to hold an ip packet"};
-    _buf.resize(sz);
+    if (sz == 0)
+      return;
+    _buf = PacketPool::Local().Acquire(sz, Headroom);
+    std::fill_n(_buf.data(), sz, 0);
+  }
+
+  IPPacket::IPPacket(PacketBuffer buf)
+  {
+    if (buf.size() >= MinSize)
+      _buf = std::move(buf);
+  }
+
+  IPPacket::IPPacket(const IPPacket& other) : timestamp{other.timestamp}, reply{other.reply}
+  {
+    if (not other.empty())
+    {
+      packet_copies++;
+      _buf = PacketPool::Local().Copy(other.data(), other.size(), Headroom);
+    }
+  }
+
+  IPPacket&
+  IPPacket::operator=(const IPPacket& other)
+  {
+    if (this != &other)
+      *this = IPPacket{other};
+    return *this;
+  }
+
+  std::vector<byte_t>
+  IPPacket::steal()
+  {
+    return _buf.take();
   }
 
   SockAddr
@@ -128,10 +178,10 @@ namespace llarp::net
       return SockAddr{ToNet(dstv6()), port};
   }
 
-  IPPacket::IPPacket(std::vector<byte_t>&& stolen) : _buf{stolen}
+  IPPacket::IPPacket(std::vector<byte_t>&& stolen)
   {
-    if (size() < MinSize)
-      _buf.resize(0);
+    if (stolen.size() >= MinSize)
+      _buf = PacketPool::Adopt(std::move(stolen));
   }
 
   byte_view_t
@@ -167,6 +217,52 @@ namespace llarp::net
     }
   }
 
+  uint64_t
+  IPPacket::FlowHash() const
+  {
+    // fnv-1a over the parts of the headers that tell flows apart
+    uint64_t hash = 0xcbf29ce484222325UL;
+    const auto mix = [&hash](const byte_t* ptr, size_t sz) {
+      for (size_t idx = 0; idx < sz; ++idx)
+      {
+        hash ^= ptr[idx];
+        hash *= 0x100000001b3UL;
+      }
+    };
+
+    size_t l4 = 0;
+    uint8_t proto = 0;
+    if (IsV4() and size() >= MinSize)
+    {
+      // saddr and daddr sit next to each other at the end of the fixed header
+      mix(data() + 12, 8);
+      l4 = Header()->ihl * 4;
+      proto = Header()->protocol;
+    }
+    else if (IsV6() and size() >= sizeof(ipv6_header))
+    {
+      mix(data() + 8, 32);
+      l4 = sizeof(ipv6_header);
+      proto = HeaderV6()->protocol;
+    }
+    else
+      return hash;
+
+    mix(&proto, 1);
+    switch (IPProtocol{proto})
+    {
+      case IPProtocol::TCP:
+      case IPProtocol::UDP:
+        // both ports
+        if (size() >= l4 + 4)
+          mix(data() + l4, 4);
+        break;
+      default:
+        break;
+    }
+    return hash;
+  }
+
   huint32_t
   IPPacket::srcv4() const
   {
@@ -231,304 +327,330 @@ namespace llarp::net
 #define ADD32CS(x) ((uint32_t)(x & 0xFFff) + (uint32_t)(x >> 16))
 #define SUB32CS(x) ((uint32_t)((~x) & 0xFFff) + (uint32_t)((~x) >> 16))
 
-  static nuint16_t
-  deltaIPv4Checksum(
-      nuint16_t old_sum,
-      nuint32_t old_src_ip,
-      nuint32_t old_dst_ip,
-      nuint32_t new_src_ip,
-      nuint32_t new_dst_ip)
+  void
+  address_deltas(const uint32_t* old, const uint32_t* now, uint32_t* out, size_t num)
   {
-    uint32_t sum = uint32_t(old_sum.n) + ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n)
-        + SUB32CS(new_src_ip.n) + SUB32CS(new_dst_ip.n);
-
-    // only need to do it 2 times to be sure
-    // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-    sum = (sum & 0xFFff) + (sum >> 16);
-    sum += sum >> 16;
-
-    return nuint16_t{uint16_t(sum & 0xFFff)};
-  }
-
-  static nuint16_t
-  deltaIPv6Checksum(
-      nuint16_t old_sum,
-      const uint32_t old_src_ip[4],
-      const uint32_t old_dst_ip[4],
-      const uint32_t new_src_ip[4],
-      const uint32_t new_dst_ip[4])
-  {
-    /* we don't actually care in what way integers are arranged in memory
-     * internally */
-    /* as long as uint16 pairs are swapped in correct direction, result will
-     * be correct (assuming there are no gaps in structure) */
-    /* we represent 128bit stuff there as 4 32bit ints, that should be more or
-     * less correct */
-    /* we could do 64bit ints too but then we couldn't reuse 32bit macros and
-     * that'd suck for 32bit cpus */
-#define ADDN128CS(x) (ADD32CS(x[0]) + ADD32CS(x[1]) + ADD32CS(x[2]) + ADD32CS(x[3]))
-#define SUBN128CS(x) (SUB32CS(x[0]) + SUB32CS(x[1]) + SUB32CS(x[2]) + SUB32CS(x[3]))
-    uint32_t sum = uint32_t(old_sum.n) + ADDN128CS(old_src_ip) + ADDN128CS(old_dst_ip)
-        + SUBN128CS(new_src_ip) + SUBN128CS(new_dst_ip);
-#undef ADDN128CS
-#undef SUBN128CS
-
-    // only need to do it 2 times to be sure
-    // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-    sum = (sum & 0xFFff) + (sum >> 16);
-    sum += sum >> 16;
-
-    return nuint16_t{uint16_t(sum & 0xFFff)};
-  }
-
-#undef ADD32CS
-#undef SUB32CS
-
-  static void
-  deltaChecksumIPv4TCP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      size_t chksumoff,
-      nuint32_t oSrcIP,
-      nuint32_t oDstIP,
-      nuint32_t nSrcIP,
-      nuint32_t nDstIP)
-  {
-    if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
-      return;
-
-    auto check = (nuint16_t*)(pld + chksumoff - fragoff);
-
-    *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // usually, TCP checksum field cannot be 0xFFff,
-    // because one's complement addition cannot result in 0x0000,
-    // and there's inversion in the end;
-    // emulate that.
-    if (check->n == 0xFFff)
-      check->n = 0x0000;
-  }
-
-  static void
-  deltaChecksumIPv6TCP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      size_t chksumoff,
-      const uint32_t oSrcIP[4],
-      const uint32_t oDstIP[4],
-      const uint32_t nSrcIP[4],
-      const uint32_t nDstIP[4])
-  {
-    if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
-      return;
-
-    auto check = (nuint16_t*)(pld + chksumoff - fragoff);
-
-    *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // usually, TCP checksum field cannot be 0xFFff,
-    // because one's complement addition cannot result in 0x0000,
-    // and there's inversion in the end;
-    // emulate that.
-    if (check->n == 0xFFff)
-      check->n = 0x0000;
+    for (; num > 0; --num, old += AddressLanes, now += AddressLanes, ++out)
+    {
+#ifdef __SSE2__
+      const auto mask = _mm_set1_epi32(0xFFff);
+      const auto ones = _mm_set1_epi32(-1);
+      auto sum = _mm_setzero_si128();
+      for (size_t idx = 0; idx < AddressLanes; idx += 4)
+      {
+        const auto o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(old + idx));
+        const auto n =
+            _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(now + idx)), ones);
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_and_si128(o, mask), _mm_srli_epi32(o, 16)));
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_and_si128(n, mask), _mm_srli_epi32(n, 16)));
+      }
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+      sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+      *out = _mm_cvtsi128_si32(sum);
+#else
+      uint32_t sum = 0;
+      for (size_t idx = 0; idx < AddressLanes; ++idx)
+        sum += ADD32CS(old[idx]) + SUB32CS(now[idx]);
+      *out = sum;
+#endif
+    }
   }
 
-  static void
-  deltaChecksumIPv4UDP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      nuint32_t oSrcIP,
-      nuint32_t oDstIP,
-      nuint32_t nSrcIP,
-      nuint32_t nDstIP)
+  namespace
   {
-    if (fragoff > 6 || psz < 6 + 2)
-      return;
-
-    auto check = (nuint16_t*)(pld + 6);
-    if (check->n == 0x0000)
-      return;  // 0 is used to indicate "no checksum", don't change
-
-    *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // 0 is used to indicate "no checksum"
-    // 0xFFff and 0 are equivalent in one's complement math
-    // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
-    // infact it's impossible to get 0 with such addition,
-    // when starting from non-0 value.
-    // inside deltachksum we don't invert so it's safe to skip check there
-    // if(check->n == 0x0000)
-    //   check->n = 0xFFff;
-  }
-
-  static void
-  deltaChecksumIPv6UDP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      const uint32_t oSrcIP[4],
-      const uint32_t oDstIP[4],
-      const uint32_t nSrcIP[4],
-      const uint32_t nDstIP[4])
-  {
-    if (fragoff > 6 || psz < 6 + 2)
-      return;
+    /// how much a packet's checksums move by when n address words change from old to now, as a
+    /// sum still to be folded
+    uint32_t
+    AddressDelta(const uint32_t* old, const uint32_t* now, size_t n)
+    {
+      /* we don't actually care in what way integers are arranged in memory
+       * internally */
+      /* as long as uint16 pairs are swapped in correct direction, result will
+       * be correct (assuming there are no gaps in structure) */
+      uint32_t sum = 0;
+      for (size_t idx = 0; idx < n; ++idx)
+        sum += ADD32CS(old[idx]) + SUB32CS(now[idx]);
+      return sum;
+    }
 
-    auto check = (nuint16_t*)(pld + 6);
-    // 0 is used to indicate "no checksum", don't change
-    // even tho this shouldn't happen for IPv6, handle it properly
-    // we actually should drop/log 0-checksum packets per spec
-    // but that should be done at upper level than this function
-    // it's better to do correct thing there regardless
-    // XXX or maybe we should change this function to be able to return error?
-    // either way that's not a priority
-    if (check->n == 0x0000)
-      return;
+    void
+    AddressDeltas(const uint32_t* old, const uint32_t* now, uint32_t* out, size_t num)
+    {
+#ifdef LOKINET_CHECKSUM_AVX2
+      static const bool avx2 = __builtin_cpu_supports("avx2");
+      if (avx2)
+      {
+        address_deltas_avx2(old, now, out, num);
+        return;
+      }
+#endif
+      address_deltas(old, now, out, num);
+    }
 
-    *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // 0 is used to indicate "no checksum"
-    // 0xFFff and 0 are equivalent in one's complement math
-    // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
-    // infact it's impossible to get 0 with such addition,
-    // when starting from non-0 value.
-    // inside deltachksum we don't invert so it's safe to skip check there
-    // if(check->n == 0x0000)
-    //   check->n = 0xFFff;
-  }
+    nuint16_t
+    ApplyDelta(nuint16_t old_sum, uint32_t delta)
+    {
+      uint32_t sum = uint32_t(old_sum.n) + delta;
 
-  void
-  IPPacket::UpdateIPv4Address(nuint32_t nSrcIP, nuint32_t nDstIP)
-  {
-    llarp::LogDebug("set src=", nSrcIP, " dst=", nDstIP);
+      // only need to do it 2 times to be sure
+      // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
 
-    auto hdr = Header();
+      return nuint16_t{uint16_t(sum & 0xFFff)};
+    }
 
-    auto oSrcIP = nuint32_t{hdr->saddr};
-    auto oDstIP = nuint32_t{hdr->daddr};
-    auto* buf = data();
-    auto sz = size();
-    // L4 checksum
-    auto ihs = size_t(hdr->ihl * 4);
-    if (ihs <= sz)
+    /// where a packet's checksums sit, found before its addresses change
+    struct ChecksumSites
     {
-      auto pld = buf + ihs;
-      auto psz = sz - ihs;
-
-      auto fragoff = size_t((ntohs(hdr->frag_off) & 0x1Fff) * 8);
+      /// the v4 header, its checksum is fixed and its new addresses are written in last as a bogus
+      /// ihl can put the l4 checksum on top of them
+      ip_header* v4{nullptr};
+      /// the l4 checksum, if the packet has one we know of in this fragment
+      nuint16_t* l4{nullptr};
+      /// udp uses a checksum of 0 for none, the others can never be 0xFFff
+      bool udp{false};
+    };
 
-      switch (hdr->protocol)
+    /// find the l4 checksum of a proto packet whose payload pld starts fragoff bytes in
+    void
+    FindL4Checksum(ChecksumSites& sites, uint8_t proto, byte_t* pld, size_t psz, size_t fragoff)
+    {
+      size_t chksumoff;
+      switch (proto)
       {
         case 6:  // TCP
-          deltaChecksumIPv4TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          chksumoff = 16;
           break;
         case 17:   // UDP
         case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-          deltaChecksumIPv4UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
-          break;
+          if (fragoff > 6 || psz < 6 + 2)
+            return;
+          sites.l4 = (nuint16_t*)(pld + 6);
+          sites.udp = true;
+          return;
         case 33:  // DCCP
-          deltaChecksumIPv4TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          chksumoff = 6;
           break;
+        default:
+          return;
       }
+      if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
+        return;
+      sites.l4 = (nuint16_t*)(pld + chksumoff - fragoff);
     }
 
-    // IPv4 checksum
-    auto v4chk = (nuint16_t*)&(hdr->check);
-    *v4chk = deltaIPv4Checksum(*v4chk, oSrcIP, oDstIP, nSrcIP, nDstIP);
+    /// take the addresses of v4 pkt into old and src and dst into now, and find its checksums
+    ChecksumSites
+    PrepareV4(IPPacket& pkt, nuint32_t nSrcIP, nuint32_t nDstIP, uint32_t* old, uint32_t* now)
+    {
+      ChecksumSites sites;
+      auto hdr = sites.v4 = pkt.Header();
+      old[0] = hdr->saddr;
+      old[1] = hdr->daddr;
+      now[0] = nSrcIP.n;
+      now[1] = nDstIP.n;
+
+      auto* buf = pkt.data();
+      auto sz = pkt.size();
+      auto ihs = size_t(hdr->ihl * 4);
+      if (ihs <= sz)
+      {
+        auto fragoff = size_t((ntohs(hdr->frag_off) & 0x1Fff) * 8);
+        FindL4Checksum(sites, hdr->protocol, buf + ihs, sz - ihs, fragoff);
+      }
+      return sites;
+    }
+
+    /// take the addresses of v6 pkt into old, put src and dst in their place and into now, and
+    /// find its checksums.  nullopt if pkt is too short to touch.
+    std::optional<ChecksumSites>
+    PrepareV6(IPPacket& pkt, huint128_t src, huint128_t dst, uint32_t* old, uint32_t* now)
+    {
+      const size_t ihs = 4 + 4 + 16 + 16;
+      const auto sz = pkt.size();
+      // XXX should've been checked at upper level?
+      if (sz <= ihs)
+        return std::nullopt;
+
+      auto hdr = pkt.HeaderV6();
+      std::copy_n(in6_uint32_ptr(hdr->srcaddr), 4, old);
+      std::copy_n(in6_uint32_ptr(hdr->dstaddr), 4, old + 4);
+
+      // IPv6 address
+      hdr->srcaddr = HUIntToIn6(src);
+      hdr->dstaddr = HUIntToIn6(dst);
+      std::copy_n(in6_uint32_ptr(hdr->srcaddr), 4, now);
+      std::copy_n(in6_uint32_ptr(hdr->dstaddr), 4, now + 4);
+
+      ChecksumSites sites;
+      // TODO IPv6 header options
+      auto* pld = pkt.data() + ihs;
+      auto psz = sz - ihs;
+
+      size_t fragoff = 0;
+      auto nextproto = hdr->protocol;
+      for (;;)
+      {
+        switch (nextproto)
+        {
+          case 0:   // Hop-by-Hop Options
+          case 43:  // Routing Header
+          case 60:  // Destination Options
+          {
+            nextproto = pld[0];
+            auto addlen = (size_t(pld[1]) + 1) * 8;
+            if (psz < addlen)
+              return sites;
+            pld += addlen;
+            psz -= addlen;
+            break;
+          }
+
+          case 44:  // Fragment Header
+            /*
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  Next Header  |   Reserved    |      Fragment Offset    |Res|M|
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                         Identification                        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+            */
+            nextproto = pld[0];
+            fragoff = (uint16_t(pld[2]) << 8) | (uint16_t(pld[3]) & 0xFC);
+            if (psz < 8)
+              return sites;
+            pld += 8;
+            psz -= 8;
+
+            // jump straight to payload processing
+            if (fragoff != 0)
+              goto endprotohdrs;
+            break;
+
+          default:
+            goto endprotohdrs;
+        }
+      }
+    endprotohdrs:
+      FindL4Checksum(sites, nextproto, pld, psz, fragoff);
+      return sites;
+    }
 
-    // write new IP addresses
-    hdr->saddr = nSrcIP.n;
-    hdr->daddr = nDstIP.n;
+    /// fix the checksums at sites, which the address change moved by delta, then write in the new
+    /// v4 addresses from now
+    void
+    FinishRewrite(const ChecksumSites& sites, uint32_t delta, const uint32_t* now)
+    {
+      if (auto check = sites.l4)
+      {
+        if (sites.udp)
+        {
+          // 0 is used to indicate "no checksum", don't change
+          // 0xFFff and 0 are equivalent in one's complement math
+          // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
+          // infact it's impossible to get 0 with such addition,
+          // when starting from non-0 value.
+          if (check->n != 0x0000)
+            *check = ApplyDelta(*check, delta);
+        }
+        else
+        {
+          *check = ApplyDelta(*check, delta);
+          // usually, TCP checksum field cannot be 0xFFff,
+          // because one's complement addition cannot result in 0x0000,
+          // and there's inversion in the end;
+          // emulate that.
+          if (check->n == 0xFFff)
+            check->n = 0x0000;
+        }
+      }
+
+      if (auto hdr = sites.v4)
+      {
+        // IPv4 checksum
+        auto v4chk = (nuint16_t*)&(hdr->check);
+        *v4chk = ApplyDelta(*v4chk, delta);
+
+        // write new IP addresses
+        hdr->saddr = now[0];
+        hdr->daddr = now[1];
+      }
+    }
+  }  // namespace
+
+#undef ADD32CS
+#undef SUB32CS
+
+  void
+  IPPacket::UpdateIPv4Address(nuint32_t nSrcIP, nuint32_t nDstIP)
+  {
+    llarp::LogDebug("set src=", nSrcIP, " dst=", nDstIP);
+
+    uint32_t old[2], now[2];
+    const auto sites = PrepareV4(*this, nSrcIP, nDstIP, old, now);
+    FinishRewrite(sites, AddressDelta(old, now, 2), now);
   }
 
   void
   IPPacket::UpdateIPv6Address(huint128_t src, huint128_t dst, std::optional<nuint32_t> flowlabel)
   {
-    const size_t ihs = 4 + 4 + 16 + 16;
-    const auto sz = size();
-    // XXX should've been checked at upper level?
-    if (sz <= ihs)
+    uint32_t old[4 + 4], now[4 + 4];
+    const auto sites = PrepareV6(*this, src, dst, old, now);
+    if (not sites)
       return;
 
-    auto hdr = HeaderV6();
     if (flowlabel.has_value())
     {
       // set flow label if desired
-      hdr->FlowLabel(*flowlabel);
+      HeaderV6()->FlowLabel(*flowlabel);
     }
+    FinishRewrite(*sites, AddressDelta(old, now, 4 + 4), now);
+  }
 
-    const auto oldSrcIP = hdr->srcaddr;
-    const auto oldDstIP = hdr->dstaddr;
-    const uint32_t* oSrcIP = in6_uint32_ptr(oldSrcIP);
-    const uint32_t* oDstIP = in6_uint32_ptr(oldDstIP);
-
-    // IPv6 address
-    hdr->srcaddr = HUIntToIn6(src);
-    hdr->dstaddr = HUIntToIn6(dst);
-    const uint32_t* nSrcIP = in6_uint32_ptr(hdr->srcaddr);
-    const uint32_t* nDstIP = in6_uint32_ptr(hdr->dstaddr);
-
-    // TODO IPv6 header options
-    auto* pld = data() + ihs;
-    auto psz = sz - ihs;
+  void
+  RewriteAddresses(const AddressRewrite* rewrites, size_t num)
+  {
+    // address words and checksum sites for a chunk of packets, laid out for AddressDeltas
+    constexpr size_t Chunk = 64;
+    std::array<uint32_t, Chunk * AddressLanes> old;
+    std::array<uint32_t, Chunk * AddressLanes> now;
+    std::array<uint32_t, Chunk> deltas;
+    std::array<std::optional<ChecksumSites>, Chunk> sites;
 
-    size_t fragoff = 0;
-    auto nextproto = hdr->protocol;
-    for (;;)
+    while (num > 0)
     {
-      switch (nextproto)
+      const auto n = std::min(num, Chunk);
+      // unused lanes are 0 in old and all ones in now so they add nothing to the sums
+      std::fill_n(old.begin(), n * AddressLanes, 0);
+      std::fill_n(now.begin(), n * AddressLanes, ~uint32_t{0});
+      for (size_t idx = 0; idx < n; ++idx)
       {
-        case 0:   // Hop-by-Hop Options
-        case 43:  // Routing Header
-        case 60:  // Destination Options
-        {
-          nextproto = pld[0];
-          auto addlen = (size_t(pld[1]) + 1) * 8;
-          if (psz < addlen)
-            return;
-          pld += addlen;
-          psz -= addlen;
-          break;
-        }
-
-        case 44:  // Fragment Header
-          /*
- +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- |  Next Header  |   Reserved    |      Fragment Offset    |Res|M|
- +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- |                         Identification                        |
- +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-           */
-          nextproto = pld[0];
-          fragoff = (uint16_t(pld[2]) << 8) | (uint16_t(pld[3]) & 0xFC);
-          if (psz < 8)
-            return;
-          pld += 8;
-          psz -= 8;
+        auto& pkt = *rewrites[idx].pkt;
+        auto* o = old.data() + idx * AddressLanes;
+        auto* w = now.data() + idx * AddressLanes;
+        sites[idx].reset();
+        if (pkt.empty())
+          continue;
+        if (pkt.IsV4())
+          sites[idx] = PrepareV4(
+              pkt,
+              xhtonl(net::TruncateV6(rewrites[idx].src)),
+              xhtonl(net::TruncateV6(rewrites[idx].dst)),
+              o,
+              w);
+        else if (pkt.IsV6())
+          sites[idx] = PrepareV6(pkt, rewrites[idx].src, rewrites[idx].dst, o, w);
+      }
 
-          // jump straight to payload processing
-          if (fragoff != 0)
-            goto endprotohdrs;
-          break;
+      AddressDeltas(old.data(), now.data(), deltas.data(), n);
 
-        default:
-          goto endprotohdrs;
+      for (size_t idx = 0; idx < n; ++idx)
+      {
+        if (sites[idx])
+          FinishRewrite(*sites[idx], deltas[idx], now.data() + idx * AddressLanes);
       }
-    }
-  endprotohdrs:
-
-    switch (nextproto)
-    {
-      case 6:  // TCP
-        deltaChecksumIPv6TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
-        break;
-      case 17:   // UDP
-      case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-        deltaChecksumIPv6UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
-        break;
-      case 33:  // DCCP
-        deltaChecksumIPv6TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
-        break;
+      rewrites += n;
+      num -= n;
     }
   }
 
@@ -4,6 +4,7 @@
 #include <llarp/ev/ev.hpp>
 #include "net.hpp"
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/packet_pool.hpp>
 #include <llarp/util/time.hpp>
 #include <memory>
 #include <llarp/service/protocol_type.hpp>
@@ -112,27 +113,50 @@ namespace llarp::net
   IPProtocol
   ParseIPProtocol(std::string data);
 
-  /// an Packet
+  /// an ip packet, kept in a buffer from the calling thread's packet pool with some room left in
+  /// front of it, or in a vector it took over.  copying an IPPacket copies the bytes, moving it
+  /// moves the buffer.
   struct IPPacket
   {
     static constexpr size_t _max_size = 1500;
     llarp_time_t timestamp;
-    std::vector<byte_t> _buf;
+    PacketBuffer _buf;
 
    public:
-    IPPacket() : IPPacket{size_t{}}
-    {}
+    IPPacket() = default;
     /// create an ip packet buffer of all zeros of size sz
     explicit IPPacket(size_t sz);
-    /// create an ip packet from a view
+    /// create an ip packet from a copy of a view
     explicit IPPacket(byte_view_t);
-    /// create an ip packet from a vector we then own
+    /// create an ip packet that takes over a vector without copying it, the packet has no
+    /// headroom
     IPPacket(std::vector<byte_t>&&);
+    /// create an ip packet that takes over a buffer without copying it
+    explicit IPPacket(PacketBuffer buf);
+
+    IPPacket(const IPPacket& other);
+    IPPacket(IPPacket&& other) = default;
+
+    IPPacket&
+    operator=(const IPPacket& other);
+    IPPacket&
+    operator=(IPPacket&& other) = default;
 
     ~IPPacket() = default;
 
     static constexpr size_t MaxSize = _max_size;
     static constexpr size_t MinSize = 20;
+    /// bytes we leave free in front of every packet buffer we get from the pool, so a header can
+    /// be put in front of the packet without moving it
+    static constexpr size_t Headroom = 64;
+
+    /// get a pooled buffer fit for reading a packet of up to MaxSize bytes into
+    static PacketBuffer
+    AcquireBuffer();
+
+    /// how many times we had to copy packet bytes into a new buffer, over the whole process
+    static uint64_t
+    Copies();
 
     [[deprecated("deprecated because of llarp_buffer_t")]] static IPPacket
     UDP(nuint32_t srcaddr,
@@ -166,27 +190,26 @@ namespace llarp::net
     [[deprecated("deprecated because of llarp_buffer_t")]] inline bool
     Load(const llarp_buffer_t& buf)
     {
-      _buf = buf.copy();
-      if (size() >= MinSize)
-        return true;
-      _buf.resize(0);
-      return false;
+      *this = IPPacket{byte_view_t{buf.base, buf.sz}};
+      return not empty();
     }
 
     [[deprecated("deprecated because of llarp_buffer_t")]] inline llarp_buffer_t
     ConstBuffer() const
     {
-      return llarp_buffer_t{_buf};
+      return llarp_buffer_t{data(), size()};
     }
 
-    /// steal the underlying vector
-    inline std::vector<byte_t>
-    steal()
+    /// move the packet out into a vector, leaving us empty.  this only copies if the packet did
+    /// not come from a vector in the first place.
+    std::vector<byte_t>
+    steal();
+
+    /// take the underlying buffer, leaving us empty
+    inline PacketBuffer
+    steal_buffer()
     {
-      std::vector<byte_t> buf;
-      buf.resize(0);
-      std::swap(_buf, buf);
-      return buf;
+      return std::move(_buf);
     }
 
     inline byte_t*
@@ -340,6 +363,11 @@ namespace llarp::net
     std::optional<nuint16_t>
     SrcPort() const;
 
+    /// hash of the addresses, protocol and ports, the same for every packet of one flow in one
+    /// direction
+    uint64_t
+    FlowHash() const;
+
     /// get pointer and size of layer 4 data
     std::optional<std::pair<const char*, size_t>>
     L4Data() const;
@@ -374,6 +402,20 @@ namespace llarp::net
     std::function<void(net::IPPacket)> reply;
   };
 
+  /// a packet and the addresses RewriteAddresses gives it
+  struct AddressRewrite
+  {
+    IPPacket* pkt;
+    huint128_t src;
+    huint128_t dst;
+  };
+
+  /// give num packets new addresses, fixing up their checksums the same as UpdateIPv4Address and
+  /// UpdateIPv6Address would with v4 packets taking the v4 part of src and dst.  the checksum
+  /// changes for the whole batch are worked out together, with simd where we have it.
+  void
+  RewriteAddresses(const AddressRewrite* rewrites, size_t num);
+
   /// generate ip checksum
   uint16_t
   ipchksum(const byte_t* buf, size_t sz, uint32_t sum = 0);
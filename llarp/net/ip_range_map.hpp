@@ -1,8 +1,10 @@
 #pragma once
 
 #include "ip_range.hpp"
+#include "ip_range_trie.hpp"
 #include <llarp/util/status.hpp>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace llarp
@@ -12,7 +14,7 @@ namespace llarp
     /// a container that maps an ip range to a value that allows you to lookup
     /// key by range hit
     ///
-    /// in the future we should do some kind of magic shit to ensure near constant time for lookups
+    /// lookups by address go through a trie of the ranges, indexing into m_Entries
     template <typename Value_t>
     struct IPRangeMap
     {
@@ -41,12 +43,7 @@ namespace llarp
       bool
       ContainsValue(const Value_t& val) const
       {
-        for (const auto& entry : m_Entries)
-        {
-          if (entry.second == val)
-            return true;
-        }
-        return false;
+        return m_ValueCounts.count(val) != 0;
       }
 
       void
@@ -95,14 +92,24 @@ namespace llarp
       FindAllEntries(const IP_t& addr) const
       {
         std::set<Entry_t> found;
-        for (const auto& entry : m_Entries)
-        {
-          if (entry.first.Contains(addr))
-            found.insert(entry);
-        }
+        ForEachMatch(addr, [&found](const auto& range, const auto& value) {
+          found.emplace(range, value);
+        });
         return found;
       }
 
+      /// call visit(range, value) on every entry whose range contains this IP, without building a
+      /// set of them
+      template <typename Visit_t>
+      void
+      ForEachMatch(const IP_t& addr, Visit_t visit) const
+      {
+        m_Index.ForEachMatch(addr, [this, &visit](const auto&, size_t idx) {
+          const auto& [range, value] = m_Entries[idx];
+          visit(range, value);
+        });
+      }
+
       struct CompareEntry
       {
         bool
@@ -115,6 +122,8 @@ namespace llarp
       void
       Insert(const Range_t& addr, const Value_t& val)
       {
+        m_Index.Insert(addr, m_Entries.size());
+        m_ValueCounts[val]++;
         m_Entries.emplace_back(addr, val);
       }
 
@@ -130,6 +139,14 @@ namespace llarp
           else
             ++itr;
         }
+        // the indexes past anything we took out have all moved, start over
+        m_Index.Clear();
+        m_ValueCounts.clear();
+        for (size_t idx = 0; idx < m_Entries.size(); ++idx)
+        {
+          m_Index.Insert(m_Entries[idx].first, idx);
+          m_ValueCounts[m_Entries[idx].second]++;
+        }
       }
 
       util::StatusObject
@@ -145,6 +162,8 @@ namespace llarp
 
      private:
       Container_t m_Entries;
+      IPRangeTrie<size_t> m_Index;
+      std::unordered_map<Value_t, size_t> m_ValueCounts;
     };
   }  // namespace net
 }  // namespace llarp
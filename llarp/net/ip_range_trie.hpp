@@ -0,0 +1,218 @@
+#pragma once
+
+#include "ip_range.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace llarp::net
+{
+  /// a path compressed binary trie of ip ranges, each with values hung off it, so finding the
+  /// ranges that hold an address costs one walk down at most 128 bits instead of a look at every
+  /// range.  nodes live in one vector and point at each other by index.
+  ///
+  /// ranges whose netmask is not a prefix cannot go in the trie and are kept off to the side in a
+  /// list we scan, nobody makes those on purpose.
+  template <typename Value_t>
+  class IPRangeTrie
+  {
+   public:
+    IPRangeTrie()
+    {
+      Clear();
+    }
+
+    void
+    Clear()
+    {
+      m_Nodes.clear();
+      m_Nodes.emplace_back();
+      m_Odd.clear();
+      m_Size = 0;
+    }
+
+    /// how many values we hold
+    size_t
+    Size() const
+    {
+      return m_Size;
+    }
+
+    void
+    Insert(const IPRange& range, Value_t val)
+    {
+      m_Size++;
+      const uint32_t len = bits::count_bits_128(range.netmask_bits.h);
+      if (Mask(len) != range.netmask_bits.h)
+      {
+        m_Odd.emplace_back(range, std::move(val));
+        return;
+      }
+      const auto key = range.addr.h & Mask(len);
+
+      uint32_t idx = 0;
+      for (;;)
+      {
+        if (m_Nodes[idx].bits == len)
+        {
+          m_Nodes[idx].values.emplace_back(std::move(val));
+          return;
+        }
+        // m_Nodes[idx] holds key and is shorter than it
+        const auto dir = Bit(key, m_Nodes[idx].bits);
+        const auto childIdx = m_Nodes[idx].child[dir];
+        if (childIdx == None)
+        {
+          // AddNode can move m_Nodes about so we index again after it
+          const auto leaf = AddNode(key, len, std::move(val));
+          m_Nodes[idx].child[dir] = leaf;
+          return;
+        }
+        const auto childPrefix = m_Nodes[childIdx].prefix;
+        const auto childBits = m_Nodes[childIdx].bits;
+        const auto common = std::min({CommonBits(childPrefix, key), childBits, len});
+        if (common == childBits)
+        {
+          idx = childIdx;
+          continue;
+        }
+        // the child and us part ways above it, a new node goes in between
+        uint32_t mid;
+        if (common == len)
+          mid = AddNode(key, len, std::move(val));
+        else
+        {
+          mid = AddNode(key & Mask(common), common);
+          const auto leaf = AddNode(key, len, std::move(val));
+          m_Nodes[mid].child[Bit(key, common)] = leaf;
+        }
+        m_Nodes[mid].child[Bit(childPrefix, common)] = childIdx;
+        m_Nodes[idx].child[dir] = mid;
+        return;
+      }
+    }
+
+    /// call visit(range, value) on every value whose range holds addr, the shortest ranges first
+    template <typename Visit_t>
+    void
+    ForEachMatch(const huint128_t& addr, Visit_t&& visit) const
+    {
+      uint32_t idx = 0;
+      while (idx != None)
+      {
+        const auto& node = m_Nodes[idx];
+        if (CommonBits(node.prefix, addr.h) < node.bits)
+          break;
+        if (not node.values.empty())
+        {
+          const IPRange range{huint128_t{node.prefix}, huint128_t{Mask(node.bits)}};
+          for (const auto& val : node.values)
+            visit(range, val);
+        }
+        if (node.bits == 128)
+          break;
+        idx = node.child[Bit(addr.h, node.bits)];
+      }
+      for (const auto& [range, val] : m_Odd)
+      {
+        if (range.Contains(addr))
+          visit(range, val);
+      }
+    }
+
+    /// the first value of the longest range that holds addr, nullptr if none do
+    const Value_t*
+    FindLongestMatch(const huint128_t& addr) const
+    {
+      const Value_t* found = nullptr;
+      int longest = -1;
+      ForEachMatch(addr, [&](const IPRange& range, const Value_t& val) {
+        const int len = bits::count_bits_128(range.netmask_bits.h);
+        if (len > longest)
+        {
+          longest = len;
+          found = &val;
+        }
+      });
+      return found;
+    }
+
+    /// return true if any range holds addr
+    bool
+    Contains(const huint128_t& addr) const
+    {
+      bool found = false;
+      ForEachMatch(addr, [&found](const auto&, const auto&) { found = true; });
+      return found;
+    }
+
+   private:
+    static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+    struct Node
+    {
+      uint128_t prefix{0};
+      uint32_t bits{0};
+      std::array<uint32_t, 2> child{None, None};
+      std::vector<Value_t> values;
+    };
+
+    /// a netmask of the top bits bits
+    static uint128_t
+    Mask(uint32_t bits)
+    {
+      constexpr uint64_t ones = ~uint64_t{0};
+      if (bits == 0)
+        return uint128_t{0, 0};
+      if (bits <= 64)
+        return uint128_t{ones << (64 - bits), 0};
+      return uint128_t{ones, ones << (128 - bits)};
+    }
+
+    /// bit idx of v counting from the top
+    static uint32_t
+    Bit(const uint128_t& v, uint32_t idx)
+    {
+      if (idx < 64)
+        return (v.upper >> (63 - idx)) & 1;
+      return (v.lower >> (127 - idx)) & 1;
+    }
+
+    /// how many top bits a and b share
+    static uint32_t
+    CommonBits(const uint128_t& a, const uint128_t& b)
+    {
+      if (const auto diff = a.upper ^ b.upper)
+        return __builtin_clzll(diff);
+      if (const auto diff = a.lower ^ b.lower)
+        return 64 + __builtin_clzll(diff);
+      return 128;
+    }
+
+    uint32_t
+    AddNode(const uint128_t& prefix, uint32_t bits)
+    {
+      auto& node = m_Nodes.emplace_back();
+      node.prefix = prefix;
+      node.bits = bits;
+      return m_Nodes.size() - 1;
+    }
+
+    uint32_t
+    AddNode(const uint128_t& prefix, uint32_t bits, Value_t val)
+    {
+      const auto idx = AddNode(prefix, bits);
+      m_Nodes[idx].values.emplace_back(std::move(val));
+      return idx;
+    }
+
+    /// m_Nodes[0] is the root, the empty prefix
+    std::vector<Node> m_Nodes;
+    std::vector<std::pair<IPRange, Value_t>> m_Odd;
+    size_t m_Size;
+  };
+}  // namespace llarp::net
@@ -0,0 +1,148 @@
+#include "offload.hpp"
+#include "ip_packet.hpp"
+
+#include <oxenc/endian.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace llarp::net
+{
+  namespace
+  {
+    constexpr uint8_t TCPProto = 6;
+    constexpr byte_t TCPFin = 0x01;
+    constexpr byte_t TCPPsh = 0x08;
+    constexpr byte_t TCPCwr = 0x80;
+
+    /// ones complement sum of the 16 bit words in [ptr, ptr + sz), sz must be even
+    uint32_t
+    SumWords(const byte_t* ptr, size_t sz)
+    {
+      uint32_t sum = 0;
+      for (size_t idx = 0; idx < sz; idx += 2)
+      {
+        uint16_t word;
+        std::memcpy(&word, ptr + idx, sizeof(word));
+        sum += word;
+      }
+      return sum;
+    }
+
+    void
+    PutChecksum(byte_t* ptr, uint16_t check)
+    {
+      std::memcpy(ptr, &check, sizeof(check));
+    }
+
+    /// work out the whole tcp checksum of the segment at pkt, its ip header being ipLen bytes
+    void
+    TCPChecksum(byte_t* pkt, size_t ipLen, size_t sz, bool v4)
+    {
+      const auto tcpLen = sz - ipLen;
+      // pseudo header, the addresses sit next to each other in both ip versions
+      uint32_t sum = v4 ? SumWords(pkt + 12, 8) : SumWords(pkt + 8, 32);
+      sum += oxenc::host_to_big<uint16_t>(TCPProto);
+      sum += oxenc::host_to_big<uint16_t>(tcpLen);
+
+      auto* tcp = pkt + ipLen;
+      PutChecksum(tcp + 16, 0);
+      PutChecksum(tcp + 16, ipchksum(tcp, tcpLen, sum));
+    }
+  }  // namespace
+
+  bool
+  SplitOffloaded(
+      const VNetHeader& hdr,
+      byte_t* pkt,
+      size_t sz,
+      const std::function<void(const byte_t*, size_t)>& visit)
+  {
+    const auto gso = hdr.gsoType & ~VNetHeader::GSOECN;
+    if (gso == VNetHeader::GSONone)
+    {
+      if (hdr.flags & VNetHeader::NeedsChecksum)
+      {
+        // the kernel already put the pseudo header sum where the checksum goes, summing from
+        // csumStart to the end gives us the checksum
+        const size_t at = size_t{hdr.csumStart} + hdr.csumOffset;
+        if (hdr.csumStart >= sz or at + 2 > sz)
+          return false;
+        auto check = ipchksum(pkt + hdr.csumStart, sz - hdr.csumStart);
+        // udp sends a checksum of zero as all ones, zero means there is none
+        if (check == 0 and hdr.csumOffset == 6)
+          check = 0xffff;
+        PutChecksum(pkt + at, check);
+      }
+      visit(pkt, sz);
+      return true;
+    }
+
+    if ((gso != VNetHeader::GSOTCPv4 and gso != VNetHeader::GSOTCPv6) or hdr.gsoSize == 0)
+      return false;
+
+    // we work the header sizes out ourselves rather than trust hdr.hdrLen
+    const bool v4 = gso == VNetHeader::GSOTCPv4;
+    size_t ipLen = sizeof(ipv6_header);
+    if (v4)
+    {
+      if (sz < 20 or (pkt[0] >> 4) != 4 or pkt[9] != TCPProto)
+        return false;
+      ipLen = (pkt[0] & 0x0f) * 4;
+    }
+    else if (sz < ipLen or (pkt[0] >> 4) != 6 or pkt[6] != TCPProto)
+      return false;
+
+    if (ipLen < 20 or sz < ipLen + 20)
+      return false;
+    const size_t headers = ipLen + (pkt[ipLen + 12] >> 4) * 4;
+    if (headers < ipLen + 20 or headers > sz)
+      return false;
+
+    std::array<byte_t, IPPacket::MaxSize> seg;
+    if (headers + hdr.gsoSize > seg.size())
+      return false;
+
+    const auto id = oxenc::load_big_to_host<uint16_t>(pkt + 4);
+    const auto seqno = oxenc::load_big_to_host<uint32_t>(pkt + ipLen + 4);
+    const auto flags = pkt[ipLen + 13];
+
+    size_t off = headers;
+    for (size_t n = 0; n == 0 or off < sz; ++n)
+    {
+      const auto chunk = std::min<size_t>(hdr.gsoSize, sz - off);
+      const auto segSize = headers + chunk;
+      const bool last = off + chunk == sz;
+
+      std::memcpy(seg.data(), pkt, headers);
+      std::memcpy(seg.data() + headers, pkt + off, chunk);
+
+      if (v4)
+      {
+        oxenc::write_host_as_big<uint16_t>(segSize, seg.data() + 2);
+        oxenc::write_host_as_big<uint16_t>(id + n, seg.data() + 4);
+        PutChecksum(seg.data() + 10, 0);
+        PutChecksum(seg.data() + 10, ipchksum(seg.data(), ipLen));
+      }
+      else
+        oxenc::write_host_as_big<uint16_t>(segSize - ipLen, seg.data() + 4);
+
+      auto* tcp = seg.data() + ipLen;
+      oxenc::write_host_as_big<uint32_t>(seqno + (off - headers), tcp + 4);
+      // fin and psh belong on the last segment, cwr on the first
+      auto segFlags = flags;
+      if (not last)
+        segFlags &= ~(TCPFin | TCPPsh);
+      if (n)
+        segFlags &= ~TCPCwr;
+      tcp[13] = segFlags;
+      TCPChecksum(seg.data(), ipLen, segSize, v4);
+
+      visit(seg.data(), segSize);
+      off += chunk;
+    }
+    return true;
+  }
+
+}  // namespace llarp::net
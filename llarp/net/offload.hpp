@@ -0,0 +1,48 @@
+#pragma once
+
+#include <llarp/util/types.hpp>
+
+#include <cstdint>
+#include <functional>
+
+namespace llarp::net
+{
+  /// the header a linux tun device opened with IFF_VNET_HDR puts in front of every packet, laid
+  /// out like struct virtio_net_hdr in host byte order
+  struct VNetHeader
+  {
+    /// VIRTIO_NET_HDR_F_NEEDS_CSUM, the l4 checksum at csumStart + csumOffset is only the pseudo
+    /// header sum and the rest is left to us
+    static constexpr uint8_t NeedsChecksum = 1;
+
+    static constexpr uint8_t GSONone = 0;
+    static constexpr uint8_t GSOTCPv4 = 1;
+    static constexpr uint8_t GSOTCPv6 = 4;
+    static constexpr uint8_t GSOECN = 0x80;
+
+    uint8_t flags;
+    uint8_t gsoType;
+    uint16_t hdrLen;
+    uint16_t gsoSize;
+    uint16_t csumStart;
+    uint16_t csumOffset;
+  };
+
+  static_assert(sizeof(VNetHeader) == 10);
+
+  /// the biggest read a tun device with offloads on can hand us
+  constexpr size_t MaxOffloadReadSize = sizeof(VNetHeader) + 65535;
+
+  /// turn one packet read from a tun device with offloads on into the packets it stands for.
+  /// checksums the kernel left to us are finished and tcp super packets are cut into segments of
+  /// hdr.gsoSize, each with its own headers.  pkt may be modified.  each packet is passed to visit
+  /// and is only good until visit returns.  returns false if pkt does not make sense, visit may
+  /// have been called for some of it already.
+  bool
+  SplitOffloaded(
+      const VNetHeader& hdr,
+      byte_t* pkt,
+      size_t sz,
+      const std::function<void(const byte_t*, size_t)>& visit);
+
+}  // namespace llarp::net
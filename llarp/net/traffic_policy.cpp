@@ -47,7 +47,7 @@ namespace llarp::net
   bool
   TrafficPolicy::AllowsTraffic(const IPPacket& pkt) const
   {
-    if (protocols.empty() and ranges.empty())
+    if (protocols.empty() and m_Ranges.empty())
       return true;
 
     for (const auto& proto : protocols)
@@ -55,19 +55,40 @@ namespace llarp::net
       if (proto.MatchesPacket(pkt))
         return true;
     }
-    for (const auto& range : ranges)
-    {
-      huint128_t dst;
-      if (pkt.IsV6())
-        dst = pkt.dstv6();
-      else if (pkt.IsV4())
-        dst = pkt.dst4to6();
-      else
-        return false;
-      if (range.Contains(dst))
-        return true;
-    }
-    return false;
+    if (m_Ranges.empty())
+      return false;
+
+    huint128_t dst;
+    if (pkt.IsV6())
+      dst = pkt.dstv6();
+    else if (pkt.IsV4())
+      dst = pkt.dst4to6();
+    else
+      return false;
+
+    return m_RangeIndex.Contains(dst);
+  }
+
+  void
+  TrafficPolicy::AddRange(IPRange range)
+  {
+    if (m_Ranges.insert(range).second)
+      m_RangeIndex.Insert(range, range);
+  }
+
+  void
+  TrafficPolicy::SetRanges(std::set<IPRange> ranges)
+  {
+    m_Ranges = std::move(ranges);
+    IndexRanges();
+  }
+
+  void
+  TrafficPolicy::IndexRanges()
+  {
+    m_RangeIndex.Clear();
+    for (const auto& range : m_Ranges)
+      m_RangeIndex.Insert(range, range);
   }
 
   bool
@@ -148,7 +169,7 @@ namespace llarp::net
     if (not bencode_start_list(buf))
       return false;
 
-    for (const auto& item : ranges)
+    for (const auto& item : m_Ranges)
     {
       if (not item.BEncode(buf))
         return false;
@@ -163,7 +184,7 @@ namespace llarp::net
   bool
   TrafficPolicy::BDecode(llarp_buffer_t* buf)
   {
-    return bencode_read_dict(
+    const bool ok = bencode_read_dict(
         [&](llarp_buffer_t* buffer, llarp_buffer_t* key) -> bool {
           if (key == nullptr)
             return true;
@@ -173,11 +194,13 @@ namespace llarp::net
           }
           if (key->startswith("r"))
           {
-            return BEncodeReadSet(ranges, buffer);
+            return BEncodeReadSet(m_Ranges, buffer);
           }
           return bencode_discard(buffer);
         },
         buf);
+    IndexRanges();
+    return ok;
   }
 
   util::StatusObject
@@ -196,7 +219,7 @@ namespace llarp::net
   {
     std::vector<util::StatusObject> rangesStatus;
     std::transform(
-        ranges.begin(), ranges.end(), std::back_inserter(rangesStatus), [](const auto& range) {
+        m_Ranges.begin(), m_Ranges.end(), std::back_inserter(rangesStatus), [](const auto& range) {
           return range.ToString();
         });
 
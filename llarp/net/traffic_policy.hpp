@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ip_range.hpp"
+#include "ip_range_trie.hpp"
 #include "ip_packet.hpp"
 #include "llarp/util/status.hpp"
 
@@ -44,9 +45,6 @@ namespace llarp::net
   /// information about what traffic an endpoint will carry
   struct TrafficPolicy
   {
-    /// ranges that are explicitly allowed
-    std::set<IPRange> ranges;
-
     /// protocols that are explicity allowed
     std::set<ProtocolInfo> protocols;
 
@@ -62,5 +60,29 @@ namespace llarp::net
     /// returns false otherwise
     bool
     AllowsTraffic(const IPPacket& pkt) const;
+
+    /// ranges that are explicitly allowed
+    const std::set<IPRange>&
+    Ranges() const
+    {
+      return m_Ranges;
+    }
+
+    /// explicitly allow a range
+    void
+    AddRange(IPRange range);
+
+    /// replace all explicitly allowed ranges
+    void
+    SetRanges(std::set<IPRange> ranges);
+
+   private:
+    /// rebuild the trie AllowsTraffic looks ranges up in
+    void
+    IndexRanges();
+
+    /// only changed through AddRange, SetRanges or BDecode so m_RangeIndex always matches it
+    std::set<IPRange> m_Ranges;
+    IPRangeTrie<IPRange> m_RangeIndex;
   };
 }  // namespace llarp::net
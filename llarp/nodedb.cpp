@@ -12,6 +12,9 @@
 #include "dht/kademlia.hpp"
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 
@@ -22,11 +25,12 @@ namespace llarp
 {
   static auto logcat = log::Cat("nodedb");
 
-  NodeDB::Entry::Entry(RouterContact value) : rc(std::move(value)), insertedAt(llarp::time_now_ms())
+  NodeDB::Entry::Entry(RouterContact value)
+      : rc(std::move(value)), hopKey(rc), insertedAt(llarp::time_now_ms())
   {}
 
   static void
-  EnsureSkiplist(fs::path nodedbDir)
+  EnsureNodeDBDir(fs::path nodedbDir)
   {
     if (not fs::exists(nodedbDir))
     {
@@ -41,31 +45,60 @@ namespace llarp
 
     if (not fs::is_directory(nodedbDir))
       throw std::runtime_error{fmt::format("nodedb {} is not a directory", nodedbDir)};
-
-    for (const char& ch : skiplist_subdirs)
-    {
-      // this seems to be a problem on all targets
-      // perhaps cpp17::fs is just as screwed-up
-      // attempting to create a folder with no name
-      // what does this mean...?
-      if (!ch)
-        continue;
-
-      fs::path sub = nodedbDir / std::string(&ch, 1);
-      fs::create_directory(sub);
-    }
   }
 
   constexpr auto FlushInterval = 5min;
 
+  /// we rewrite the store from scratch once it holds more than this many records per live rc
+  constexpr size_t CompactRatio = 2;
+  /// plus this many, so a small nodedb is not rewritten over a handful of changes
+  constexpr size_t CompactSlack = 1024;
+
+  struct NodeDB::DiskWriter
+  {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> jobs;
+    /// a Drain is queued on disk or running
+    bool scheduled = false;
+    /// a write is being made right now
+    bool busy = false;
+    /// pubkeys whose changes we failed to write, we try them again on the next flush
+    std::unordered_set<RouterID> failed;
+
+    void
+    Drain()
+    {
+      std::unique_lock lock{mutex};
+      while (not jobs.empty())
+      {
+        cond.wait(lock, [this] { return not busy; });
+        if (jobs.empty())
+          break;
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+        job();
+        lock.lock();
+        busy = false;
+        cond.notify_all();
+      }
+      scheduled = false;
+    }
+  };
+
   NodeDB::NodeDB(fs::path root, std::function<void(std::function<void()>)> diskCaller)
       : m_Root{std::move(root)}
       , disk(std::move(diskCaller))
       , m_NextFlushAt{time_now_ms() + FlushInterval}
+      , m_Writer{std::make_shared<DiskWriter>()}
   {
-    EnsureSkiplist(m_Root);
+    EnsureNodeDBDir(m_Root);
+    m_Store = std::make_shared<NodeDBStore>(m_Root / NodeDBStore::FileName);
   }
-  NodeDB::NodeDB() : m_Root{}, disk{[](auto) {}}, m_NextFlushAt{0s}
+  NodeDB::NodeDB()
+      : m_Root{}, disk{[](auto) {}}, m_NextFlushAt{0s}, m_Writer{std::make_shared<DiskWriter>()}
   {}
 
   void
@@ -77,49 +110,122 @@ namespace llarp
     if (now > m_NextFlushAt)
     {
       m_NextFlushAt += FlushInterval;
-      // make copy of all rcs
-      std::vector<RouterContact> copy;
-      for (const auto& item : m_Entries)
-        copy.push_back(item.second.rc);
-      // flush them to disk in one big job
-      // TODO: split this up? idk maybe some day...
-      disk([this, data = std::move(copy)]() {
-        for (const auto& rc : data)
-        {
-          rc.Write(GetPathForPubkey(rc.pubkey));
-        }
-      });
+      FlushChanges();
     }
   }
 
-  fs::path
-  NodeDB::GetPathForPubkey(RouterID pubkey) const
+  void
+  NodeDB::QueueWrite(std::function<void()> job)
   {
-    std::string hexString = oxenc::to_hex(pubkey.begin(), pubkey.end());
-    std::string skiplistDir;
+    {
+      std::lock_guard lock{m_Writer->mutex};
+      m_Writer->jobs.push_back(std::move(job));
+      if (std::exchange(m_Writer->scheduled, true))
+        return;
+    }
+    disk([writer = m_Writer]() { writer->Drain(); });
+  }
 
-    const llarp::RouterID r{pubkey};
-    std::string fname = r.ToString();
+  bool
+  NodeDB::WriteNow(const std::function<bool()>& f)
+  {
+    std::unique_lock lock{m_Writer->mutex};
+    m_Writer->cond.wait(lock, [this] { return not m_Writer->busy; });
+    m_Writer->busy = true;
+    lock.unlock();
+    const bool written = f();
+    lock.lock();
+    if (written)
+    {
+      m_Writer->jobs.clear();
+      m_Writer->failed.clear();
+    }
+    m_Writer->busy = false;
+    m_Writer->cond.notify_all();
+    return written;
+  }
 
-    skiplistDir += hexString[0];
-    fname += RC_FILE_EXT;
-    return m_Root / skiplistDir / fname;
+  bool
+  NodeDB::NeedsCompaction(size_t records) const
+  {
+    return records > (m_Entries.size() * CompactRatio) + CompactSlack;
   }
 
   void
-  NodeDB::LoadFromDisk()
+  NodeDB::FlushChanges()
   {
-    if (m_Root.empty())
+    if (not m_Store)
+      return;
+
+    {
+      // whatever we failed to write last time goes out with this flush
+      std::lock_guard lock{m_Writer->mutex};
+      for (const auto& pk : m_Writer->failed)
+      {
+        if (m_Entries.count(pk))
+          m_Dirty.insert(pk);
+        else
+          m_Removed.insert(pk);
+      }
+      m_Writer->failed.clear();
+    }
+    if (m_Dirty.empty() and m_Removed.empty())
       return;
-    std::set<fs::path> purge;
 
+    std::vector<RouterID> changed{m_Dirty.begin(), m_Dirty.end()};
+    changed.insert(changed.end(), m_Removed.begin(), m_Removed.end());
+    auto failed = [writer = m_Writer, changed = std::move(changed)]() {
+      std::lock_guard lock{writer->mutex};
+      writer->failed.insert(changed.begin(), changed.end());
+    };
+
+    if (NeedsCompaction(m_Store->Records() + m_Dirty.size() + m_Removed.size()))
+    {
+      std::vector<RouterContact> all;
+      all.reserve(m_Entries.size());
+      for (const auto& item : m_Entries)
+        all.push_back(item.second.rc);
+      QueueWrite([store = m_Store, all = std::move(all), failed = std::move(failed)]() {
+        if (not store->Rewrite(all))
+          failed();
+      });
+    }
+    else
+    {
+      std::vector<RouterContact> puts;
+      puts.reserve(m_Dirty.size());
+      for (const auto& pk : m_Dirty)
+      {
+        if (auto itr = m_Entries.find(pk); itr != m_Entries.end())
+          puts.push_back(itr->second.rc);
+      }
+      std::vector<RouterID> removes{m_Removed.begin(), m_Removed.end()};
+      QueueWrite([store = m_Store,
+                  puts = std::move(puts),
+                  removes = std::move(removes),
+                  failed = std::move(failed)]() {
+        if (not store->Append(puts, removes))
+          failed();
+      });
+    }
+    // a write that fails hands its pubkeys back for the next flush
+    m_Dirty.clear();
+    m_Removed.clear();
+    AsyncSaveVerifyCache();
+  }
+
+  bool
+  NodeDB::LoadSkiplist(std::unordered_map<RouterID, RouterContact>& rcs) const
+  {
+    bool found = false;
     for (const char& ch : skiplist_subdirs)
     {
       if (!ch)
         continue;
-      std::string p;
-      p += ch;
-      fs::path sub = m_Root / p;
+      fs::path sub = m_Root / std::string(&ch, 1);
+      if (not fs::is_directory(sub))
+        continue;
+      found = true;
 
       llarp::util::IterDir(sub, [&](const fs::path& f) -> bool {
         // skip files that are not suffixed with .signed
@@ -127,56 +233,137 @@ namespace llarp
           return true;
 
         RouterContact rc{};
-
-        if (not rc.Read(f))
+        if (rc.Read(f))
         {
-          // try loading it, purge it if it is junk
-          purge.emplace(f);
-          return true;
+          const RouterID pk{rc.pubkey};
+          rcs.insert_or_assign(pk, std::move(rc));
         }
+        return true;
+      });
+    }
+    return found;
+  }
 
-        if (not rc.FromOurNetwork())
-        {
-          // skip entries that are not from our network
-          return true;
-        }
+  void
+  NodeDB::RemoveSkiplist() const
+  {
+    for (const char& ch : skiplist_subdirs)
+    {
+      if (!ch)
+        continue;
+      std::error_code ec;
+      fs::remove_all(m_Root / std::string(&ch, 1), ec);
+      if (ec)
+        log::warning(logcat, "failed to remove old nodedb directory: {}", ec.message());
+    }
+  }
 
-        if (rc.IsExpired(time_now_ms()))
-        {
-          // rc expired dont load it and purge it later
-          purge.emplace(f);
-          return true;
-        }
+  void
+  NodeDB::LoadFromDisk(thread::WorkPool* workers)
+  {
+    if (m_Root.empty())
+      return;
 
-        // validate signature and purge entries with invalid signatures
-        // load ones with valid signatures
-        if (rc.VerifySignature())
-          m_Entries.emplace(rc.pubkey, rc);
-        else
-          purge.emplace(f);
+    const auto started = std::chrono::steady_clock::now();
+    const auto cached = m_VerifyCache->Load(VerifyCacheFile());
 
-        return true;
-      });
+    std::unordered_map<RouterID, RouterContact> rcs;
+    bool migrating = false;
+    if (not m_Store->Load(rcs))
+    {
+      if (m_Store->Exists())
+        log::warning(logcat, "{} is not a nodedb store, starting it over", m_Store->File());
+      migrating = LoadSkiplist(rcs);
+      if (migrating)
+        log::info(logcat, "migrating {} RCs to {}", rcs.size(), m_Store->File());
     }
 
-    if (not purge.empty())
+    std::vector<RouterID> purged;
+    const auto now = time_now_ms();
+    // skip entries that are not from our network or expired, then check the signatures of what is
+    // left in one go
+    std::vector<const RouterContact*> check;
+    check.reserve(rcs.size());
+    for (auto itr = rcs.begin(); itr != rcs.end();)
     {
-      log::warning(logcat, "removing {} invalid RCs from disk", purge.size());
-
-      for (const auto& fpath : purge)
-        fs::remove(fpath);
+      if (itr->second.FromOurNetwork() and not itr->second.IsExpired(now))
+      {
+        check.push_back(&itr->second);
+        ++itr;
+      }
+      else
+      {
+        purged.push_back(itr->first);
+        itr = rcs.erase(itr);
+      }
     }
+    const auto hits = m_VerifyCache->Hits();
+    const auto good = m_VerifyCache->VerifyMany(check, workers);
+    for (size_t idx = 0; idx < check.size(); ++idx)
+    {
+      if (good[idx])
+        Insert(std::move(rcs.at(check[idx]->pubkey)));
+      else
+        purged.emplace_back(check[idx]->pubkey);
+    }
+    // nothing we just loaded needs writing back but what we threw out needs removing
+    m_Dirty.clear();
+    m_Removed = {purged.begin(), purged.end()};
+
+    if (not purged.empty())
+      log::warning(logcat, "removing {} invalid RCs from disk", purged.size());
+
+    log::info(
+        logcat,
+        "loaded {} RCs in {}, {} of {} signatures were already verified",
+        m_Entries.size(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started),
+        m_VerifyCache->Hits() - hits,
+        check.size());
+
+    if (migrating or NeedsCompaction(m_Store->Records() + m_Removed.size()))
+    {
+      SaveToDisk();
+      if (migrating)
+        RemoveSkiplist();
+    }
+    else if (not m_Removed.empty())
+      FlushChanges();
+    else if (cached != m_VerifyCache->Size())
+      AsyncSaveVerifyCache();
+  }
+
+  fs::path
+  NodeDB::VerifyCacheFile() const
+  {
+    return m_Root / "verified.dat";
   }
 
   void
-  NodeDB::SaveToDisk() const
+  NodeDB::AsyncSaveVerifyCache()
   {
-    if (m_Root.empty())
+    QueueWrite([cache = m_VerifyCache, file = VerifyCacheFile()]() { cache->Save(file); });
+  }
+
+  void
+  NodeDB::SaveToDisk()
+  {
+    if (not m_Store)
       return;
 
+    std::vector<RouterContact> all;
+    all.reserve(m_Entries.size());
     for (const auto& item : m_Entries)
+      all.push_back(item.second.rc);
+    const bool saved = WriteNow([&]() {
+      m_VerifyCache->Save(VerifyCacheFile());
+      return m_Store->Rewrite(all);
+    });
+    if (saved)
     {
-      item.second.rc.Write(GetPathForPubkey(item.first));
+      m_Dirty.clear();
+      m_Removed.clear();
     }
   }
 
@@ -201,36 +388,57 @@ namespace llarp
   NodeDB::Remove(RouterID pk)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(pk);
-    AsyncRemoveManyFromDisk({pk});
+    if (auto itr = m_Entries.find(pk); itr != m_Entries.end())
+      Erase(itr);
   }
 
   void
   NodeDB::RemoveStaleRCs(std::unordered_set<RouterID> keep, llarp_time_t cutoff)
   {
     util::NullLock lock{m_Access};
-    std::unordered_set<RouterID> removed;
     auto itr = m_Entries.begin();
     while (itr != m_Entries.end())
     {
       if (itr->second.insertedAt < cutoff and keep.count(itr->second.rc.pubkey) == 0)
-      {
-        removed.insert(itr->second.rc.pubkey);
-        itr = m_Entries.erase(itr);
-      }
+        itr = Erase(itr);
       else
         ++itr;
     }
-    if (not removed.empty())
-      AsyncRemoveManyFromDisk(std::move(removed));
   }
 
   void
   NodeDB::Put(RouterContact rc)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(rc.pubkey);
-    m_Entries.emplace(rc.pubkey, rc);
+    Insert(std::move(rc));
+  }
+
+  void
+  NodeDB::Insert(RouterContact rc)
+  {
+    if (auto itr = m_Entries.find(rc.pubkey); itr != m_Entries.end())
+      Erase(itr);
+    const RouterID pk{rc.pubkey};
+    auto itr = m_Entries.emplace(pk, std::move(rc)).first;
+    m_ByKey.emplace(pk, &itr->second.rc);
+    itr->second.index = m_Dense.size();
+    m_Dense.push_back(&itr->second);
+    m_Removed.erase(pk);
+    m_Dirty.insert(pk);
+  }
+
+  NodeDB::NodeMap::iterator
+  NodeDB::Erase(NodeMap::iterator itr)
+  {
+    m_ByKey.erase(itr->first);
+    m_Dirty.erase(itr->first);
+    m_Removed.insert(itr->first);
+    // move the last entry into the hole we leave
+    const auto idx = itr->second.index;
+    m_Dense[idx] = m_Dense.back();
+    m_Dense[idx]->index = idx;
+    m_Dense.pop_back();
+    return m_Entries.erase(itr);
   }
 
   size_t
@@ -246,78 +454,93 @@ namespace llarp
     util::NullLock lock{m_Access};
     auto itr = m_Entries.find(rc.pubkey);
     if (itr == m_Entries.end() or itr->second.rc.OtherIsNewer(rc))
+      Insert(std::move(rc));
+  }
+
+  /// the index of the first bit that differs between a and b, or the number of bits in a key if
+  /// they are equal
+  static size_t
+  FirstDifferingBit(const RouterID& a, const RouterID& b)
+  {
+    for (size_t idx = 0; idx < RouterID::SIZE; ++idx)
     {
-      // delete if existing
-      if (itr != m_Entries.end())
-        m_Entries.erase(itr);
-      // add new entry
-      m_Entries.emplace(rc.pubkey, rc);
+      if (const uint8_t diff = a[idx] ^ b[idx])
+      {
+        size_t bit = idx * 8;
+        for (uint8_t mask = 0x80; (diff & mask) == 0; mask >>= 1)
+          ++bit;
+        return bit;
+      }
     }
+    return RouterID::SIZE * 8;
+  }
+
+  static bool
+  BitIsSet(const AlignedBuffer<32>& key, size_t bit)
+  {
+    return key[bit / 8] & (0x80 >> (bit % 8));
   }
 
   void
-  NodeDB::AsyncRemoveManyFromDisk(std::unordered_set<RouterID> remove) const
+  NodeDB::CollectClosest(
+      KeyIndex::const_iterator begin,
+      KeyIndex::const_iterator end,
+      const dht::Key_t& location,
+      size_t num,
+      std::vector<const RouterContact*>& out) const
   {
-    if (m_Root.empty())
+    if (begin == end or out.size() >= num)
       return;
-    // build file list
-    std::set<fs::path> files;
-    for (auto id : remove)
+    const auto& first = begin->first;
+    const auto bit = FirstDifferingBit(first, std::prev(end)->first);
+    if (bit == RouterID::SIZE * 8)
     {
-      files.emplace(GetPathForPubkey(std::move(id)));
+      // only one key left in this part of the trie
+      out.push_back(begin->second);
+      return;
+    }
+    // everything in the range shares the bits before bit and both values of bit are in it, the
+    // first key with bit set splits the range in two subtrees
+    RouterID pivot{first};
+    pivot[bit / 8] = (pivot[bit / 8] & (0xff00 >> (bit % 8))) | (0x80 >> (bit % 8));
+    std::fill(pivot.begin() + (bit / 8) + 1, pivot.end(), 0);
+    const auto split = m_ByKey.lower_bound(pivot);
+    // whichever subtree agrees with location on bit is closer than all of the other one
+    if (BitIsSet(location, bit))
+    {
+      CollectClosest(split, end, location, num, out);
+      CollectClosest(begin, split, location, num, out);
+    }
+    else
+    {
+      CollectClosest(begin, split, location, num, out);
+      CollectClosest(split, end, location, num, out);
     }
-    // remove them from the disk via the diskio thread
-    disk([files]() {
-      for (auto fpath : files)
-        fs::remove(fpath);
-    });
   }
 
   llarp::RouterContact
   NodeDB::FindClosestTo(llarp::dht::Key_t location) const
   {
     util::NullLock lock{m_Access};
-    llarp::RouterContact rc;
-    const llarp::dht::XorMetric compare(location);
-    VisitAll([&rc, compare](const auto& otherRC) {
-      if (rc.pubkey.IsZero())
-      {
-        rc = otherRC;
-        return;
-      }
-      if (compare(
-              llarp::dht::Key_t{otherRC.pubkey.as_array()},
-              llarp::dht::Key_t{rc.pubkey.as_array()}))
-        rc = otherRC;
-    });
-    return rc;
+    std::vector<const RouterContact*> closest;
+    CollectClosest(m_ByKey.begin(), m_ByKey.end(), location, 1, closest);
+    if (closest.empty())
+      return {};
+    return *closest.front();
   }
 
   std::vector<RouterContact>
   NodeDB::FindManyClosestTo(llarp::dht::Key_t location, uint32_t numRouters) const
   {
     util::NullLock lock{m_Access};
-    std::vector<const RouterContact*> all;
-
-    const auto& entries = m_Entries;
-
-    all.reserve(entries.size());
-    for (auto& entry : entries)
-    {
-      all.push_back(&entry.second.rc);
-    }
-
-    auto it_mid = numRouters < all.size() ? all.begin() + numRouters : all.end();
-    std::partial_sort(
-        all.begin(), it_mid, all.end(), [compare = dht::XorMetric{location}](auto* a, auto* b) {
-          return compare(*a, *b);
-        });
-
-    std::vector<RouterContact> closest;
-    closest.reserve(numRouters);
-    for (auto it = all.begin(); it != it_mid; ++it)
-      closest.push_back(**it);
-
-    return closest;
+    std::vector<const RouterContact*> closest;
+    closest.reserve(std::min<size_t>(numRouters, m_ByKey.size()));
+    CollectClosest(m_ByKey.begin(), m_ByKey.end(), location, numRouters, closest);
+
+    std::vector<RouterContact> result;
+    result.reserve(closest.size());
+    for (const auto* rc : closest)
+      result.push_back(*rc);
+    return result;
   }
 }  // namespace llarp
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "nodedb_store.hpp"
+#include "rc_verify_cache.hpp"
 #include "router_contact.hpp"
 #include "router_id.hpp"
 #include "util/common.hpp"
@@ -8,14 +10,19 @@
 #include "util/thread/annotations.hpp"
 #include "dht/key.hpp"
 #include "crypto/crypto.hpp"
+#include "path/hop_selection.hpp"
 
+#include <map>
 #include <set>
 #include <optional>
 #include <unordered_set>
 #include <unordered_map>
 #include <utility>
 #include <atomic>
+#include <memory>
 #include <algorithm>
+#include <random>
+#include <vector>
 
 namespace llarp
 {
@@ -24,13 +31,30 @@ namespace llarp
     struct Entry
     {
       const RouterContact rc;
+      /// what hop selection looks at, worked out once when the rc comes in
+      const path::HopSelectionKey hopKey;
       llarp_time_t insertedAt;
+      /// where we are in m_Dense
+      size_t index = 0;
       explicit Entry(RouterContact rc);
     };
     using NodeMap = std::unordered_map<RouterID, Entry>;
 
     NodeMap m_Entries;
 
+    /// every entry packed into an array so we can pick one at random in O(1), entries are swapped
+    /// in from the back to fill the hole when one is removed
+    std::vector<Entry*> m_Dense;
+
+    /// how many random picks GetRandom makes before it falls back to scanning everything
+    static constexpr size_t RandomSampleTries = 32;
+
+    /// every entry's rc ordered by pubkey, all pubkeys sharing a prefix sit next to each other so
+    /// we can walk it like a binary trie to find the rcs closest to a dht key by xor metric
+    using KeyIndex = std::map<RouterID, const RouterContact*>;
+
+    KeyIndex m_ByKey;
+
     const fs::path m_Root;
 
     const std::function<void(std::function<void()>)> disk;
@@ -39,13 +63,107 @@ namespace llarp
 
     mutable util::NullMutex m_Access;
 
-    /// asynchronously remove the files for a set of rcs on disk given their public ident key
+    /// where our rcs live on disk, null for an in memory nodedb
+    std::shared_ptr<NodeDBStore> m_Store;
+
+    /// pubkeys put since we last wrote to m_Store
+    std::unordered_set<RouterID> m_Dirty;
+
+    /// pubkeys removed since we last wrote to m_Store
+    std::unordered_set<RouterID> m_Removed;
+
+    /// runs our writes to disk one at a time in the order we queued them, disk may run jobs on
+    /// many threads at once and in any order
+    struct DiskWriter;
+    const std::shared_ptr<DiskWriter> m_Writer;
+
+    /// queue a write to run after every write queued before it
     void
-    AsyncRemoveManyFromDisk(std::unordered_set<RouterID> idents) const;
+    QueueWrite(std::function<void()> job);
+
+    /// make a write right here once the one running now is done.  if f succeeds it superseded
+    /// every write still queued and they are dropped.
+    bool
+    WriteNow(const std::function<bool()>& f);
 
-    /// get filename of an RC file given its public ident key
+    /// whether a store holding this many records has piled up enough superseded ones to be
+    /// rewritten from scratch
+    bool
+    NeedsCompaction(size_t records) const;
+
+    /// rcs whose signatures we already checked, kept on disk next to m_Store
+    const std::shared_ptr<RCVerifyCache> m_VerifyCache = std::make_shared<RCVerifyCache>();
+
+    /// where m_VerifyCache is saved
     fs::path
-    GetPathForPubkey(RouterID pk) const;
+    VerifyCacheFile() const;
+
+    /// save m_VerifyCache in the background, in order with our other writes
+    void
+    AsyncSaveVerifyCache();
+
+    /// write what changed since the last flush to m_Store in the background, rewriting the whole
+    /// store instead if it has piled up too many superseded records
+    void
+    FlushChanges();
+
+    /// read rcs from the one file per rc directory layout we used to store them in, returns
+    /// false if there is none
+    bool
+    LoadSkiplist(std::unordered_map<RouterID, RouterContact>& rcs) const;
+
+    /// remove what is left of the one file per rc layout once we have migrated off it
+    void
+    RemoveSkiplist() const;
+
+    /// put rc into m_Entries, m_Dense and m_ByKey, replacing what we had for its pubkey
+    void
+    Insert(RouterContact rc);
+
+    /// remove an entry from m_Entries, m_Dense and m_ByKey, returns the next entry
+    NodeMap::iterator
+    Erase(NodeMap::iterator itr);
+
+    /// append up to num rcs from the range [begin, end) of m_ByKey to out, closest to location
+    /// first.  every pubkey in the range must share the same prefix and the range must hold
+    /// every pubkey with that prefix.
+    void
+    CollectClosest(
+        KeyIndex::const_iterator begin,
+        KeyIndex::const_iterator end,
+        const dht::Key_t& location,
+        size_t num,
+        std::vector<const RouterContact*>& out) const;
+
+    /// pick a random entry that passes visit, see GetRandom
+    template <typename Filter>
+    const Entry*
+    RandomEntry(Filter visit) const
+    {
+      if (m_Dense.empty())
+        return nullptr;
+
+      llarp::CSRNG rng{};
+      std::uniform_int_distribution<size_t> pick{0, m_Dense.size() - 1};
+
+      for (size_t n = 0; n < std::min(RandomSampleTries, m_Dense.size()); ++n)
+      {
+        const auto* entry = m_Dense[pick(rng)];
+        if (visit(*entry))
+          return entry;
+      }
+
+      // most of what we have is filtered out, walk all of it starting at a random spot
+      const auto start = pick(rng);
+      for (size_t n = 0; n < m_Dense.size(); ++n)
+      {
+        const auto* entry = m_Dense[(start + n) % m_Dense.size()];
+        if (visit(*entry))
+          return entry;
+      }
+
+      return nullptr;
+    }
 
    public:
     explicit NodeDB(fs::path rootdir, std::function<void(std::function<void()>)> diskCaller);
@@ -53,18 +171,31 @@ namespace llarp
     /// in memory nodedb
     NodeDB();
 
-    /// load all entries from disk syncrhonously
+    /// load all entries from disk syncrhonously, checking signatures on workers if we have them
     void
-    LoadFromDisk();
+    LoadFromDisk(thread::WorkPool* workers = nullptr);
 
     /// explicit save all RCs to disk synchronously
     void
-    SaveToDisk() const;
+    SaveToDisk();
 
     /// the number of RCs that are loaded from disk
     size_t
     NumLoaded() const;
 
+    /// signatures of rcs we have already checked, for skipping checking them again
+    RCVerifyCache&
+    VerifyCache()
+    {
+      return *m_VerifyCache;
+    }
+
+    const RCVerifyCache&
+    VerifyCache() const
+    {
+      return *m_VerifyCache;
+    }
+
     /// do periodic tasks like flush to disk and expiration
     void
     Tick(llarp_time_t now);
@@ -85,24 +216,27 @@ namespace llarp
     std::optional<RouterContact>
     Get(RouterID pk) const;
 
+    /// get a random rc that passes visit.  we sample at random first and only scan every entry
+    /// if that keeps getting rejected, so visit should not have side effects.
     template <typename Filter>
     std::optional<RouterContact>
     GetRandom(Filter visit) const
     {
       util::NullLock lock{m_Access};
+      if (const auto* entry = RandomEntry([&visit](const Entry& e) { return visit(e.rc); }))
+        return entry->rc;
+      return std::nullopt;
+    }
 
-      std::vector<const decltype(m_Entries)::value_type*> entries;
-      for (const auto& entry : m_Entries)
-        entries.push_back(&entry);
-
-      std::shuffle(entries.begin(), entries.end(), llarp::CSRNG{});
-
-      for (const auto entry : entries)
-      {
-        if (visit(entry->second.rc))
-          return entry->second.rc;
-      }
-
+    /// like GetRandom but visit is called with each candidate rc and its cached hop selection key
+    template <typename Filter>
+    std::optional<RouterContact>
+    GetRandomHop(Filter visit) const
+    {
+      util::NullLock lock{m_Access};
+      if (const auto* entry =
+              RandomEntry([&visit](const Entry& e) { return visit(e.rc, e.hopKey); }))
+        return entry->rc;
       return std::nullopt;
     }
 
@@ -141,20 +275,14 @@ namespace llarp
     RemoveIf(Filter visit)
     {
       util::NullLock lock{m_Access};
-      std::unordered_set<RouterID> removed;
       auto itr = m_Entries.begin();
       while (itr != m_Entries.end())
       {
         if (visit(itr->second.rc))
-        {
-          removed.insert(itr->second.rc.pubkey);
-          itr = m_Entries.erase(itr);
-        }
+          itr = Erase(itr);
         else
           ++itr;
       }
-      if (not removed.empty())
-        AsyncRemoveManyFromDisk(std::move(removed));
     }
 
     /// remove rcs that are not in keep and have been inserted before cutoff
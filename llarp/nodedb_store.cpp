@@ -0,0 +1,325 @@
+#include "nodedb_store.hpp"
+
+#include "util/buffer.hpp"
+#include "util/file.hpp"
+#include "util/logging.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace llarp
+{
+  static auto logcat = log::Cat("nodedb");
+
+  namespace
+  {
+    constexpr std::string_view Magic{"LLNODEDB"};
+    constexpr uint64_t FormatVersion = 1;
+    constexpr size_t HeaderSize = Magic.size() + 4;
+
+    enum RecordType : byte_t
+    {
+      PutRecord = 1,
+      RemoveRecord = 2,
+    };
+
+    /// type (1) and payload length (4) in front of the payload, checksum (8) after it
+    constexpr size_t RecordHeaderSize = 5;
+    constexpr size_t RecordOverhead = RecordHeaderSize + 8;
+
+    /// fnv-1a, enough to catch torn writes and bit rot, the rcs carry their own signatures
+    uint64_t
+    Checksum(const byte_t* data, size_t sz)
+    {
+      uint64_t hash = 0xcbf29ce484222325UL;
+      for (size_t idx = 0; idx < sz; ++idx)
+      {
+        hash ^= data[idx];
+        hash *= 0x100000001b3UL;
+      }
+      return hash;
+    }
+
+    void
+    PutLE(std::string& out, uint64_t val, size_t bytes)
+    {
+      for (size_t idx = 0; idx < bytes; ++idx)
+        out += static_cast<char>((val >> (idx * 8)) & 0xff);
+    }
+
+    uint64_t
+    GetLE(const byte_t* ptr, size_t bytes)
+    {
+      uint64_t val = 0;
+      for (size_t idx = 0; idx < bytes; ++idx)
+        val |= uint64_t{ptr[idx]} << (idx * 8);
+      return val;
+    }
+
+    void
+    AppendHeader(std::string& out)
+    {
+      out += Magic;
+      PutLE(out, FormatVersion, 4);
+    }
+
+    void
+    AppendRecord(std::string& out, RecordType type, const byte_t* data, size_t sz)
+    {
+      const auto start = out.size();
+      out += static_cast<char>(type);
+      PutLE(out, sz, 4);
+      out.append(reinterpret_cast<const char*>(data), sz);
+      const auto* record = reinterpret_cast<const byte_t*>(out.data()) + start;
+      PutLE(out, Checksum(record, out.size() - start), 8);
+    }
+
+    bool
+    AppendPut(std::string& out, const RouterContact& rc)
+    {
+      std::array<byte_t, MAX_RC_SIZE> tmp;
+      llarp_buffer_t buf{tmp};
+      if (not rc.BEncode(&buf))
+      {
+        log::warning(logcat, "failed to encode rc {} for the nodedb", RouterID{rc.pubkey});
+        return false;
+      }
+      AppendRecord(out, PutRecord, tmp.data(), buf.cur - buf.base);
+      return true;
+    }
+
+    /// the whole file in memory, mapped where we can and read in where we cannot
+    class FileView
+    {
+     public:
+      explicit FileView(const fs::path& file)
+      {
+#ifdef _WIN32
+        m_Contents = util::slurp_file(file);
+        m_Data = reinterpret_cast<byte_t*>(m_Contents.data());
+        m_Size = m_Contents.size();
+#else
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd == -1)
+          throw std::runtime_error{fmt::format("cannot open {}: {}", file, strerror(errno))};
+        struct stat st;
+        if (::fstat(fd, &st) == 0 and st.st_size > 0)
+        {
+          // private and writable so the bdecoder can have mutable buffers, nothing goes back to
+          // the file
+          auto* ptr = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+          if (ptr != MAP_FAILED)
+          {
+            ::madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+            m_Data = static_cast<byte_t*>(ptr);
+            m_Size = st.st_size;
+          }
+        }
+        ::close(fd);
+        if (st.st_size > 0 and not m_Data)
+          throw std::runtime_error{fmt::format("cannot map {}: {}", file, strerror(errno))};
+#endif
+      }
+
+      ~FileView()
+      {
+#ifndef _WIN32
+        if (m_Data)
+          ::munmap(m_Data, m_Size);
+#endif
+      }
+
+      FileView(const FileView&) = delete;
+      FileView&
+      operator=(const FileView&) = delete;
+
+      byte_t*
+      data() const
+      {
+        return m_Data;
+      }
+
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+     private:
+#ifdef _WIN32
+      std::string m_Contents;
+#endif
+      byte_t* m_Data = nullptr;
+      size_t m_Size = 0;
+    };
+  }  // namespace
+
+  NodeDBStore::NodeDBStore(fs::path file) : m_File{std::move(file)}
+  {}
+
+  bool
+  NodeDBStore::Exists() const
+  {
+    std::error_code ec;
+    return fs::exists(m_File, ec);
+  }
+
+  std::optional<size_t>
+  NodeDBStore::Load(std::unordered_map<RouterID, RouterContact>& rcs)
+  {
+    std::lock_guard lock{m_Mutex};
+    if (not Exists())
+      return std::nullopt;
+    size_t records = 0;
+    size_t good = HeaderSize;
+    size_t total = 0;
+    try
+    {
+      FileView view{m_File};
+      const auto* data = view.data();
+      total = view.size();
+      if (total < HeaderSize or std::memcmp(data, Magic.data(), Magic.size()) != 0
+          or GetLE(data + Magic.size(), 4) != FormatVersion)
+        return std::nullopt;
+
+      while (good + RecordOverhead <= total)
+      {
+        auto* record = view.data() + good;
+        const auto len = GetLE(record + 1, 4);
+        if (len > total - good - RecordOverhead)
+          break;
+        auto* payload = record + RecordHeaderSize;
+        if (Checksum(record, RecordHeaderSize + len) != GetLE(payload + len, 8))
+          break;
+
+        if (record[0] == PutRecord)
+        {
+          RouterContact rc{};
+          llarp_buffer_t buf{payload, len};
+          if (rc.BDecode(&buf))
+          {
+            const RouterID pk{rc.pubkey};
+            rcs.insert_or_assign(pk, std::move(rc));
+          }
+          else
+            log::warning(logcat, "skipping undecodable rc in {}", m_File);
+        }
+        else if (record[0] == RemoveRecord and len == RouterID::SIZE)
+          rcs.erase(RouterID{payload});
+        else
+          break;
+
+        good += RecordOverhead + len;
+        ++records;
+      }
+    }
+    catch (const std::exception& ex)
+    {
+      log::error(logcat, "failed to read {}: {}", m_File, ex.what());
+      return std::nullopt;
+    }
+    m_Records = records;
+
+    if (good < total)
+    {
+      // most likely we went down halfway through an append, keep what was whole
+      log::warning(
+          logcat, "dropping {} bytes of damaged records from the end of {}", total - good, m_File);
+      std::error_code ec;
+      fs::resize_file(m_File, good, ec);
+      if (ec)
+        log::error(logcat, "failed to truncate {}: {}", m_File, ec.message());
+    }
+    return records;
+  }
+
+  bool
+  NodeDBStore::Append(const std::vector<RouterContact>& puts, const std::vector<RouterID>& removes)
+  {
+    std::string records;
+    for (const auto& rc : puts)
+      AppendPut(records, rc);
+    for (const auto& pk : removes)
+      AppendRecord(records, RemoveRecord, pk.data(), pk.size());
+
+    std::lock_guard lock{m_Mutex};
+    // how long the log was before we started, nullopt if there was none
+    std::optional<uintmax_t> before;
+    if (Exists())
+    {
+      std::error_code ec;
+      before = fs::file_size(m_File, ec);
+      if (ec)
+      {
+        log::error(logcat, "failed to append to {}: {}", m_File, ec.message());
+        return false;
+      }
+    }
+    try
+    {
+      std::string header;
+      if (not before)
+        AppendHeader(header);
+      std::ofstream out{m_File, std::ios::binary | std::ios::app};
+      out.write(header.data(), header.size());
+      out.write(records.data(), records.size());
+      out.flush();
+      if (not out)
+        throw std::runtime_error{"write failed"};
+    }
+    catch (const std::exception& ex)
+    {
+      log::error(logcat, "failed to append to {}: {}", m_File, ex.what());
+      // a torn record would end the log on the next load and take every later append with it
+      std::error_code ec;
+      if (before)
+        fs::resize_file(m_File, *before, ec);
+      else
+        fs::remove(m_File, ec);
+      if (ec)
+        log::error(logcat, "failed to roll back {}: {}", m_File, ec.message());
+      return false;
+    }
+    m_Records += puts.size() + removes.size();
+    return true;
+  }
+
+  bool
+  NodeDBStore::Rewrite(const std::vector<RouterContact>& rcs)
+  {
+    std::string contents;
+    AppendHeader(contents);
+    for (const auto& rc : rcs)
+      AppendPut(contents, rc);
+
+    std::lock_guard lock{m_Mutex};
+    try
+    {
+      util::replace_file(m_File, contents);
+    }
+    catch (const std::exception& ex)
+    {
+      log::error(logcat, "failed to rewrite {}: {}", m_File, ex.what());
+      return false;
+    }
+    m_Records = rcs.size();
+    return true;
+  }
+
+  size_t
+  NodeDBStore::Records() const
+  {
+    std::lock_guard lock{m_Mutex};
+    return m_Records;
+  }
+}  // namespace llarp
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "router_contact.hpp"
+#include "router_id.hpp"
+#include "util/fs.hpp"
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp
+{
+  /// the single file the nodedb keeps its rcs in on disk.  the file is a log of records, each
+  /// either putting a bencoded rc or removing one by pubkey and each carrying a checksum.  changes
+  /// are appended to the end and the log is rewritten from scratch now and then to drop records
+  /// that were superseded.  loading is one sequential pass over the mapped file.
+  ///
+  /// writes can come from any thread, they are serialized on a mutex.
+  class NodeDBStore
+  {
+   public:
+    /// the name of the file inside the nodedb directory
+    static constexpr auto FileName = "nodedb.dat";
+
+    explicit NodeDBStore(fs::path file);
+
+    const fs::path&
+    File() const
+    {
+      return m_File;
+    }
+
+    bool
+    Exists() const;
+
+    /// read the log, leaving every rc that is still live in rcs.  a record that is cut short or
+    /// fails its checksum ends the log, it and anything after it is cut off the file.  returns the
+    /// number of good records read, or nullopt if the file is not a nodedb log at all.
+    std::optional<size_t>
+    Load(std::unordered_map<RouterID, RouterContact>& rcs);
+
+    /// append records putting each rc in puts and removing each pubkey in removes
+    bool
+    Append(const std::vector<RouterContact>& puts, const std::vector<RouterID>& removes);
+
+    /// replace the whole log with one record per rc.  the new log is written next to the old one,
+    /// synced and moved over it so we never leave a half written log behind.
+    bool
+    Rewrite(const std::vector<RouterContact>& rcs);
+
+    /// how many records the log holds, live or superseded, as of the last successful load or
+    /// write
+    size_t
+    Records() const;
+
+   private:
+    const fs::path m_File;
+    mutable std::mutex m_Mutex;
+    size_t m_Records = 0;
+  };
+}  // namespace llarp
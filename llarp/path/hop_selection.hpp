@@ -0,0 +1,38 @@
+#pragma once
+
+#include <llarp/constants/path.hpp>
+#include <llarp/net/ip.hpp>
+#include <llarp/net/net_int.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/router_id.hpp>
+
+#include <array>
+
+namespace llarp::path
+{
+  /// the parts of an rc that picking hops for a path looks at.  the nodedb keeps one of these for
+  /// every rc so checking a candidate hop never has to copy an rc or allocate.
+  struct HopSelectionKey
+  {
+    /// how many of an rc's addresses we look at, relays only ever publish one
+    static constexpr size_t MaxAddrs = 4;
+
+    RouterID pubkey;
+    /// the rc's public addresses as ipv6, masking them down to a netblock is left to whoever
+    /// knows the netmask
+    std::array<huint128_t, MaxAddrs> addrs{};
+    size_t numAddrs = 0;
+
+    HopSelectionKey() = default;
+
+    explicit HopSelectionKey(const RouterContact& rc) : pubkey{rc.pubkey}
+    {
+      for (const auto& addr : rc.addrs)
+      {
+        if (numAddrs == MaxAddrs)
+          break;
+        addrs[numAddrs++] = net::In6ToHUInt(addr.ip);
+      }
+    }
+  };
+}  // namespace llarp::path
@@ -9,10 +9,10 @@ namespace llarp
     bool
     IHopHandler::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      auto& pkt = m_UpstreamQueue.emplace_back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+      if (m_UpstreamQueue.full())
+        FlushUpstream(r);
+      if (not m_UpstreamQueue.Push(X, Y))
+        return false;
       r->TriggerPump();
       return true;
     }
@@ -21,10 +21,10 @@ namespace llarp
     bool
     IHopHandler::HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      auto& pkt = m_DownstreamQueue.emplace_back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+      if (m_DownstreamQueue.full())
+        FlushDownstream(r);
+      if (not m_DownstreamQueue.Push(X, Y))
+        return false;
       r->TriggerPump();
       return true;
     }
@@ -5,6 +5,7 @@
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/util/decaying_hashset.hpp>
 #include <llarp/messages/relay.hpp>
+#include "traffic_batch.hpp"
 #include <vector>
 
 #include <memory>
@@ -24,8 +25,8 @@ namespace llarp
   {
     struct IHopHandler
     {
-      using TrafficEvent_t = std::pair<std::vector<byte_t>, TunnelNonce>;
-      using TrafficQueue_t = std::list<TrafficEvent_t>;
+      using UpstreamBatch_t = TrafficBatch<RelayUpstreamMessage>;
+      using DownstreamBatch_t = TrafficBatch<RelayDownstreamMessage>;
 
       virtual ~IHopHandler() = default;
 
@@ -73,21 +74,21 @@ namespace llarp
 
      protected:
       uint64_t m_SequenceNum = 0;
-      TrafficQueue_t m_UpstreamQueue;
-      TrafficQueue_t m_DownstreamQueue;
+      UpstreamBatch_t m_UpstreamQueue;
+      DownstreamBatch_t m_DownstreamQueue;
       util::DecayingHashSet<TunnelNonce> m_UpstreamReplayFilter;
       util::DecayingHashSet<TunnelNonce> m_DownstreamReplayFilter;
 
       virtual void
-      UpstreamWork(TrafficQueue_t queue, AbstractRouter* r) = 0;
+      UpstreamWork(UpstreamBatch_t batch, AbstractRouter* r) = 0;
 
       virtual void
-      DownstreamWork(TrafficQueue_t queue, AbstractRouter* r) = 0;
+      DownstreamWork(DownstreamBatch_t batch, AbstractRouter* r) = 0;
 
       virtual void
-      HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r) = 0;
+      HandleAllUpstream(UpstreamBatch_t msgs, AbstractRouter* r) = 0;
       virtual void
-      HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) = 0;
+      HandleAllDownstream(DownstreamBatch_t msgs, AbstractRouter* r) = 0;
     };
 
     using HopHandler_ptr = std::shared_ptr<IHopHandler>;
@@ -486,7 +486,7 @@ namespace llarp
     }
 
     void
-    Path::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
+    Path::HandleAllUpstream(UpstreamBatch_t msgs, AbstractRouter* r)
     {
       for (const auto& msg : msgs)
       {
@@ -503,28 +503,22 @@ namespace llarp
     }
 
     void
-    Path::UpstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
+    Path::UpstreamWork(UpstreamBatch_t batch, AbstractRouter* r)
     {
-      std::vector<RelayUpstreamMessage> sendmsgs(msgs.size());
-      size_t idx = 0;
-      for (auto& ev : msgs)
+      auto items = batch.CryptItems();
+      // onion the whole batch one hop at a time so each hop's key crypts as many buffers at once
+      // as we have
+      for (const auto& hop : hops)
       {
-        const llarp_buffer_t buf(ev.first);
-        TunnelNonce n = ev.second;
-        for (const auto& hop : hops)
-        {
-          CryptoManager::instance()->xchacha20(buf, hop.shared, n);
-          n ^= hop.nonceXOR;
-        }
-        auto& msg = sendmsgs[idx];
-        msg.X = buf;
-        msg.Y = ev.second;
-        msg.pathid = TXID();
-        ++idx;
+        CryptoManager::instance()->xchacha20_batch(hop.shared, items.data(), batch.size());
+        for (size_t idx = 0; idx < batch.size(); ++idx)
+          items[idx].nonce ^= hop.nonceXOR;
       }
-      r->loop()->call([self = shared_from_this(), data = std::move(sendmsgs), r]() mutable {
-        self->HandleAllUpstream(std::move(data), r);
-      });
+      for (auto& msg : batch)
+        msg.pathid = TXID();
+      r->loop()->call([self = shared_from_this(),
+                       data = BatchHandoff{std::move(batch)},
+                       r]() mutable { self->HandleAllUpstream(data.Take(), r); });
     }
 
     void
@@ -533,8 +527,8 @@ namespace llarp
       if (not m_UpstreamQueue.empty())
       {
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+                      data = BatchHandoff{std::move(m_UpstreamQueue)},
+                      r]() mutable { self->UpstreamWork(data.Take(), r); });
       }
     }
 
@@ -544,8 +538,8 @@ namespace llarp
       if (not m_DownstreamQueue.empty())
       {
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+                      data = BatchHandoff{std::move(m_DownstreamQueue)},
+                      r]() mutable { self->DownstreamWork(data.Take(), r); });
       }
     }
 
@@ -577,29 +571,22 @@ namespace llarp
     }
 
     void
-    Path::DownstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
+    Path::DownstreamWork(DownstreamBatch_t batch, AbstractRouter* r)
     {
-      std::vector<RelayDownstreamMessage> sendMsgs(msgs.size());
-      size_t idx = 0;
-      for (auto& ev : msgs)
+      for (const auto& hop : hops)
       {
-        const llarp_buffer_t buf(ev.first);
-        sendMsgs[idx].Y = ev.second;
-        for (const auto& hop : hops)
-        {
-          sendMsgs[idx].Y ^= hop.nonceXOR;
-          CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
-        }
-        sendMsgs[idx].X = buf;
-        ++idx;
+        for (auto& msg : batch)
+          msg.Y ^= hop.nonceXOR;
+        const auto items = batch.CryptItems();
+        CryptoManager::instance()->xchacha20_batch(hop.shared, items.data(), batch.size());
       }
-      r->loop()->call([self = shared_from_this(), msgs = std::move(sendMsgs), r]() mutable {
-        self->HandleAllDownstream(std::move(msgs), r);
-      });
+      r->loop()->call([self = shared_from_this(),
+                       data = BatchHandoff{std::move(batch)},
+                       r]() mutable { self->HandleAllDownstream(data.Take(), r); });
     }
 
     void
-    Path::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
+    Path::HandleAllDownstream(DownstreamBatch_t msgs, AbstractRouter* r)
     {
       for (const auto& msg : msgs)
       {
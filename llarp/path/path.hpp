@@ -388,16 +388,16 @@ namespace llarp
 
      protected:
       void
-      UpstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
+      UpstreamWork(UpstreamBatch_t batch, AbstractRouter* r) override;
 
       void
-      DownstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
+      DownstreamWork(DownstreamBatch_t batch, AbstractRouter* r) override;
 
       void
-      HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllUpstream(UpstreamBatch_t msgs, AbstractRouter* r) override;
 
       void
-      HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllDownstream(DownstreamBatch_t msgs, AbstractRouter* r) override;
 
      private:
       bool
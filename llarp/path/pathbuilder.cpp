@@ -12,6 +12,7 @@
 #include <llarp/tooling/path_event.hpp>
 #include <llarp/link/link_manager.hpp>
 
+#include <array>
 #include <functional>
 
 namespace llarp
@@ -346,7 +347,7 @@ namespace llarp
     std::optional<std::vector<RouterContact>>
     Builder::GetHopsAlignedToForBuild(RouterID endpoint, const std::set<RouterID>& exclude)
     {
-      const auto pathConfig = m_router->GetConfig()->paths;
+      const auto& pathConfig = m_router->GetConfig()->paths;
 
       std::vector<RouterContact> hops;
       {
@@ -367,6 +368,12 @@ namespace llarp
       else
         return std::nullopt;
 
+      // the endpoint and every hop we picked so far, candidates are checked against these
+      std::array<HopSelectionKey, max_len + 1> picked;
+      size_t numPicked = 0;
+      picked[numPicked++] = HopSelectionKey{endpointRC};
+      picked[numPicked++] = HopSelectionKey{hops.front()};
+
       for (size_t idx = hops.size(); idx < numHops; ++idx)
       {
         if (idx + 1 == numHops)
@@ -375,33 +382,32 @@ namespace llarp
         }
         else
         {
-          auto filter =
-              [&hops, r = m_router, endpointRC, pathConfig, exclude](const auto& rc) -> bool {
-            if (exclude.count(rc.pubkey))
+          auto filter = [&picked, numPicked, r = m_router, &pathConfig, &exclude](
+                            const auto&, const HopSelectionKey& key) -> bool {
+            if (exclude.count(key.pubkey))
               return false;
 
-            std::set<RouterContact> hopsSet;
-            hopsSet.insert(endpointRC);
-            hopsSet.insert(hops.begin(), hops.end());
-
-            if (r->routerProfiling().IsBadForPath(rc.pubkey, 1))
-              return false;
-            for (const auto& hop : hopsSet)
+            for (size_t n = 0; n < numPicked; ++n)
             {
-              if (hop.pubkey == rc.pubkey)
+              if (picked[n].pubkey == key.pubkey)
                 return false;
             }
 
-            hopsSet.insert(rc);
+            if (r->routerProfiling().IsBadForPath(key.pubkey, 1))
+              return false;
 #ifndef TESTNET
-            if (not pathConfig.Acceptable(hopsSet))
+            if (not pathConfig.Acceptable(key, picked.data(), numPicked))
               return false;
 #endif
-            return rc.pubkey != endpointRC.pubkey;
+            return true;
           };
 
-          if (const auto maybe = m_router->nodedb()->GetRandom(filter))
+          if (const auto maybe = m_router->nodedb()->GetRandomHop(filter))
+          {
             hops.emplace_back(*maybe);
+            if (numPicked < picked.size())
+              picked[numPicked++] = HopSelectionKey{*maybe};
+          }
           else
             return std::nullopt;
         }
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/types.hpp>
+#include <llarp/util/buffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace llarp::path
+{
+  /// a batch of relay messages for one hop.  traffic is copied into a message slot once when it
+  /// arrives, crypted in place by a worker and sent straight from the slot.  slots come one at a
+  /// time from a free list shared by every hop and go back on it when the batch is done with, so
+  /// once we are warmed up relaying traffic does not touch the heap and an idle hop holds none.
+  template <typename Msg_t>
+  class TrafficBatch
+  {
+   public:
+    /// how many messages fit in one batch
+    static constexpr size_t Capacity = 32;
+
+    /// how many unused message slots we keep around for reuse across all hops
+    static constexpr size_t MaxFree = 256;
+
+    using CryptItems_t = std::array<CryptBatchItem, Capacity>;
+
+    /// walks the messages in a batch
+    template <typename T>
+    class Iterator
+    {
+     public:
+      explicit Iterator(Msg_t* const* slot) : m_Slot{slot}
+      {}
+
+      T&
+      operator*() const
+      {
+        return **m_Slot;
+      }
+
+      T*
+      operator->() const
+      {
+        return *m_Slot;
+      }
+
+      Iterator&
+      operator++()
+      {
+        ++m_Slot;
+        return *this;
+      }
+
+      bool
+      operator==(const Iterator& other) const
+      {
+        return m_Slot == other.m_Slot;
+      }
+
+      bool
+      operator!=(const Iterator& other) const
+      {
+        return m_Slot != other.m_Slot;
+      }
+
+     private:
+      Msg_t* const* m_Slot;
+    };
+
+    TrafficBatch() = default;
+
+    TrafficBatch(TrafficBatch&& other) noexcept
+        : m_Slots{other.m_Slots}, m_Size{std::exchange(other.m_Size, 0)}
+    {}
+
+    TrafficBatch&
+    operator=(TrafficBatch&& other) noexcept
+    {
+      if (this != &other)
+      {
+        Release();
+        m_Slots = other.m_Slots;
+        m_Size = std::exchange(other.m_Size, 0);
+      }
+      return *this;
+    }
+
+    TrafficBatch(const TrafficBatch&) = delete;
+    TrafficBatch&
+    operator=(const TrafficBatch&) = delete;
+
+    ~TrafficBatch()
+    {
+      Release();
+    }
+
+    bool
+    empty() const
+    {
+      return m_Size == 0;
+    }
+
+    bool
+    full() const
+    {
+      return m_Size == Capacity;
+    }
+
+    size_t
+    size() const
+    {
+      return m_Size;
+    }
+
+    /// copy X and Y into the next free slot, fails if we are full or X does not fit in a message
+    bool
+    Push(const llarp_buffer_t& X, const TunnelNonce& Y)
+    {
+      if (full())
+        return false;
+      auto* msg = Acquire();
+      msg->X = X;
+      if (msg->X.size() != X.sz)
+      {
+        Release(msg);
+        return false;
+      }
+      msg->Y = Y;
+      m_Slots[m_Size++] = msg;
+      return true;
+    }
+
+    Iterator<Msg_t>
+    begin()
+    {
+      return Iterator<Msg_t>{m_Slots.data()};
+    }
+
+    Iterator<Msg_t>
+    end()
+    {
+      return Iterator<Msg_t>{m_Slots.data() + m_Size};
+    }
+
+    Iterator<const Msg_t>
+    begin() const
+    {
+      return Iterator<const Msg_t>{m_Slots.data()};
+    }
+
+    Iterator<const Msg_t>
+    end() const
+    {
+      return Iterator<const Msg_t>{m_Slots.data() + m_Size};
+    }
+
+    /// items that crypt each message's X in place using its Y as the nonce, the first size() of
+    /// them are valid
+    CryptItems_t
+    CryptItems()
+    {
+      CryptItems_t items;
+      for (size_t idx = 0; idx < m_Size; ++idx)
+      {
+        auto& msg = *m_Slots[idx];
+        items[idx] = CryptBatchItem{msg.X.data(), msg.X.size(), msg.Y};
+      }
+      return items;
+    }
+
+    /// how many unused slots are waiting for reuse right now
+    static size_t
+    FreeSlots()
+    {
+      auto& free = Free();
+      std::lock_guard lock{free.mutex};
+      return free.slots.size();
+    }
+
+   private:
+    struct FreeList
+    {
+      FreeList()
+      {
+        slots.reserve(MaxFree);
+      }
+
+      std::mutex mutex;
+      std::vector<std::unique_ptr<Msg_t>> slots;
+    };
+
+    static FreeList&
+    Free()
+    {
+      // leaked on purpose so batches that outlive static destruction can still give slots back
+      static auto* free = new FreeList{};
+      return *free;
+    }
+
+    /// a slot from the free list, or a new one if it is empty.  reused slots are handed out as
+    /// they were left since Push overwrites everything we send.
+    static Msg_t*
+    Acquire()
+    {
+      auto& free = Free();
+      {
+        std::lock_guard lock{free.mutex};
+        if (not free.slots.empty())
+        {
+          auto* slot = free.slots.back().release();
+          free.slots.pop_back();
+          return slot;
+        }
+      }
+      return new Msg_t;
+    }
+
+    static void
+    Release(Msg_t* msg)
+    {
+      std::unique_ptr<Msg_t> slot{msg};
+      auto& free = Free();
+      std::lock_guard lock{free.mutex};
+      if (free.slots.size() < MaxFree)
+        free.slots.push_back(std::move(slot));
+    }
+
+    void
+    Release()
+    {
+      if (m_Size == 0)
+        return;
+      auto& free = Free();
+      std::lock_guard lock{free.mutex};
+      for (size_t idx = 0; idx < m_Size; ++idx)
+      {
+        std::unique_ptr<Msg_t> slot{m_Slots[idx]};
+        if (free.slots.size() < MaxFree)
+          free.slots.push_back(std::move(slot));
+      }
+      m_Size = 0;
+    }
+
+    std::array<Msg_t*, Capacity> m_Slots;
+    size_t m_Size = 0;
+  };
+
+  /// carries a batch from the event loop to a worker and back.  QueueWork and loop()->call take a
+  /// std::function, which has to be copyable, so the batch waits in a holder that copies share.
+  /// holders are recycled the same way message slots are so a handoff does not touch the heap.
+  template <typename Batch_t>
+  class BatchHandoff
+  {
+   public:
+    /// how many unused holders we keep around for reuse
+    static constexpr size_t MaxFree = 64;
+
+    explicit BatchHandoff(Batch_t batch) : m_Holder{Acquire()}
+    {
+      m_Holder->batch = std::move(batch);
+    }
+
+    BatchHandoff(const BatchHandoff& other) : m_Holder{other.m_Holder}
+    {
+      if (m_Holder)
+        m_Holder->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    BatchHandoff(BatchHandoff&& other) noexcept : m_Holder{std::exchange(other.m_Holder, nullptr)}
+    {}
+
+    BatchHandoff&
+    operator=(const BatchHandoff&) = delete;
+    BatchHandoff&
+    operator=(BatchHandoff&&) = delete;
+
+    ~BatchHandoff()
+    {
+      if (m_Holder and m_Holder->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        Release(m_Holder);
+    }
+
+    /// move the batch out, it is empty for anyone sharing the holder after this
+    Batch_t
+    Take()
+    {
+      return std::move(m_Holder->batch);
+    }
+
+    /// how many unused holders are waiting for reuse right now
+    static size_t
+    FreeHolders()
+    {
+      auto& free = Free();
+      std::lock_guard lock{free.mutex};
+      return free.holders.size();
+    }
+
+   private:
+    struct Holder
+    {
+      Batch_t batch;
+      std::atomic<size_t> refs{0};
+    };
+
+    struct FreeList
+    {
+      FreeList()
+      {
+        holders.reserve(MaxFree);
+      }
+
+      std::mutex mutex;
+      std::vector<std::unique_ptr<Holder>> holders;
+    };
+
+    static FreeList&
+    Free()
+    {
+      // leaked for the same reason as the slot free list
+      static auto* free = new FreeList{};
+      return *free;
+    }
+
+    static Holder*
+    Acquire()
+    {
+      Holder* holder = nullptr;
+      {
+        auto& free = Free();
+        std::lock_guard lock{free.mutex};
+        if (not free.holders.empty())
+        {
+          holder = free.holders.back().release();
+          free.holders.pop_back();
+        }
+      }
+      if (holder == nullptr)
+        holder = new Holder;
+      holder->refs.store(1, std::memory_order_relaxed);
+      return holder;
+    }
+
+    /// a job that never ran still gives its messages back before we park the holder
+    static void
+    Release(Holder* holder)
+    {
+      std::unique_ptr<Holder> owned{holder};
+      owned->batch = Batch_t{};
+      auto& free = Free();
+      std::lock_guard lock{free.mutex};
+      if (free.holders.size() < MaxFree)
+        free.holders.push_back(std::move(owned));
+    }
+
+    Holder* m_Holder;
+  };
+}  // namespace llarp::path
@@ -32,16 +32,8 @@ namespace llarp
           downstream);
     }
 
-    TransitHop::TransitHop()
-        : IHopHandler{}
-        , m_UpstreamGather{transit_hop_queue_size}
-        , m_DownstreamGather{transit_hop_queue_size}
-    {
-      m_UpstreamGather.enable();
-      m_DownstreamGather.enable();
-      m_UpstreamWorkCounter = 0;
-      m_DownstreamWorkCounter = 0;
-    }
+    TransitHop::TransitHop() : IHopHandler{}
+    {}
 
     bool
     TransitHop::Expired(llarp_time_t now) const
@@ -106,70 +98,40 @@ namespace llarp
     }
 
     void
-    TransitHop::DownstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
+    TransitHop::DownstreamWork(DownstreamBatch_t batch, AbstractRouter* r)
     {
-      auto flushIt = [self = shared_from_this(), r]() {
-        std::vector<RelayDownstreamMessage> msgs;
-        while (auto maybe = self->m_DownstreamGather.tryPopFront())
-        {
-          msgs.push_back(*maybe);
-        }
-        self->HandleAllDownstream(std::move(msgs), r);
-      };
-      for (auto& ev : msgs)
+      const auto items = batch.CryptItems();
+      CryptoManager::instance()->xchacha20_batch(pathKey, items.data(), batch.size());
+      for (auto& msg : batch)
       {
-        RelayDownstreamMessage msg;
-        const llarp_buffer_t buf(ev.first);
         msg.pathid = info.rxID;
-        msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.X = buf;
-        llarp::LogDebug(
-            "relay ",
-            msg.X.size(),
-            " bytes downstream from ",
-            info.upstream,
-            " to ",
-            info.downstream);
-        if (m_DownstreamGather.full())
-        {
-          r->loop()->call(flushIt);
-        }
-        if (m_DownstreamGather.enabled())
-          m_DownstreamGather.pushBack(msg);
+        msg.Y ^= nonceXOR;
       }
-      r->loop()->call(flushIt);
+      r->loop()->call([self = shared_from_this(),
+                       data = BatchHandoff{std::move(batch)},
+                       r]() mutable { self->HandleAllDownstream(data.Take(), r); });
     }
 
     void
-    TransitHop::UpstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
+    TransitHop::UpstreamWork(UpstreamBatch_t batch, AbstractRouter* r)
     {
-      for (auto& ev : msgs)
+      const auto items = batch.CryptItems();
+      CryptoManager::instance()->xchacha20_batch(pathKey, items.data(), batch.size());
+      for (auto& msg : batch)
       {
-        const llarp_buffer_t buf(ev.first);
-        RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
         msg.pathid = info.txID;
-        msg.Y = ev.second ^ nonceXOR;
-        msg.X = buf;
-        if (m_UpstreamGather.tryPushBack(msg) != thread::QueueReturn::Success)
-          break;
+        msg.Y ^= nonceXOR;
       }
-
-      // Flush it:
-      r->loop()->call([self = shared_from_this(), r] {
-        std::vector<RelayUpstreamMessage> msgs;
-        while (auto maybe = self->m_UpstreamGather.tryPopFront())
-        {
-          msgs.push_back(*maybe);
-        }
-        self->HandleAllUpstream(std::move(msgs), r);
-      });
+      r->loop()->call([self = shared_from_this(),
+                       data = BatchHandoff{std::move(batch)},
+                       r]() mutable { self->HandleAllUpstream(data.Take(), r); });
     }
 
     void
-    TransitHop::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
+    TransitHop::HandleAllUpstream(UpstreamBatch_t msgs, AbstractRouter* r)
     {
+      if (m_Stopped)
+        return;
       if (IsEndpoint(r->pubkey()))
       {
         for (const auto& msg : msgs)
@@ -206,8 +168,10 @@ namespace llarp
     }
 
     void
-    TransitHop::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
+    TransitHop::HandleAllDownstream(DownstreamBatch_t msgs, AbstractRouter* r)
     {
+      if (m_Stopped)
+        return;
       for (const auto& msg : msgs)
       {
         llarp::LogDebug(
@@ -228,8 +192,8 @@ namespace llarp
       if (not m_UpstreamQueue.empty())
       {
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+                      data = BatchHandoff{std::move(m_UpstreamQueue)},
+                      r]() mutable { self->UpstreamWork(data.Take(), r); });
       }
     }
 
@@ -239,8 +203,8 @@ namespace llarp
       if (not m_DownstreamQueue.empty())
       {
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+                      data = BatchHandoff{std::move(m_DownstreamQueue)},
+                      r]() mutable { self->DownstreamWork(data.Take(), r); });
       }
     }
 
@@ -401,7 +365,7 @@ namespace llarp
           auto counter = oxenc::load_big_to_host<uint64_t>(pkt.data());
           llarp_buffer_t buf{pkt.data() + 8, pkt.size() - 8};
           sent =
-              endpoint->QueueOutboundTraffic(info.rxID, buf.copy(), counter, msg.protocol) and sent;
+              endpoint->QueueOutboundTraffic(info.rxID, buf, counter, msg.protocol) and sent;
         }
         return sent;
       }
@@ -441,8 +405,7 @@ namespace llarp
     void
     TransitHop::Stop()
     {
-      m_UpstreamGather.disable();
-      m_DownstreamGather.disable();
+      m_Stopped = true;
     }
 
     void
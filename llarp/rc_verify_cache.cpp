@@ -0,0 +1,229 @@
+#include "rc_verify_cache.hpp"
+
+#include "crypto/crypto.hpp"
+#include "router_contact.hpp"
+#include "util/buffer.hpp"
+#include "util/file.hpp"
+#include "util/logging.hpp"
+#include "util/thread/work_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+
+namespace llarp
+{
+  static auto logcat = log::Cat("nodedb");
+
+  RCVerifyCache::RCVerifyCache(size_t capacity) : m_Capacity{std::max<size_t>(capacity, 1)}
+  {}
+
+  std::optional<RCVerifyCache::Digest_t>
+  RCVerifyCache::MakeDigest(const RouterContact& rc)
+  {
+    std::array<byte_t, MAX_RC_SIZE> tmp;
+    llarp_buffer_t buf{tmp};
+    if (not rc.BEncode(&buf))
+      return std::nullopt;
+    buf.sz = buf.cur - buf.base;
+    buf.cur = buf.base;
+    Digest_t digest;
+    if (not CryptoManager::instance()->shorthash(digest, buf))
+      return std::nullopt;
+    return digest;
+  }
+
+  bool
+  RCVerifyCache::VerifySignature(const RouterContact& rc)
+  {
+    const auto digest = MakeDigest(rc);
+    if (digest)
+    {
+      std::lock_guard lock{m_Mutex};
+      if (m_Digests.count(*digest))
+      {
+        m_Hits++;
+        return true;
+      }
+      m_Misses++;
+    }
+
+    if (not rc.VerifySignature())
+      return false;
+
+    if (digest)
+      Add(*digest);
+    return true;
+  }
+
+  std::vector<bool>
+  RCVerifyCache::VerifyMany(
+      const std::vector<const RouterContact*>& rcs, thread::WorkPool* workers)
+  {
+    std::vector<bool> good(rcs.size(), true);
+    std::vector<std::optional<Digest_t>> digests;
+    digests.reserve(rcs.size());
+    for (const auto* rc : rcs)
+      digests.emplace_back(MakeDigest(*rc));
+
+    // what we have to check for real
+    std::vector<size_t> misses;
+    {
+      std::lock_guard lock{m_Mutex};
+      for (size_t idx = 0; idx < rcs.size(); ++idx)
+      {
+        if (digests[idx] and m_Digests.count(*digests[idx]))
+          m_Hits++;
+        else
+          misses.push_back(idx);
+      }
+      m_Misses += misses.size();
+    }
+
+    // std::vector<bool> packs bits so the workers write to their own array instead
+    std::unique_ptr<bool[]> results{new bool[misses.size()]};
+    auto verify = [&](size_t begin, size_t end) {
+      for (size_t n = begin; n < end; ++n)
+        results[n] = rcs[misses[n]]->VerifySignature();
+    };
+
+    size_t chunks = 1;
+    if (workers and misses.size() >= ParallelThreshold)
+      chunks = std::clamp<size_t>(workers->NumThreads() + 1, 1, misses.size() / ParallelThreshold);
+    const size_t chunk = misses.size() / chunks;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t pending = 0;
+    for (size_t n = 1; n < chunks; ++n)
+    {
+      const auto begin = n * chunk;
+      const auto end = n + 1 == chunks ? misses.size() : (n + 1) * chunk;
+      auto job = [&, begin, end]() {
+        verify(begin, end);
+        std::lock_guard lock{mutex};
+        if (--pending == 0)
+          cond.notify_one();
+      };
+      {
+        std::lock_guard lock{mutex};
+        ++pending;
+      }
+      if (not workers->TrySubmit(job))
+        job();
+    }
+    // we take the first chunk ourselves
+    verify(0, chunks == 1 ? misses.size() : chunk);
+    {
+      std::unique_lock lock{mutex};
+      cond.wait(lock, [&pending] { return pending == 0; });
+    }
+
+    std::lock_guard lock{m_Mutex};
+    for (size_t n = 0; n < misses.size(); ++n)
+    {
+      const auto idx = misses[n];
+      good[idx] = results[n];
+      if (results[n] and digests[idx])
+        AddLocked(*digests[idx]);
+    }
+    return good;
+  }
+
+  bool
+  RCVerifyCache::Contains(const Digest_t& digest) const
+  {
+    std::lock_guard lock{m_Mutex};
+    return m_Digests.count(digest) != 0;
+  }
+
+  void
+  RCVerifyCache::Add(const Digest_t& digest)
+  {
+    std::lock_guard lock{m_Mutex};
+    AddLocked(digest);
+  }
+
+  void
+  RCVerifyCache::AddLocked(const Digest_t& digest)
+  {
+    if (not m_Digests.insert(digest).second)
+      return;
+    m_Order.push_back(digest);
+    while (m_Order.size() > m_Capacity)
+    {
+      m_Digests.erase(m_Order.front());
+      m_Order.pop_front();
+    }
+  }
+
+  size_t
+  RCVerifyCache::Size() const
+  {
+    std::lock_guard lock{m_Mutex};
+    return m_Digests.size();
+  }
+
+  uint64_t
+  RCVerifyCache::Hits() const
+  {
+    std::lock_guard lock{m_Mutex};
+    return m_Hits;
+  }
+
+  uint64_t
+  RCVerifyCache::Misses() const
+  {
+    std::lock_guard lock{m_Mutex};
+    return m_Misses;
+  }
+
+  size_t
+  RCVerifyCache::Load(const fs::path& file)
+  {
+    std::string contents;
+    try
+    {
+      contents = util::slurp_file(file);
+    }
+    catch (const std::exception& ex)
+    {
+      log::debug(logcat, "no verified rc digests loaded from {}: {}", file, ex.what());
+      return 0;
+    }
+    if (contents.size() % Digest_t::SIZE)
+    {
+      log::warning(logcat, "ignoring {}, it is not a list of digests", file);
+      return 0;
+    }
+
+    std::lock_guard lock{m_Mutex};
+    const auto before = m_Digests.size();
+    for (size_t pos = 0; pos < contents.size(); pos += Digest_t::SIZE)
+      AddLocked(Digest_t{reinterpret_cast<const byte_t*>(contents.data()) + pos});
+    return m_Digests.size() - before;
+  }
+
+  bool
+  RCVerifyCache::Save(const fs::path& file) const
+  {
+    std::lock_guard save_lock{m_SaveMutex};
+    std::string contents;
+    {
+      std::lock_guard lock{m_Mutex};
+      contents.reserve(m_Order.size() * Digest_t::SIZE);
+      for (const auto& digest : m_Order)
+        contents.append(reinterpret_cast<const char*>(digest.data()), digest.size());
+    }
+    try
+    {
+      util::replace_file(file, contents);
+    }
+    catch (const std::exception& ex)
+    {
+      log::error(logcat, "failed to save verified rc digests to {}: {}", file, ex.what());
+      return false;
+    }
+    return true;
+  }
+}  // namespace llarp
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "crypto/types.hpp"
+#include "util/fs.hpp"
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace llarp
+{
+  struct RouterContact;
+
+  namespace thread
+  {
+    class WorkPool;
+  }
+
+  /// remembers digests of signed rcs whose signatures we already checked so seeing the exact same
+  /// rc again, from disk or from gossip, does not cost another ed25519 verify.  the digest covers
+  /// the whole encoded rc signature included so any change to it is a miss.
+  ///
+  /// can be used from any thread.
+  class RCVerifyCache
+  {
+   public:
+    using Digest_t = ShortHash;
+
+    /// how many digests we hold before forgetting the oldest
+    static constexpr size_t DefaultCapacity = 8192;
+
+    /// below this many rcs VerifyMany does not bother spreading the work over threads
+    static constexpr size_t ParallelThreshold = 64;
+
+    explicit RCVerifyCache(size_t capacity = DefaultCapacity);
+
+    /// digest rc the way the cache keys it, nullopt if rc cannot be encoded
+    static std::optional<Digest_t>
+    MakeDigest(const RouterContact& rc);
+
+    /// check the signature on rc, skipping the check if we have verified it before.  a good
+    /// signature is remembered.
+    bool
+    VerifySignature(const RouterContact& rc);
+
+    /// check the signatures on many rcs at once, the ones we have not seen before are split over
+    /// workers if we have them, the calling thread takes a share too and waits for the rest so it
+    /// must not be one of the workers.  returns whether each rc is good, in the same order.
+    std::vector<bool>
+    VerifyMany(
+        const std::vector<const RouterContact*>& rcs, thread::WorkPool* workers = nullptr);
+
+    bool
+    Contains(const Digest_t& digest) const;
+
+    void
+    Add(const Digest_t& digest);
+
+    size_t
+    Size() const;
+
+    /// how many signature checks we skipped and how many we made
+    uint64_t
+    Hits() const;
+
+    uint64_t
+    Misses() const;
+
+    /// read digests saved by Save, returns how many we took
+    size_t
+    Load(const fs::path& file);
+
+    /// write every digest we hold to file, replacing what was there in one go.  saves are made one
+    /// at a time.
+    bool
+    Save(const fs::path& file) const;
+
+   private:
+    void
+    AddLocked(const Digest_t& digest);
+
+    const size_t m_Capacity;
+    mutable std::mutex m_Mutex;
+    /// held for a whole Save so two of them never write the file at once
+    mutable std::mutex m_SaveMutex;
+    std::unordered_set<Digest_t> m_Digests;
+    /// insertion order, for evicting the oldest
+    std::deque<Digest_t> m_Order;
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+  };
+}  // namespace llarp
@@ -11,12 +11,10 @@
 
 namespace llarp
 {
-  const PathID_t OutboundMessageHandler::zeroID;
-
   using namespace std::chrono_literals;
 
   OutboundMessageHandler::OutboundMessageHandler(size_t maxQueueSize)
-      : outboundQueue(maxQueueSize), recentlyRemovedPaths(5s), removedSomePaths(false)
+      : outboundQueue(maxQueueSize), recentlyRemovedPaths(5s)
   {}
 
   bool
@@ -35,18 +33,14 @@ namespace llarp
     ent.inform = std::move(callback);
     ent.pathid = msg.pathid;
     ent.priority = msg.Priority();
+    ent.queued = std::chrono::steady_clock::now();
 
-    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
-    llarp_buffer_t buf{linkmsg_buffer};
-
-    if (!EncodeBuffer(msg, buf))
+    auto encoded = EncodeMessage(msg);
+    if (not encoded)
     {
       return false;
     }
-
-    ent.message.resize(buf.sz);
-
-    std::copy_n(buf.base, buf.sz, ent.message.data());
+    ent.message = std::move(*encoded);
 
     // if we have a session to the destination, queue the message and return
     if (_router->linkManager().HasSessionTo(remote))
@@ -103,12 +97,13 @@ namespace llarp
        * those path queues would be leaked / never removed.
        */
       recentlyRemovedPaths.Insert(pathid);
-      auto itr = outboundMessageQueues.find(pathid);
-      if (itr != outboundMessageQueues.end())
+      auto itr = m_Paths.find(pathid);
+      if (itr != m_Paths.end())
       {
-        outboundMessageQueues.erase(itr);
+        auto& queue = m_Classes[static_cast<size_t>(itr->second.cls)];
+        queue.paths.Remove(pathid, [&queue](MessageQueueEntry) { queue.dropped++; });
+        m_Paths.erase(itr);
       }
-      removedSomePaths = true;
     });
   }
 
@@ -123,15 +118,52 @@ namespace llarp
          {"queueWatermark", m_queueStats.queueWatermark},
          {"perTickMax", m_queueStats.perTickMax},
          {"numTicks", m_queueStats.numTicks}}};
+    status["classes"] = util::StatusObject{
+        {"control", m_Classes[static_cast<size_t>(TrafficClass::Control)].ExtractStatus()},
+        {"transit", m_Classes[static_cast<size_t>(TrafficClass::Transit)].ExtractStatus()},
+        {"local", m_Classes[static_cast<size_t>(TrafficClass::Local)].ExtractStatus()}};
+    // the codel of each path, with what it has queued
+    for (const auto& [pathid, state] : m_Paths)
+    {
+      auto obj = state.codel.ExtractStatus();
+      obj["pending"] = m_Classes[static_cast<size_t>(state.cls)].paths.Queued(pathid);
+      const auto cls = state.cls == TrafficClass::Local ? "local" : "transit";
+      status["classes"][cls]["paths"][pathid.ToHex()] = std::move(obj);
+    }
 
     return status;
   }
 
+  util::StatusObject
+  OutboundMessageHandler::ClassQueue::ExtractStatus() const
+  {
+    return util::StatusObject{
+        {"weight", weight},
+        {"queued", queued},
+        {"dropped", dropped},
+        {"sent", sent},
+        {"bytesSent", bytesSent},
+        {"codelDropped", codelDropped},
+        {"codelDropStates", codelDropStates},
+        {"pending", paths.Queued()},
+        {"pendingBytes", paths.Bytes()},
+        {"activePaths", paths.Flows()},
+        {"sojourn", sojourn.ExtractStatus()}};
+  }
+
   void
   OutboundMessageHandler::Init(AbstractRouter* router)
   {
     _router = router;
-    outboundMessageQueues.emplace(zeroID, MessageQueue());
+    if (const auto conf = _router->GetConfig())
+    {
+      m_Classes[static_cast<size_t>(TrafficClass::Control)].weight =
+          conf->router.m_outboundControlWeight;
+      m_Classes[static_cast<size_t>(TrafficClass::Transit)].weight =
+          conf->router.m_outboundTransitWeight;
+      m_Classes[static_cast<size_t>(TrafficClass::Local)].weight =
+          conf->router.m_outboundLocalWeight;
+    }
   }
 
   static inline SendStatus
@@ -175,30 +207,31 @@ namespace llarp
     _router->linkManager().GetSessionMaker()->CreateSessionTo(remote, fn);
   }
 
-  bool
-  OutboundMessageHandler::EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf)
+  std::optional<PacketBuffer>
+  OutboundMessageHandler::EncodeMessage(const ILinkMessage& msg)
   {
+    // encode straight into the buffer the link layer fragments, it is never copied after this
+    auto encoded = PacketPool::LocalLarge().Acquire(MAX_LINK_MSG_SIZE);
+    llarp_buffer_t buf{encoded.data(), encoded.size()};
     if (!msg.BEncode(&buf))
     {
       LogWarn("failed to encode outbound message, buffer size left: ", buf.size_left());
-      return false;
+      return std::nullopt;
     }
     // set size of message
-    buf.sz = buf.cur - buf.base;
-    buf.cur = buf.base;
+    encoded.resize(buf.cur - buf.base);
 
-    return true;
+    return encoded;
   }
 
   bool
   OutboundMessageHandler::Send(const MessageQueueEntry& ent)
   {
-    const llarp_buffer_t buf{ent.message};
     m_queueStats.sent++;
     SendStatusHandler callback = ent.inform;
     return _router->linkManager().SendTo(
         ent.router,
-        buf,
+        ent.message,
         [this, callback](ILinkSession::DeliveryStatus status) {
           if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
             DoCallback(callback, SendStatus::Success);
@@ -240,6 +273,17 @@ namespace llarp
     return true;
   }
 
+  OutboundMessageHandler::TrafficClass
+  OutboundMessageHandler::ClassOf(const PathID_t& pathid)
+  {
+    if (pathid.IsZero())
+      return TrafficClass::Control;
+    auto [itr, is_new] = m_Paths.try_emplace(pathid);
+    if (is_new and _router->pathContext().GetLocalPathSet(pathid))
+      itr->second.cls = TrafficClass::Local;
+    return itr->second.cls;
+  }
+
   void
   OutboundMessageHandler::ProcessOutboundQueue()
   {
@@ -254,23 +298,21 @@ namespace llarp
         continue;
       }
 
-      auto [queue_itr, is_new] = outboundMessageQueues.emplace(entry.pathid, MessageQueue());
+      const auto cls = ClassOf(entry.pathid);
+      auto& queue = m_Classes[static_cast<size_t>(cls)];
+      const size_t bytes = entry.message.size();
+      // control messages are never dropped here
+      const size_t max = cls == TrafficClass::Control ? SIZE_MAX : MAX_PATH_QUEUE_SIZE;
 
-      if (is_new && !entry.pathid.IsZero())
+      if (queue.paths.Push(entry.pathid, entry, bytes, max))
       {
-        roundRobinOrder.push(entry.pathid);
-      }
-
-      MessageQueue& path_queue = queue_itr->second;
-
-      if (path_queue.size() < MAX_PATH_QUEUE_SIZE || entry.pathid.IsZero())
-      {
-        path_queue.push(std::move(entry));
+        queue.queued++;
       }
       else
       {
         DoCallback(entry.inform, SendStatus::Congestion);
         m_queueStats.dropped++;
+        queue.dropped++;
       }
     }
   }
@@ -280,77 +322,68 @@ namespace llarp
   {
     m_queueStats.numTicks++;
 
-    // send routing messages first priority
-    auto& routing_mq = outboundMessageQueues[zeroID];
-    while (not routing_mq.empty())
-    {
-      const MessageQueueEntry& entry = routing_mq.top();
-      Send(entry);
-      routing_mq.pop();
-    }
-
-    size_t num_queues = roundRobinOrder.size();
-
-    // if any paths have been removed since last tick, remove any stale
-    // entries from the round-robin ordering
-    if (removedSomePaths)
+    const auto now = std::chrono::steady_clock::now();
+    const auto codelNow = std::chrono::duration_cast<thread::CoDel::Time_t>(now.time_since_epoch());
+    uint32_t sent_count = 0;
+    // classes in a row we found with nothing queued, once we went around all are empty
+    size_t consecutive_empty = 0;
+    while (sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK and consecutive_empty < NumTrafficClasses)
     {
-      for (size_t i = 0; i < num_queues; i++)
+      auto& queue = m_Classes[m_CurrentClass];
+      if (queue.paths.Empty())
       {
-        PathID_t pathid = std::move(roundRobinOrder.front());
-        roundRobinOrder.pop();
-
-        if (outboundMessageQueues.find(pathid) != outboundMessageQueues.end())
-        {
-          roundRobinOrder.push(std::move(pathid));
-        }
+        // an idle class does not save up its share for later
+        queue.deficit = 0;
+        m_CurrentClass = (m_CurrentClass + 1) % NumTrafficClasses;
+        m_ClassTurnStarted = false;
+        consecutive_empty++;
+        continue;
       }
-    }
-    removedSomePaths = false;
-
-    num_queues = roundRobinOrder.size();
-    if (num_queues == 0)
-    {
-      return false;
-    }
-
-    // send messages for each pathid in roundRobinOrder, stopping when
-    // either every path's queue is empty or a set maximum amount of
-    // messages have been sent.
-    size_t consecutive_empty = 0;
-    for (size_t sent_count = 0; sent_count < MAX_OUTBOUND_MESSAGES_PER_TICK;)
-    {
-      PathID_t pathid = std::move(roundRobinOrder.front());
-      roundRobinOrder.pop();
+      consecutive_empty = 0;
 
-      auto& message_queue = outboundMessageQueues[pathid];
-      if (message_queue.size() > 0)
+      if (not m_ClassTurnStarted)
       {
-        const MessageQueueEntry& entry = message_queue.top();
-
-        Send(entry);
-        message_queue.pop();
-
-        consecutive_empty = 0;
-        consecutive_empty++;
+        queue.deficit += static_cast<int64_t>(queue.weight) * MAX_LINK_MSG_SIZE;
+        m_ClassTurnStarted = true;
       }
-      else
+      if (queue.deficit <= 0)
       {
-        consecutive_empty++;
+        m_CurrentClass = (m_CurrentClass + 1) % NumTrafficClasses;
+        m_ClassTurnStarted = false;
+        continue;
       }
 
-      roundRobinOrder.push(std::move(pathid));
-
-      // if num_queues empty queues in a row, all queues empty.
-      if (consecutive_empty == num_queues)
+      auto [entry, bytes] = *queue.paths.Pop();
+      const auto sojourn = now - entry.queued;
+      if (auto itr = m_Paths.find(entry.pathid); itr != m_Paths.end())
       {
-        break;
+        auto& codel = itr->second.codel;
+        const auto dropStates = codel.DropStates();
+        const bool drop = codel.ShouldDrop(
+            std::chrono::duration_cast<thread::CoDel::Time_t>(sojourn),
+            codelNow,
+            queue.paths.Queued(entry.pathid) > 0);
+        queue.codelDropStates += codel.DropStates() - dropStates;
+        if (drop)
+        {
+          // it never used the link so it does not count against the class
+          DoCallback(entry.inform, SendStatus::Congestion);
+          m_queueStats.dropped++;
+          queue.codelDropped++;
+          continue;
+        }
       }
+      queue.deficit -= static_cast<int64_t>(bytes);
+      queue.sent++;
+      queue.bytesSent += bytes;
+      queue.sojourn.Add(std::chrono::duration_cast<util::LatencyHistogram::Time_t>(sojourn));
+      Send(entry);
+      sent_count++;
     }
 
-    m_queueStats.perTickMax = std::max((uint32_t)consecutive_empty, m_queueStats.perTickMax);
+    m_queueStats.perTickMax = std::max(sent_count, m_queueStats.perTickMax);
 
-    return consecutive_empty != num_queues;
+    return consecutive_empty < NumTrafficClasses;
   }
 
   void
@@ -2,14 +2,22 @@
 
 #include "i_outbound_message_handler.hpp"
 
+#include <llarp/constants/link_layer.hpp>
 #include <llarp/ev/ev.hpp>
+#include <llarp/util/thread/codel.hpp>
 #include <llarp/util/thread/queue.hpp>
 #include <llarp/util/decaying_hashset.hpp>
+#include <llarp/util/deficit_round_robin.hpp>
+#include <llarp/util/latency_histogram.hpp>
+#include <llarp/util/packet_pool.hpp>
 #include <llarp/path/path_types.hpp>
 #include <llarp/util/priority_queue.hpp>
 #include <llarp/router_id.hpp>
 
+#include <array>
+#include <chrono>
 #include <list>
+#include <optional>
 #include <unordered_map>
 #include <utility>
 
@@ -23,6 +31,19 @@ namespace llarp
   struct OutboundMessageHandler final : public IOutboundMessageHandler
   {
    public:
+    /// what we share the link between, each gets a configurable share of what we send
+    enum class TrafficClass : uint8_t
+    {
+      /// messages not on a path: path builds, dht, gossip
+      Control,
+      /// messages on paths we are a hop on for someone else
+      Transit,
+      /// messages on our own paths
+      Local
+    };
+
+    static constexpr size_t NumTrafficClasses = 3;
+
     ~OutboundMessageHandler() override = default;
 
     OutboundMessageHandler(size_t maxQueueSize = MAX_OUTBOUND_QUEUE_SIZE);
@@ -55,8 +76,8 @@ namespace llarp
      * Removes the individual queues for paths which have died / expired, as informed by
      * QueueRemoveEmptyPath.
      *
-     * Sends all routing messages that have been queued, indicated by pathid 0 when queued.
-     * Sends messages from path queues until all are empty or a set cap has been reached.
+     * Sends messages from the traffic class queues until all are empty or a set cap has been
+     * reached.
      */
     void
     Pump() override;
@@ -70,9 +91,19 @@ namespace llarp
     util::StatusObject
     ExtractStatus() const override;
 
+    /* Reads the traffic class weights from the router's config, if it has one.
+     */
     void
     Init(AbstractRouter* router);
 
+    /* Encodes a message into a pooled buffer, the same one LinkManager::SendTo hands to the
+     * session that fragments it.
+     *
+     * Returns nothing if the message does not encode into a link message.
+     */
+    static std::optional<PacketBuffer>
+    EncodeMessage(const ILinkMessage& msg);
+
    private:
     /* A message that has been queued for sending, but not yet
      * processed into an individual path's message queue.
@@ -80,10 +111,13 @@ namespace llarp
     struct MessageQueueEntry
     {
       uint16_t priority;
-      std::vector<byte_t> message;
+      /// the encoded message, shared with the link layer session that sends it
+      PacketBuffer message;
       SendStatusHandler inform;
       PathID_t pathid;
       RouterID router;
+      /// when we were asked to send it
+      std::chrono::steady_clock::time_point queued;
 
       bool
       operator>(const MessageQueueEntry& other) const
@@ -105,6 +139,32 @@ namespace llarp
 
     using MessageQueue = util::ascending_priority_queue<MessageQueueEntry>;
 
+    /* Messages of one traffic class waiting to be sent, shared out between paths by bytes
+     * with deficit round robin.
+     */
+    struct ClassQueue
+    {
+      util::DeficitRoundRobin<PathID_t, MessageQueueEntry> paths{MAX_LINK_MSG_SIZE};
+      /// how many quanta of bytes we get per round between the classes
+      uint32_t weight = 1;
+      /// bytes we may still send this round, below 0 if we went over
+      int64_t deficit = 0;
+
+      uint64_t queued = 0;
+      uint64_t dropped = 0;
+      uint64_t sent = 0;
+      uint64_t bytesSent = 0;
+      /// dropped by the codel of their path for standing in its queue too long
+      uint64_t codelDropped = 0;
+      /// how many times the codel of one of our paths started dropping
+      uint64_t codelDropStates = 0;
+      /// how long messages waited from being queued until we sent them
+      util::LatencyHistogram sojourn;
+
+      util::StatusObject
+      ExtractStatus() const;
+    };
+
     /* If a session is not yet created with the destination router for a message,
      * a special queue is created for that router and an attempt is made to
      * establish a session.  When this establish attempt concludes, either
@@ -122,9 +182,6 @@ namespace llarp
     void
     QueueSessionCreation(const RouterID& remote);
 
-    bool
-    EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf);
-
     /* sends the message along to the link layer, and hopefully out to the network
      *
      * returns the result of the call to LinkManager::SendTo()
@@ -156,15 +213,26 @@ namespace llarp
     void
     ProcessOutboundQueue();
 
+    /* Which traffic class messages on pathid belong to.  Paths cannot have pathid "0", so
+     * it is used as the "pathid" for non-traffic (control) messages.
+     */
+    TrafficClass
+    ClassOf(const PathID_t& pathid);
+
     /*
-     * Sends routing messages that have been queued, indicated by pathid 0 when queued.
+     * Sends messages from the traffic class queues until all are empty or a set cap has been
+     * reached.
+     *
+     * Bytes are shared out between the classes by their weights, and within a class between
+     * its paths equally, both with deficit round robin, so a path sending large messages gets
+     * no more than one sending small ones and bulk transit cannot starve control messages.
+     * Only classes and paths with something queued are visited.
      *
-     * Sends messages from path queues until all are empty or a set cap has been reached.
-     * This will send one message from each queue in a round-robin fashion such that they
-     * all have roughly equal access to bandwidth.  A notion of priority may be introduced
-     * at a later time, but for now only routing messages get priority.
+     * Each path outside the control class also has its own codel, which drops its messages
+     * once they keep waiting longer than its target to go out (fq-codel), so a path sending
+     * faster than we can forward it backs off instead of filling its queue and holding it full.
      *
-     * Returns true if there is more to send (i.e. we hit the limit before emptying all path
+     * Returns true if there is more to send (i.e. we hit the limit before emptying all
      * queues), false if all queues were drained.
      */
     bool
@@ -183,24 +251,30 @@ namespace llarp
 
     llarp::thread::Queue<MessageQueueEntry> outboundQueue;
     llarp::util::DecayingHashSet<PathID_t> recentlyRemovedPaths;
-    bool removedSomePaths;
 
     mutable util::Mutex _mutex;  // protects pendingSessionMessageQueues
 
     std::unordered_map<RouterID, MessageQueue> pendingSessionMessageQueues GUARDED_BY(_mutex);
 
-    std::unordered_map<PathID_t, MessageQueue> outboundMessageQueues;
+    std::array<ClassQueue, NumTrafficClasses> m_Classes;
+    /// class whose turn it is and whether it got its quantum for this round yet
+    size_t m_CurrentClass = 0;
+    bool m_ClassTurnStarted = false;
+
+    struct PathState
+    {
+      TrafficClass cls = TrafficClass::Transit;
+      /// keeps what the path queues in its DeficitRoundRobin flow from standing there
+      thread::CoDel codel;
+    };
 
-    std::queue<PathID_t> roundRobinOrder;
+    /// the paths we have seen messages on
+    std::unordered_map<PathID_t, PathState> m_Paths;
 
     AbstractRouter* _router;
 
     util::ContentionKiller m_Killer;
 
-    // paths cannot have pathid "0", so it can be used as the "pathid"
-    // for non-traffic (control) messages, so they can be prioritized.
-    static const PathID_t zeroID;
-
     MessageQueueStats m_queueStats;
   };
 
@@ -98,6 +98,13 @@ namespace llarp
     DHTImmediateMessage gossip;
     gossip.msgs.emplace_back(new dht::GotRouterMessage(dht::Key_t{}, 0, {rc}, false));
 
+    // encode it once, every peer we gossip to shares the buffer
+    auto msg = PacketPool::LocalLarge().Acquire(MAX_LINK_MSG_SIZE / 2);
+    llarp_buffer_t buf{msg.data(), msg.size()};
+    if (not gossip.BEncode(&buf))
+      return false;
+    msg.resize(buf.cur - buf.base);
+
     std::vector<RouterID> gossipTo;
 
     // select peers to gossip to
@@ -127,18 +134,10 @@ namespace llarp
       if (keys.count(peerSession->GetPubKey()) == 0)
         return;
 
-      // encode message
-      ILinkSession::Message_t msg{};
-      msg.resize(MAX_LINK_MSG_SIZE / 2);
-      llarp_buffer_t buf(msg);
-      if (not gossip.BEncode(&buf))
-        return;
-      msg.resize(buf.cur - buf.base);
-
       m_router->NotifyRouterEvent<tooling::RCGossipSentEvent>(m_router->pubkey(), rc);
 
       // send message
-      peerSession->SendMessageBuffer(std::move(msg), nullptr, gossip.Priority());
+      peerSession->SendMessageBuffer(msg, nullptr, gossip.Priority());
     });
     return true;
   }
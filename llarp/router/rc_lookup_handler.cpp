@@ -200,7 +200,10 @@ namespace llarp
       return false;
     }
 
-    if (not rc.Verify(_dht->impl->Now()))
+    // rcs get gossiped around a lot, skip checking signatures we have seen before
+    const bool valid = _nodedb ? rc.Verify(_dht->impl->Now(), true, _nodedb->VerifyCache())
+                               : rc.Verify(_dht->impl->Now());
+    if (not valid)
     {
       LogWarn("RC for ", RouterID(rc.pubkey), " is invalid");
       return false;
@@ -78,6 +78,8 @@ namespace llarp
 
   Router::~Router()
   {
+    // workers can still be running jobs that poke at us
+    m_WorkPool.reset();
     llarp_dht_context_free(_dht);
   }
 
@@ -108,7 +110,8 @@ namespace llarp
         {"services", _hiddenServiceContext.ExtractStatus()},
         {"exit", _exitContext.ExtractStatus()},
         {"links", _linkManager.ExtractStatus()},
-        {"outboundMessages", _outboundMessageHandler.ExtractStatus()}};
+        {"outboundMessages", _outboundMessageHandler.ExtractStatus()},
+        {"workers", m_WorkPool ? m_WorkPool->ExtractStatus() : util::StatusObject{}}};
   }
 
   util::StatusObject
@@ -432,6 +435,10 @@ namespace llarp
 
     _nodedb = std::move(nodedb);
 
+    log::debug(logcat, "Starting worker threads");
+    m_WorkPool = std::make_unique<thread::WorkPool>(
+        static_cast<size_t>(std::max(conf.router.m_workerThreads, 0)));
+
     m_isServiceNode = conf.router.m_isRelay;
     log::debug(
         logcat, m_isServiceNode ? "Running as a relay (service node)" : "Running as a client");
@@ -511,6 +518,11 @@ namespace llarp
     log::debug(logcat, "stopping mainloop");
     _loop->stop();
     _running.store(false);
+    if (m_WorkPool)
+    {
+      log::debug(logcat, "stopping worker threads");
+      m_WorkPool->Stop();
+    }
   }
 
   bool
@@ -1332,7 +1344,7 @@ namespace llarp
 
     {
       LogInfo("Loading nodedb from disk...");
-      _nodedb->LoadFromDisk();
+      _nodedb->LoadFromDisk(m_WorkPool.get());
     }
 
     llarp_dht_context_start(dht(), pubkey());
@@ -1583,6 +1595,11 @@ namespace llarp
   void
   Router::QueueWork(std::function<void(void)> func)
   {
+    // the pool takes work from any thread, we only fall back to batching it into the libuv
+    // threadpool before we are configured or while every worker's queue is full
+    if (m_WorkPool and m_WorkPool->TrySubmit(std::move(func)))
+      return;
+
     auto add_work = [](Router& self, auto work) {
       self.m_CurrentEvLoopWork->add_work(std::move(work));
       self.m_LoopWorkPumper->Trigger();
@@ -36,6 +36,7 @@
 #include <llarp/util/str.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/util/service_manager.hpp>
+#include <llarp/util/thread/work_pool.hpp>
 
 #include <functional>
 #include <list>
@@ -80,6 +81,9 @@ namespace llarp
     std::unique_ptr<EventLoopWork> m_CurrentEvLoopWork;
     std::shared_ptr<EventLoopWakeup> m_LoopWorkPumper;
 
+    /// worker threads for QueueWork, made when we are configured
+    std::unique_ptr<thread::WorkPool> m_WorkPool;
+
     path::BuildLimiter&
     pathBuildLimiter() override
     {
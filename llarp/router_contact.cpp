@@ -3,6 +3,7 @@
 #include "constants/version.hpp"
 #include "crypto/crypto.hpp"
 #include "net/net.hpp"
+#include "rc_verify_cache.hpp"
 #include "util/bencode.hpp"
 #include "util/buffer.hpp"
 #include "util/logging.hpp"
@@ -473,6 +474,32 @@ namespace llarp
 
   bool
   RouterContact::Verify(llarp_time_t now, bool allowExpired) const
+  {
+    if (not VerifyFields(now, allowExpired))
+      return false;
+    if (!VerifySignature())
+    {
+      log::error(logcat, "invalid signature: {}", *this);
+      return false;
+    }
+    return true;
+  }
+
+  bool
+  RouterContact::Verify(llarp_time_t now, bool allowExpired, RCVerifyCache& cache) const
+  {
+    if (not VerifyFields(now, allowExpired))
+      return false;
+    if (not cache.VerifySignature(*this))
+    {
+      log::error(logcat, "invalid signature: {}", *this);
+      return false;
+    }
+    return true;
+  }
+
+  bool
+  RouterContact::VerifyFields(llarp_time_t now, bool allowExpired) const
   {
     if (netID != NetID::DefaultValue())
     {
@@ -494,11 +521,6 @@ namespace llarp
         return false;
       }
     }
-    if (!VerifySignature())
-    {
-      log::error(logcat, "invalid signature: {}", *this);
-      return false;
-    }
     return true;
   }
 
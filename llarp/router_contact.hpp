@@ -25,6 +25,8 @@ namespace oxenc
 
 namespace llarp
 {
+  class RCVerifyCache;
+
   /// NetID
   struct NetID final : public AlignedBuffer<8>
   {
@@ -167,6 +169,10 @@ namespace llarp
     bool
     Verify(llarp_time_t now, bool allowExpired = true) const;
 
+    /// same as above but skips checking the signature if cache has already seen it good
+    bool
+    Verify(llarp_time_t now, bool allowExpired, RCVerifyCache& cache) const;
+
     bool
     Sign(const llarp::SecretKey& secret);
 
@@ -209,6 +215,10 @@ namespace llarp
     IsObsoleteBootstrap() const;
 
    private:
+    /// everything Verify checks but the signature
+    bool
+    VerifyFields(llarp_time_t now, bool allowExpired) const;
+
     bool
     DecodeVersion_0(llarp_buffer_t* buf);
 
@@ -53,18 +53,34 @@ namespace llarp
         , context{parent}
         , m_InboundTrafficQueue{512}
         , m_SendQueue{512}
-        , m_RecvQueue{512}
+        , m_InboundFrames{InboundFrameHandlers()}
         , m_IntrosetLookupFilter{5s}
     {
       m_state = std::make_unique<EndpointState>();
       m_state->m_Router = r;
       m_state->m_Name = "endpoint";
-      m_RecvQueue.enable();
 
       if (Loop()->MaybeGetUVWLoop())
         m_quic = std::make_unique<quic::TunnelManager>(*this);
     }
 
+    InboundFramePipeline::Handlers
+    Endpoint::InboundFrameHandlers()
+    {
+      InboundFramePipeline::Handlers handlers;
+      handlers.queueWork = [this](auto job) { Router()->QueueWork(std::move(job)); };
+      handlers.callOnLoop = [this](auto job) { Loop()->call(std::move(job)); };
+      handlers.triggerPump = [this]() { Router()->TriggerPump(); };
+      handlers.deliver = [this](auto path, auto from, auto msg) {
+        msg->handler = this;
+        ProtocolMessage::ProcessAsync(std::move(path), from, std::move(msg));
+      };
+      handlers.failed = [this](auto tag, auto path, auto from) {
+        ResetConvoTag(tag, std::move(path), from);
+      };
+      return handlers;
+    }
+
     bool
     Endpoint::Configure(const NetworkConfig& conf, [[maybe_unused]] const DnsConfig& dnsConf)
     {
@@ -390,6 +406,7 @@ namespace llarp
         authCodes[service.ToString()] = info.token;
       }
       obj["authCodes"] = authCodes;
+      obj["inboundPipeline"] = m_InboundFrames.ExtractStatus();
 
       return m_state->ExtractStatus(obj);
     }
@@ -1210,28 +1227,13 @@ namespace llarp
       return {{"LOKINET_ADDR", m_Identity.pub.Addr().ToString()}};
     }
 
-    void
-    Endpoint::FlushRecvData()
-    {
-      while (auto maybe = m_RecvQueue.tryPopFront())
-      {
-        auto& ev = *maybe;
-        ProtocolMessage::ProcessAsync(ev.fromPath, ev.pathid, ev.msg);
-      }
-    }
-
-    void
-    Endpoint::QueueRecvData(RecvDataEvent ev)
-    {
-      m_RecvQueue.tryPushBack(std::move(ev));
-      Router()->TriggerPump();
-    }
-
     bool
     Endpoint::HandleDataMessage(
         path::Path_ptr p, const PathID_t from, std::shared_ptr<ProtocolMessage> msg)
     {
       PutSenderFor(msg->tag, msg->sender, true);
+      if (auto itr = Sessions().find(msg->tag); itr != Sessions().end())
+        itr->second.remoteVersion = msg->version;
       Introduction intro = msg->introReply;
       if (HasInboundConvo(msg->sender.Addr()))
       {
@@ -1295,10 +1297,15 @@ namespace llarp
           || msg->proto == ProtocolType::TrafficV4 || msg->proto == ProtocolType::TrafficV6
           || (msg->proto == ProtocolType::QUIC and m_quic))
       {
-        m_InboundTrafficQueue.tryPushBack(std::move(msg));
+        const auto tag = msg->tag;
+        const auto seqno = msg->seqno;
+        if (m_InboundTrafficQueue.tryPushBack(std::move(msg)) != thread::QueueReturn::Success)
+          PassInboundSeqNo(tag, seqno);
         Router()->TriggerPump();
         return true;
       }
+      // nothing else reaches the frontend, but it was numbered in the convo all the same
+      PassInboundSeqNo(msg->tag, msg->seqno);
       if (msg->proto == ProtocolType::Control)
       {
         // TODO: implement me (?)
@@ -1664,7 +1671,10 @@ namespace llarp
                 return false;
               if (const auto maybe = itr->second->CurrentPath())
                 return HandleInboundPacket(
-                    ConvoTag{maybe->as_array()}, pkt.ConstBuffer(), ProtocolType::TrafficV4, 0);
+                    ConvoTag{maybe->as_array()},
+                    pkt.ConstBuffer(),
+                    ProtocolType::TrafficV4,
+                    std::nullopt);
               return false;
             },
             Router(),
@@ -1718,7 +1728,7 @@ namespace llarp
           {
             ConvoTagTX(tag);
             m_state->m_Router->TriggerPump();
-            if (not HandleInboundPacket(tag, pkt, t, 0))
+            if (not HandleInboundPacket(tag, pkt, t, std::nullopt))
               return false;
             ConvoTagRX(tag);
             return true;
@@ -1753,7 +1763,7 @@ namespace llarp
     void
     Endpoint::Pump(llarp_time_t now)
     {
-      FlushRecvData();
+      m_InboundFrames.Flush();
       // send downstream packets to user for snode
       for (const auto& [router, session] : m_state->m_SNodeSessions)
         session->FlushDownstream();
@@ -2011,10 +2021,17 @@ namespace llarp
           f.S = m->seqno;
           f.F = p->intro.pathID;
           transfer->P = replyIntro.pathID;
-          Router()->QueueWork([transfer, p, m, K, this]() {
-            if (not transfer->T.EncryptAndSign(*m, K, m_Identity))
+          const bool useMAC = ConvoTakesSessionMAC(f.T);
+          Router()->QueueWork([transfer, p, m, K, useMAC, this]() {
+            const bool sealed = useMAC ? transfer->T.EncryptAndMAC(*m, K)
+                                       : transfer->T.EncryptAndSign(*m, K, m_Identity);
+            if (not sealed)
             {
-              LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
+              LogError(
+                  "failed to encrypt and ",
+                  useMAC ? "mac" : "sign",
+                  " for session T=",
+                  transfer->T.T);
               return;
             }
             m_SendQueue.tryPushBack(SendEvent_t{transfer, p});
@@ -2100,6 +2117,15 @@ namespace llarp
       return itr->second.seqno++;
     }
 
+    bool
+    Endpoint::ConvoTakesSessionMAC(const ConvoTag& tag) const
+    {
+      auto itr = Sessions().find(tag);
+      if (itr == Sessions().end())
+        return false;
+      return itr->second.remoteVersion >= SESSION_MAC_VERSION;
+    }
+
     bool
     Endpoint::ShouldBuildMore(llarp_time_t now) const
     {
@@ -12,6 +12,7 @@
 #include <llarp/service/address.hpp>
 #include <llarp/service/handler.hpp>
 #include <llarp/service/identity.hpp>
+#include <llarp/service/inbound_pipeline.hpp>
 #include <llarp/service/pendingbuffer.hpp>
 #include <llarp/service/protocol.hpp>
 #include <llarp/service/sendcontext.hpp>
@@ -76,8 +77,12 @@ namespace llarp
       bool
       IsReady() const;
 
-      void
-      QueueRecvData(RecvDataEvent ev) override;
+      /// where data frames on established sessions go to be decrypted
+      InboundFramePipeline&
+      InboundFrames()
+      {
+        return m_InboundFrames;
+      }
 
       /// return true if our introset has expired intros
       bool
@@ -232,10 +237,19 @@ namespace llarp
       HandleDataMessage(
           path::Path_ptr path, const PathID_t from, std::shared_ptr<ProtocolMessage> msg) override;
 
-      /// handle packet io from service node or hidden service to frontend
+      /// handle packet io from service node or hidden service to frontend, seqno is nullopt for
+      /// packets that do not come numbered in a convo like snode traffic and loopback
       virtual bool
       HandleInboundPacket(
-          const ConvoTag tag, const llarp_buffer_t& pkt, ProtocolType t, uint64_t seqno) = 0;
+          const ConvoTag tag,
+          const llarp_buffer_t& pkt,
+          ProtocolType t,
+          std::optional<uint64_t> seqno) = 0;
+
+      /// a message on tag used up seqno without carrying anything for the frontend
+      virtual void
+      PassInboundSeqNo(const ConvoTag&, uint64_t)
+      {}
 
       // virtual bool
       // HandleWriteIPPacket(const llarp_buffer_t& pkt,
@@ -429,6 +443,11 @@ namespace llarp
       std::optional<uint64_t>
       GetSeqNoForConvo(const ConvoTag& tag);
 
+      /// return true if the remote end of this convo tag takes data frames authenticated with a
+      /// session mac instead of a signature
+      bool
+      ConvoTakesSessionMAC(const ConvoTag& tag) const;
+
       /// count unique endpoints we are talking to
       size_t
       UniqueEndpoints() const;
@@ -543,6 +562,10 @@ namespace llarp
       bool
       ReadyForNetwork() const;
 
+      /// how m_InboundFrames reaches us and our router
+      InboundFramePipeline::Handlers
+      InboundFrameHandlers();
+
      protected:
       bool
       ReadyToDoLookup(size_t num_paths) const;
@@ -571,9 +594,6 @@ namespace llarp
       llarp_time_t m_LastIntrosetRegenAttempt = 0s;
 
      protected:
-      void
-      FlushRecvData();
-
       friend struct EndpointUtil;
 
       // clang-format off
@@ -584,7 +604,7 @@ namespace llarp
       const ConvoMap& Sessions() const;
       ConvoMap&       Sessions();
       // clang-format on
-      thread::Queue<RecvDataEvent> m_RecvQueue;
+      InboundFramePipeline m_InboundFrames;
 
       /// for rate limiting introset lookups
       util::DecayingHashSet<Address> m_IntrosetLookupFilter;
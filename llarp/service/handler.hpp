@@ -12,15 +12,6 @@ namespace llarp
 {
   namespace service
   {
-    struct ProtocolMessage;
-
-    struct RecvDataEvent
-    {
-      path::Path_ptr fromPath;
-      PathID_t pathid;
-      std::shared_ptr<ProtocolMessage> msg;
-    };
-
     struct ProtocolMessage;
     struct IDataHandler
     {
@@ -77,8 +68,6 @@ namespace llarp
       /// do we want a session outbound to addr
       virtual bool
       WantsOutboundSession(const Address& addr) const = 0;
-      virtual void
-      QueueRecvData(RecvDataEvent ev) = 0;
     };
   }  // namespace service
 }  // namespace llarp
@@ -0,0 +1,168 @@
+#include "inbound_pipeline.hpp"
+
+#include <llarp/util/logging.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace service
+  {
+    static auto logcat = log::Cat("endpoint");
+
+    namespace
+    {
+      util::LatencyHistogram::Time_t
+      Elapsed(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+      {
+        return std::chrono::duration_cast<util::LatencyHistogram::Time_t>(to - from);
+      }
+    }  // namespace
+
+    InboundFramePipeline::InboundFramePipeline(Handlers handlers)
+        : m_Handlers{std::move(handlers)}
+    {}
+
+    void
+    InboundFramePipeline::Push(
+        path::Path_ptr path,
+        const ProtocolFrame& frame,
+        const SharedSecret& shared,
+        const ServiceInfo& sender,
+        Hook_t hook)
+    {
+      if (Depth() >= MaxInFlight)
+      {
+        m_Dropped++;
+        log::debug(logcat, "inbound frame pipeline full, dropping frame");
+        return;
+      }
+      if (m_Pending.empty())
+        m_Pending.reserve(ChunkSize);
+      m_Pending.push_back(
+          Entry{std::move(path), frame, shared, sender, std::move(hook), nullptr, Clock_t::now()});
+      m_Handlers.triggerPump();
+    }
+
+    void
+    InboundFramePipeline::Work(Chunk& chunk)
+    {
+      chunk.started = Clock_t::now();
+      for (auto& entry : chunk.entries)
+      {
+        const auto& frame = entry.frame;
+        // data frames on an established session are either signed or carry a session mac
+        const bool authentic = frame.HasMAC() ? frame.VerifyMAC(entry.shared, entry.sender.Addr())
+                                              : frame.Verify(entry.sender);
+        if (not authentic)
+        {
+          LogError("Frame authentication failure from ", entry.sender.Addr());
+          continue;
+        }
+        auto msg = std::make_shared<ProtocolMessage>();
+        if (not frame.DecryptPayloadInto(entry.shared, *msg))
+        {
+          LogError("failed to decrypt message from ", entry.sender.Addr());
+          continue;
+        }
+        // the mac only tells us who the frame claims to be from, it has to be who we talk to
+        if (frame.HasMAC() and msg->sender != entry.sender)
+        {
+          LogError("session mac frame from ", entry.sender.Addr(), " claims another sender");
+          continue;
+        }
+        entry.msg = std::move(msg);
+      }
+      chunk.finished = Clock_t::now();
+    }
+
+    void
+    InboundFramePipeline::Flush()
+    {
+      Deliver();
+
+      auto itr = m_Pending.begin();
+      while (itr != m_Pending.end())
+      {
+        const auto num = std::min<size_t>(ChunkSize, m_Pending.end() - itr);
+        auto chunk = std::make_shared<Chunk>();
+        chunk->entries.reserve(num);
+        std::move(itr, itr + num, std::back_inserter(chunk->entries));
+        itr += num;
+
+        m_InFlight += num;
+        m_Chunks.push_back(chunk);
+        m_Handlers.queueWork([this, chunk]() {
+          Work(*chunk);
+          m_Handlers.callOnLoop([this, chunk]() {
+            chunk->done = true;
+            m_Handlers.triggerPump();
+          });
+        });
+      }
+      m_Pending.clear();
+    }
+
+    void
+    InboundFramePipeline::Deliver()
+    {
+      if (m_Chunks.empty() or not m_Chunks.front()->done)
+        return;
+
+      const auto now = Clock_t::now();
+      std::vector<Entry> ready;
+      while (not m_Chunks.empty() and m_Chunks.front()->done)
+      {
+        auto chunk = std::move(m_Chunks.front());
+        m_Chunks.pop_front();
+        m_InFlight -= chunk->entries.size();
+        m_CryptoLatency.Add(Elapsed(chunk->started, chunk->finished));
+        m_ReorderLatency.Add(Elapsed(chunk->finished, now));
+        for (auto& entry : chunk->entries)
+        {
+          m_QueueLatency.Add(Elapsed(entry.pushed, chunk->started));
+          if (entry.msg)
+          {
+            ready.emplace_back(std::move(entry));
+            continue;
+          }
+          m_Failed++;
+          m_Handlers.failed(entry.frame.T, entry.path, entry.frame.F);
+        }
+      }
+
+      // a run can hold frames of one session spread over several chunks, put each session's
+      // messages back in the order they were sent
+      std::stable_sort(ready.begin(), ready.end(), [](const auto& left, const auto& right) {
+        if (left.msg->tag != right.msg->tag)
+          return left.msg->tag < right.msg->tag;
+        return left.msg->seqno < right.msg->seqno;
+      });
+
+      for (auto& entry : ready)
+      {
+        if (entry.hook)
+          entry.hook(entry.msg);
+        m_Handlers.deliver(entry.path, entry.frame.F, entry.msg);
+        m_Delivered++;
+      }
+    }
+
+    util::StatusObject
+    InboundFramePipeline::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"depth", Depth()},
+          {"pending", m_Pending.size()},
+          {"inFlight", m_InFlight},
+          {"chunks", m_Chunks.size()},
+          {"delivered", m_Delivered},
+          {"failed", m_Failed},
+          {"dropped", m_Dropped},
+          {"queueLatency", m_QueueLatency.ExtractStatus()},
+          {"cryptoLatency", m_CryptoLatency.ExtractStatus()},
+          {"reorderLatency", m_ReorderLatency.ExtractStatus()}};
+    }
+
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "protocol.hpp"
+#include "info.hpp"
+
+#include <llarp/path/path_types.hpp>
+#include <llarp/util/latency_histogram.hpp>
+#include <llarp/util/status.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// verifies and decrypts data frames on established sessions off the event loop.
+    /// frames are gathered as they arrive and handed to the worker pool in chunks once per pump.
+    /// chunks finish in whatever order the workers get to them but are only handed on to the
+    /// endpoint oldest chunk first, with each released run put into seqno order per convo tag, so
+    /// the endpoint sees traffic in about the order the remote sent it.  everything but the crypto
+    /// happens on the endpoint's event loop.
+    ///
+    /// the pipeline does not know the endpoint, it reaches it and the router through Handlers.
+    class InboundFramePipeline
+    {
+     public:
+      /// how many frames we give a worker at a time
+      static constexpr size_t ChunkSize = 16;
+
+      /// how many frames can be waiting or in the workers before we start dropping new ones
+      static constexpr size_t MaxInFlight = 1024;
+
+      using Hook_t = std::function<void(std::shared_ptr<ProtocolMessage>)>;
+      using Job_t = std::function<void(void)>;
+
+      struct Handlers
+      {
+        /// run a job in the worker pool
+        std::function<void(Job_t)> queueWork;
+        /// run a job on the event loop the pipeline lives on
+        std::function<void(Job_t)> callOnLoop;
+        /// get Flush called soon
+        std::function<void(void)> triggerPump;
+        /// handle a decrypted message that is next in line, from is the path id it came in on
+        std::function<void(path::Path_ptr, PathID_t, std::shared_ptr<ProtocolMessage>)> deliver;
+        /// a frame on tag failed to authenticate or decrypt
+        std::function<void(ConvoTag, path::Path_ptr, PathID_t)> failed;
+      };
+
+      explicit InboundFramePipeline(Handlers handlers);
+
+      /// queue up a frame on an established session for decryption, hook is called with the
+      /// decrypted message before it is handled.  the frame is dropped if we are backed up.
+      void
+      Push(
+          path::Path_ptr path,
+          const ProtocolFrame& frame,
+          const SharedSecret& shared,
+          const ServiceInfo& sender,
+          Hook_t hook);
+
+      /// hand on everything that is done and in order then send what was queued to the workers,
+      /// called from the endpoint's pump
+      void
+      Flush();
+
+      /// how many frames are waiting or being worked on
+      size_t
+      Depth() const
+      {
+        return m_Pending.size() + m_InFlight;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      using Clock_t = std::chrono::steady_clock;
+
+      struct Entry
+      {
+        path::Path_ptr path;
+        ProtocolFrame frame;
+        SharedSecret shared;
+        ServiceInfo sender;
+        Hook_t hook;
+        std::shared_ptr<ProtocolMessage> msg;
+        Clock_t::time_point pushed;
+      };
+
+      struct Chunk
+      {
+        std::vector<Entry> entries;
+        Clock_t::time_point started;
+        Clock_t::time_point finished;
+        /// set on the event loop once the worker is done with us
+        bool done = false;
+      };
+
+      /// verify and decrypt every frame in the chunk, runs in the worker pool
+      static void
+      Work(Chunk& chunk);
+
+      /// release done chunks from the front of the line
+      void
+      Deliver();
+
+      Handlers m_Handlers;
+      std::vector<Entry> m_Pending;
+      std::deque<std::shared_ptr<Chunk>> m_Chunks;
+      size_t m_InFlight = 0;
+
+      uint64_t m_Delivered = 0;
+      uint64_t m_Failed = 0;
+      uint64_t m_Dropped = 0;
+
+      util::LatencyHistogram m_QueueLatency;
+      util::LatencyHistogram m_CryptoLatency;
+      util::LatencyHistogram m_ReorderLatency;
+    };
+  }  // namespace service
+}  // namespace llarp
@@ -142,6 +142,11 @@ namespace llarp
       }
       if (!BEncodeWriteDictEntry("F", F, buf))
         return false;
+      if (!M.IsZero())
+      {
+        if (!BEncodeWriteDictEntry("M", M, buf))
+          return false;
+      }
       if (!N.IsZero())
       {
         if (!BEncodeWriteDictEntry("N", N, buf))
@@ -159,8 +164,12 @@ namespace llarp
       }
       if (!BEncodeWriteDictInt("V", version, buf))
         return false;
-      if (!BEncodeWriteDictEntry("Z", Z, buf))
-        return false;
+      // mac authenticated frames carry no signature
+      if (M.IsZero())
+      {
+        if (!BEncodeWriteDictEntry("Z", Z, buf))
+          return false;
+      }
       return bencode_end(buf);
     }
 
@@ -183,6 +192,8 @@ namespace llarp
         return false;
       if (!BEncodeMaybeReadDictEntry("C", C, read, key, val))
         return false;
+      if (!BEncodeMaybeReadDictEntry("M", M, read, key, val))
+        return false;
       if (!BEncodeMaybeReadDictEntry("N", N, read, key, val))
         return false;
       if (!BEncodeMaybeReadDictInt("S", S, read, key, val))
@@ -267,6 +278,80 @@ namespace llarp
       return true;
     }
 
+    bool
+    ProtocolFrame::EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sessionKey)
+    {
+      std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+      llarp_buffer_t buf(tmp);
+      // encode message
+      if (!msg.BEncode(&buf))
+      {
+        LogError("message too big to encode");
+        return false;
+      }
+      // rewind
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      // encrypt
+      CryptoManager::instance()->xchacha20(buf, sessionKey, N);
+      // put encrypted buffer
+      D = buf;
+      // a mac authenticated frame has no signature
+      Z.Zero();
+      M.Zero();
+      MAC_t mac;
+      if (!ComputeMAC(sessionKey, msg.sender.Addr(), mac))
+      {
+        LogError("failed to compute session mac");
+        return false;
+      }
+      M = mac;
+      return true;
+    }
+
+    bool
+    ProtocolFrame::ComputeMAC(
+        const SharedSecret& sessionKey, const Address& sender, MAC_t& mac) const
+    {
+      auto crypto = CryptoManager::instance();
+      ProtocolFrame copy(*this);
+      copy.M.Zero();
+      copy.Z.Zero();
+      std::array<byte_t, MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+      llarp_buffer_t buf(tmp);
+      if (!copy.BEncode(&buf))
+      {
+        LogError("frame too big to encode");
+        return false;
+      }
+      // rewind
+      buf.sz = buf.cur - buf.base;
+      buf.cur = buf.base;
+      // key the mac per frame from the session key and the frame's nonce so the cipher and the mac
+      // never use the same key, and per direction from the sender so neither end takes its own
+      // frames for the other's
+      std::array<byte_t, KeyExchangeNonce::SIZE + Address::SIZE> keyInput;
+      std::copy(copy.N.begin(), copy.N.end(), keyInput.begin());
+      std::copy(sender.begin(), sender.end(), keyInput.begin() + copy.N.size());
+      SharedSecret macKey;
+      if (!crypto->hmac(macKey.data(), llarp_buffer_t{keyInput}, sessionKey))
+        return false;
+      return crypto->hmac(mac.data(), buf, macKey);
+    }
+
+    bool
+    ProtocolFrame::VerifyMAC(const SharedSecret& sessionKey, const Address& sender) const
+    {
+      MAC_t mac;
+      if (!ComputeMAC(sessionKey, sender, mac))
+        return false;
+      // compare in constant time
+      byte_t diff = 0;
+      for (size_t idx = 0; idx < mac.size(); ++idx)
+        diff |= mac[idx] ^ M[idx];
+      return diff == 0;
+    }
+
     struct AsyncFrameDecrypt
     {
       path::Path_ptr path;
@@ -398,6 +483,7 @@ namespace llarp
       F = other.F;
       N = other.N;
       Z = other.Z;
+      M = other.M;
       T = other.T;
       R = other.R;
       S = other.S;
@@ -405,13 +491,6 @@ namespace llarp
       return *this;
     }
 
-    struct AsyncDecrypt
-    {
-      ServiceInfo si;
-      SharedSecret shared;
-      ProtocolFrame frame;
-    };
-
     bool
     ProtocolFrame::AsyncDecryptAndVerify(
         EventLoop_ptr loop,
@@ -420,10 +499,10 @@ namespace llarp
         Endpoint* handler,
         std::function<void(std::shared_ptr<ProtocolMessage>)> hook) const
     {
-      auto msg = std::make_shared<ProtocolMessage>();
-      msg->handler = handler;
       if (T.IsZero())
       {
+        auto msg = std::make_shared<ProtocolMessage>();
+        msg->handler = handler;
         // we need to dh
         auto dh = std::make_shared<AsyncFrameDecrypt>(
             loop, localIdent, handler, msg, *this, recvPath->intro);
@@ -432,71 +511,39 @@ namespace llarp
         return true;
       }
 
-      auto v = std::make_shared<AsyncDecrypt>();
-
-      if (!handler->GetCachedSessionKeyFor(T, v->shared))
+      SharedSecret shared;
+      if (!handler->GetCachedSessionKeyFor(T, shared))
       {
         LogError("No cached session for T=", T);
         return false;
       }
-      if (v->shared.IsZero())
+      if (shared.IsZero())
       {
         LogError("bad cached session key for T=", T);
         return false;
       }
 
-      if (!handler->GetSenderFor(T, v->si))
+      ServiceInfo si;
+      if (!handler->GetSenderFor(T, si))
       {
         LogError("No sender for T=", T);
         return false;
       }
-      if (v->si.Addr().IsZero())
+      if (si.Addr().IsZero())
       {
         LogError("Bad sender for T=", T);
         return false;
       }
 
-      v->frame = *this;
-      auto callback = [loop, hook](std::shared_ptr<ProtocolMessage> msg) {
-        if (hook)
-        {
-          loop->call([msg, hook]() { hook(msg); });
-        }
-      };
-      handler->Router()->QueueWork(
-          [v, msg = std::move(msg), recvPath = std::move(recvPath), callback, handler]() {
-            auto resetTag = [handler, tag = v->frame.T, from = v->frame.F, path = recvPath]() {
-              handler->ResetConvoTag(tag, path, from);
-            };
-
-            if (not v->frame.Verify(v->si))
-            {
-              LogError("Signature failure from ", v->si.Addr());
-              handler->Loop()->call_soon(resetTag);
-              return;
-            }
-            if (not v->frame.DecryptPayloadInto(v->shared, *msg))
-            {
-              LogError("failed to decrypt message from ", v->si.Addr());
-              handler->Loop()->call_soon(resetTag);
-              return;
-            }
-            callback(msg);
-            RecvDataEvent ev;
-            ev.fromPath = std::move(recvPath);
-            ev.pathid = v->frame.F;
-            auto* handler = msg->handler;
-            ev.msg = std::move(msg);
-            handler->QueueRecvData(std::move(ev));
-          });
+      handler->InboundFrames().Push(std::move(recvPath), *this, shared, si, std::move(hook));
       return true;
     }
 
     bool
     ProtocolFrame::operator==(const ProtocolFrame& other) const
     {
-      return C == other.C && D == other.D && N == other.N && Z == other.Z && T == other.T
-          && S == other.S && version == other.version;
+      return C == other.C && D == other.D && N == other.N && Z == other.Z && M == other.M
+          && T == other.T && S == other.S && version == other.version;
     }
 
     bool
@@ -31,6 +31,13 @@ namespace llarp
 
     constexpr std::size_t MAX_PROTOCOL_MESSAGE_SIZE = 2048 * 2;
 
+    /// version of the inner protocol message we send.  a remote that sends us version 1 or later
+    /// takes data frames on an established convo tag that are authenticated with a mac keyed from
+    /// the session key instead of an ed25519 signature.
+    constexpr uint64_t PROTOCOL_MESSAGE_VERSION = 1;
+    /// first protocol message version that takes mac authenticated data frames
+    constexpr uint64_t SESSION_MAC_VERSION = 1;
+
     /// inner message
     struct ProtocolMessage
     {
@@ -45,7 +52,7 @@ namespace llarp
       Endpoint* handler = nullptr;
       ConvoTag tag;
       uint64_t seqno = 0;
-      uint64_t version = llarp::constants::proto_version;
+      uint64_t version = PROTOCOL_MESSAGE_VERSION;
 
       /// encode metainfo for lmq endpoint auth
       std::vector<char>
@@ -74,11 +81,14 @@ namespace llarp
     struct ProtocolFrame final : public routing::IMessage
     {
       using Encrypted_t = Encrypted<2048>;
+      using MAC_t = AlignedBuffer<HMACSIZE>;
       PQCipherBlock C;
       Encrypted_t D;
       uint64_t R;
       KeyExchangeNonce N;
       Signature Z;
+      /// session mac, set instead of Z on data frames sent on an established convo tag
+      MAC_t M;
       PathID_t F;
       service::ConvoTag T;
 
@@ -89,6 +99,7 @@ namespace llarp
           , R(other.R)
           , N(other.N)
           , Z(other.Z)
+          , M(other.M)
           , F(other.F)
           , T(other.T)
       {
@@ -119,6 +130,11 @@ namespace llarp
       EncryptAndSign(
           const ProtocolMessage& msg, const SharedSecret& sharedkey, const Identity& localIdent);
 
+      /// encrypt msg with the session key and authenticate the frame with a mac keyed from it and
+      /// from msg's sender, only for data frames on a convo tag whose remote end takes them
+      bool
+      EncryptAndMAC(const ProtocolMessage& msg, const SharedSecret& sessionKey);
+
       bool
       Sign(const Identity& localIdent);
 
@@ -154,6 +170,7 @@ namespace llarp
         T.Zero();
         N.Zero();
         Z.Zero();
+        M.Zero();
         R = 0;
         version = llarp::constants::proto_version;
       }
@@ -161,6 +178,23 @@ namespace llarp
       bool
       Verify(const ServiceInfo& from) const;
 
+      /// true if this frame is authenticated with a session mac instead of a signature
+      bool
+      HasMAC() const
+      {
+        return not M.IsZero();
+      }
+
+      /// check the session mac of a frame that sender sent us.  both ends share the session key,
+      /// so the mac is also keyed from the sender and a frame of ours bounced back at us fails
+      bool
+      VerifyMAC(const SharedSecret& sessionKey, const Address& sender) const;
+
+     private:
+      /// compute the session mac of sender over this frame with M and Z zeroed
+      bool
+      ComputeMAC(const SharedSecret& sessionKey, const Address& sender, MAC_t& mac) const;
+
       bool
       HandleMessage(routing::IMessageHandler* h, AbstractRouter* r) const override;
     };
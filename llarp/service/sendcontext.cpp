@@ -112,10 +112,14 @@ namespace llarp
       m->sender = m_Endpoint->GetIdentity().pub;
       m->tag = f->T;
       m->PutBuffer(payload);
-      m_Endpoint->Router()->QueueWork([f, m, shared, path, this] {
-        if (not f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity()))
+      // once the remote told us it can, data frames carry a session mac rather than a signature
+      const bool useMAC = m_Endpoint->ConvoTakesSessionMAC(f->T);
+      m_Endpoint->Router()->QueueWork([f, m, shared, path, useMAC, this] {
+        const bool sealed = useMAC ? f->EncryptAndMAC(*m, shared)
+                                   : f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity());
+        if (not sealed)
         {
-          LogError(m_PathSet->Name(), " failed to sign message");
+          LogError(m_PathSet->Name(), " failed to ", useMAC ? "mac" : "sign", " message");
           return;
         }
         Send(f, path);
@@ -15,6 +15,7 @@ namespace llarp
           {"seqno", seqno},
           {"tx", messagesSend},
           {"rx", messagesRecv},
+          {"remoteVersion", remoteVersion},
           {"intro", intro.ExtractStatus()}};
       return obj;
     }
@@ -30,6 +30,9 @@ namespace llarp
       /// number of remote messages we got from them
       uint64_t messagesRecv = 0;
 
+      /// protocol message version of the last message they sent us
+      uint64_t remoteVersion = 0;
+
       bool inbound = false;
       bool forever = false;
 
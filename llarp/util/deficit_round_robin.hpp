@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// shares out sending between flows by bytes with deficit round robin (shreedhar & varghese).
+    /// each flow with something queued gets Quantum bytes per round and may go over by one entry,
+    /// which it pays back the next round, so a flow of large entries gets no more than a flow of
+    /// small ones.  only flows with something queued are visited and a flow is forgotten as soon
+    /// as it empties.  entries in one flow go out in the order they came in.  not thread safe.
+    template <typename Flow_t, typename Entry_t, typename Hash_t = std::hash<Flow_t>>
+    struct DeficitRoundRobin
+    {
+      explicit DeficitRoundRobin(size_t quantum) : Quantum{quantum}
+      {}
+
+      /// bytes each flow may send per round
+      const size_t Quantum;
+
+      /// queue ent of size bytes on flow, false and ent left alone if flow already holds
+      /// maxQueued entries
+      bool
+      Push(const Flow_t& flow, Entry_t& ent, size_t bytes, size_t maxQueued = SIZE_MAX)
+      {
+        auto [itr, isNew] = m_Flows.try_emplace(flow);
+        auto& queue = itr->second;
+        if (queue.entries.size() >= maxQueued)
+          return false;
+        if (isNew)
+          m_Active.push_back(flow);
+        queue.entries.emplace_back(std::move(ent), bytes);
+        m_Queued++;
+        m_Bytes += bytes;
+        return true;
+      }
+
+      /// take the next entry that is due and its size, nullopt if nothing is queued
+      std::optional<std::pair<Entry_t, size_t>>
+      Pop()
+      {
+        while (not m_Active.empty())
+        {
+          auto itr = m_Flows.find(m_Active.front());
+          auto& queue = itr->second;
+          if (not m_TurnStarted)
+          {
+            queue.deficit += static_cast<int64_t>(Quantum);
+            m_TurnStarted = true;
+          }
+          if (queue.deficit <= 0)
+          {
+            // still paying back what it went over last round
+            auto flow = std::move(m_Active.front());
+            NextTurn();
+            m_Active.push_back(std::move(flow));
+            continue;
+          }
+          auto entry = std::move(queue.entries.front());
+          queue.entries.pop_front();
+          queue.deficit -= static_cast<int64_t>(entry.second);
+          m_Queued--;
+          m_Bytes -= entry.second;
+          if (queue.entries.empty())
+          {
+            m_Flows.erase(itr);
+            NextTurn();
+          }
+          return entry;
+        }
+        return std::nullopt;
+      }
+
+      /// drop everything queued on flow, calling dropped(ent) on each entry
+      template <typename Visit_t>
+      void
+      Remove(const Flow_t& flow, Visit_t&& dropped)
+      {
+        auto itr = m_Flows.find(flow);
+        if (itr == m_Flows.end())
+          return;
+        for (auto& [ent, bytes] : itr->second.entries)
+        {
+          m_Queued--;
+          m_Bytes -= bytes;
+          dropped(std::move(ent));
+        }
+        m_Flows.erase(itr);
+        for (auto active = m_Active.begin(); active != m_Active.end(); ++active)
+        {
+          if (*active != flow)
+            continue;
+          if (active == m_Active.begin())
+            m_TurnStarted = false;
+          m_Active.erase(active);
+          break;
+        }
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Active.empty();
+      }
+
+      /// how many entries are queued
+      size_t
+      Queued() const
+      {
+        return m_Queued;
+      }
+
+      /// how many entries are queued on flow
+      size_t
+      Queued(const Flow_t& flow) const
+      {
+        auto itr = m_Flows.find(flow);
+        return itr == m_Flows.end() ? 0 : itr->second.entries.size();
+      }
+
+      /// how many bytes are queued
+      size_t
+      Bytes() const
+      {
+        return m_Bytes;
+      }
+
+      /// how many flows have something queued
+      size_t
+      Flows() const
+      {
+        return m_Active.size();
+      }
+
+     private:
+      struct FlowQueue
+      {
+        std::deque<std::pair<Entry_t, size_t>> entries;
+        /// bytes the flow may still send this round, below 0 if it went over
+        int64_t deficit = 0;
+      };
+
+      /// the flow at the front of m_Active is done for this round
+      void
+      NextTurn()
+      {
+        m_Active.pop_front();
+        m_TurnStarted = false;
+      }
+
+      std::unordered_map<Flow_t, FlowQueue, Hash_t> m_Flows;
+      /// flows with something queued in the order they get their turn
+      std::deque<Flow_t> m_Active;
+      /// the flow at the front of m_Active got its quantum for this round
+      bool m_TurnStarted = false;
+      size_t m_Queued = 0;
+      size_t m_Bytes = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
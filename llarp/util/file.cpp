@@ -61,6 +61,62 @@ namespace llarp::util
     out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
   }
 
+  void
+  replace_file(const fs::path& filename, std::string_view contents)
+  {
+    auto tmp = filename;
+    tmp += ".tmp";
+    try
+    {
+#ifdef WIN32
+      dump_file(tmp, contents);
+#else
+      const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+      if (fd == -1)
+        throw std::system_error{errno, std::system_category(), "cannot open " + tmp.string()};
+      size_t written = 0;
+      while (written < contents.size())
+      {
+        const auto n = ::write(fd, contents.data() + written, contents.size() - written);
+        if (n == -1 and errno == EINTR)
+          continue;
+        if (n == -1)
+        {
+          const int err = errno;
+          ::close(fd);
+          throw std::system_error{err, std::system_category(), "cannot write " + tmp.string()};
+        }
+        written += n;
+      }
+      if (::fsync(fd) == -1)
+      {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error{err, std::system_category(), "cannot sync " + tmp.string()};
+      }
+      ::close(fd);
+#endif
+      fs::rename(tmp, filename);
+    }
+    catch (...)
+    {
+      std::error_code ec;
+      fs::remove(tmp, ec);
+      throw;
+    }
+#ifndef WIN32
+    // the rename only survives a crash once the directory entry is on disk as well
+    auto dir = filename.parent_path();
+    if (dir.empty())
+      dir = ".";
+    if (const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY); fd != -1)
+    {
+      ::fsync(fd);
+      ::close(fd);
+    }
+#endif
+  }
+
   static std::error_code
   errno_error()
   {
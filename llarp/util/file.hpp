@@ -45,6 +45,13 @@ namespace llarp::util
         filename, std::string_view{reinterpret_cast<const char*>(buffer), buffer_size});
   }
 
+  /// Replaces filename with contents without ever leaving a half written file behind: the
+  /// contents go to a temporary file next to it that is synced to disk before it is renamed over
+  /// filename, and the rename is synced too.  Not safe to call for the same file from more than one
+  /// thread at a time.  Throws on error.
+  void
+  replace_file(const fs::path& filename, std::string_view contents);
+
   struct FileHash
   {
     size_t
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "status.hpp"
+#include "time.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// counts how long something took into a fixed set of log scaled buckets so we can show the
+    /// shape of a latency in the status without keeping samples around.  not thread safe.
+    struct LatencyHistogram
+    {
+      using Time_t = std::chrono::microseconds;
+
+      /// upper bound of each bucket, anything slower than the last bound goes in one extra bucket
+      static constexpr std::array<Time_t, 10> Bounds{
+          100us, 250us, 500us, 1ms, 2500us, 5ms, 10ms, 25ms, 50ms, 100ms};
+
+      void
+      Add(Time_t t)
+      {
+        t = std::max(t, Time_t{0});
+        const auto itr = std::lower_bound(Bounds.begin(), Bounds.end(), t);
+        m_Buckets[itr - Bounds.begin()]++;
+        m_Count++;
+        m_Total += t;
+        m_Max = std::max(m_Max, t);
+      }
+
+      uint64_t
+      Count() const
+      {
+        return m_Count;
+      }
+
+      /// how many samples went into bucket idx, idx Bounds.size() is the overflow bucket
+      uint64_t
+      BucketCount(size_t idx) const
+      {
+        return m_Buckets.at(idx);
+      }
+
+      Time_t
+      Max() const
+      {
+        return m_Max;
+      }
+
+      Time_t
+      Mean() const
+      {
+        if (m_Count == 0)
+          return Time_t{0};
+        return m_Total / static_cast<Time_t::rep>(m_Count);
+      }
+
+      void
+      Clear()
+      {
+        *this = LatencyHistogram{};
+      }
+
+      StatusObject
+      ExtractStatus() const
+      {
+        StatusObject bounds = StatusObject::array();
+        for (const auto& bound : Bounds)
+          bounds.push_back(bound.count());
+        return StatusObject{
+            {"count", m_Count},
+            {"meanUS", Mean().count()},
+            {"maxUS", m_Max.count()},
+            {"boundsUS", bounds},
+            {"buckets", m_Buckets}};
+      }
+
+     private:
+      std::array<uint64_t, Bounds.size() + 1> m_Buckets{};
+      uint64_t m_Count = 0;
+      Time_t m_Total{0};
+      Time_t m_Max{0};
+    };
+  }  // namespace util
+}  // namespace llarp
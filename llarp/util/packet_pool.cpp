@@ -0,0 +1,312 @@
+#include "packet_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace llarp
+{
+  namespace
+  {
+    std::atomic<uint64_t> pool_hits{0};
+    std::atomic<uint64_t> pool_misses{0};
+    std::atomic<uint64_t> pool_oversized{0};
+    std::atomic<uint64_t> pool_outstanding{0};
+  }  // namespace
+
+  PacketBuffer::Slab*
+  PacketPool::AllocSlab(size_t capacity, PacketPool* pool)
+  {
+    void* mem = ::operator new(sizeof(PacketBuffer::Slab) + capacity);
+    return new (mem) PacketBuffer::Slab{{0}, pool, capacity};
+  }
+
+  void
+  PacketPool::FreeSlab(PacketBuffer::Slab* slab)
+  {
+    slab->~Slab();
+    ::operator delete(slab);
+  }
+
+  PacketBuffer::PacketBuffer(const PacketBuffer& other)
+      : m_Slab{other.m_Slab}, m_Offset{other.m_Offset}, m_Size{other.m_Size}
+  {
+    if (m_Slab)
+      m_Slab->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  PacketBuffer::PacketBuffer(PacketBuffer&& other) noexcept
+      : m_Slab{other.m_Slab}, m_Offset{other.m_Offset}, m_Size{other.m_Size}
+  {
+    other.m_Slab = nullptr;
+    other.m_Offset = 0;
+    other.m_Size = 0;
+  }
+
+  PacketBuffer&
+  PacketBuffer::operator=(const PacketBuffer& other)
+  {
+    if (this != &other)
+    {
+      if (other.m_Slab)
+        other.m_Slab->refs.fetch_add(1, std::memory_order_relaxed);
+      release();
+      m_Slab = other.m_Slab;
+      m_Offset = other.m_Offset;
+      m_Size = other.m_Size;
+    }
+    return *this;
+  }
+
+  PacketBuffer&
+  PacketBuffer::operator=(PacketBuffer&& other) noexcept
+  {
+    if (this != &other)
+    {
+      release();
+      m_Slab = other.m_Slab;
+      m_Offset = other.m_Offset;
+      m_Size = other.m_Size;
+      other.m_Slab = nullptr;
+      other.m_Offset = 0;
+      other.m_Size = 0;
+    }
+    return *this;
+  }
+
+  PacketBuffer::~PacketBuffer()
+  {
+    release();
+  }
+
+  void
+  PacketBuffer::release()
+  {
+    if (m_Slab == nullptr)
+      return;
+    if (m_Slab->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      if (m_Slab->pool)
+        m_Slab->pool->Return(m_Slab);
+      else
+      {
+        pool_outstanding--;
+        PacketPool::FreeSlab(m_Slab);
+      }
+    }
+    m_Slab = nullptr;
+    m_Offset = 0;
+    m_Size = 0;
+  }
+
+  byte_t*
+  PacketBuffer::data()
+  {
+    return m_Slab ? m_Slab->data() + m_Offset : nullptr;
+  }
+
+  const byte_t*
+  PacketBuffer::data() const
+  {
+    return m_Slab ? m_Slab->data() + m_Offset : nullptr;
+  }
+
+  size_t
+  PacketBuffer::capacity() const
+  {
+    return m_Slab ? m_Slab->capacity - m_Offset : 0;
+  }
+
+  void
+  PacketBuffer::resize(size_t sz)
+  {
+    assert(sz <= capacity());
+    m_Size = std::min(sz, capacity());
+  }
+
+  bool
+  PacketBuffer::push_front(size_t len)
+  {
+    if (len > m_Offset)
+      return false;
+    m_Offset -= len;
+    m_Size += len;
+    return true;
+  }
+
+  void
+  PacketBuffer::pull_front(size_t len)
+  {
+    assert(len <= m_Size);
+    len = std::min(len, m_Size);
+    m_Offset += len;
+    m_Size -= len;
+  }
+
+  PacketBuffer
+  PacketBuffer::slice(size_t off, size_t len) const
+  {
+    assert(off + len <= m_Size);
+    PacketBuffer sliced{*this};
+    sliced.m_Offset += off;
+    sliced.m_Size = len;
+    return sliced;
+  }
+
+  std::vector<byte_t>
+  PacketBuffer::copy() const
+  {
+    return std::vector<byte_t>{begin(), end()};
+  }
+
+  std::vector<byte_t>
+  PacketBuffer::take()
+  {
+    std::vector<byte_t> out;
+    if (m_Slab and m_Offset == 0 and not m_Slab->adopted.empty() and use_count() == 1)
+    {
+      out = std::move(m_Slab->adopted);
+      out.resize(m_Size);
+    }
+    else
+      out = copy();
+    release();
+    return out;
+  }
+
+  size_t
+  PacketBuffer::use_count() const
+  {
+    return m_Slab ? m_Slab->refs.load(std::memory_order_relaxed) : 0;
+  }
+
+  /// owns the calling thread's pool and orphans it when the thread goes away
+  struct PacketPool::LocalHolder
+  {
+    PacketPool* pool;
+
+    LocalHolder(size_t slabSize, size_t maxFree) : pool{new PacketPool{slabSize, maxFree}}
+    {}
+
+    ~LocalHolder()
+    {
+      pool->Orphan();
+    }
+  };
+
+  PacketPool&
+  PacketPool::Local()
+  {
+    static thread_local LocalHolder holder{SlabSize, MaxFreeSlabs};
+    return *holder.pool;
+  }
+
+  PacketPool&
+  PacketPool::LocalLarge()
+  {
+    static thread_local LocalHolder holder{LargeSlabSize, MaxFreeLargeSlabs};
+    return *holder.pool;
+  }
+
+  PacketPool::~PacketPool()
+  {
+    for (auto* slab : m_Free)
+      FreeSlab(slab);
+  }
+
+  PacketBuffer
+  PacketPool::Acquire(size_t sz, size_t headroom)
+  {
+    PacketBuffer::Slab* slab{nullptr};
+    if (sz + headroom > m_SlabSize)
+    {
+      pool_oversized++;
+      slab = AllocSlab(sz + headroom, nullptr);
+    }
+    else
+    {
+      {
+        std::unique_lock lock{m_Mutex};
+        if (not m_Free.empty())
+        {
+          slab = m_Free.back();
+          m_Free.pop_back();
+        }
+        m_Outstanding++;
+      }
+      if (slab)
+        pool_hits++;
+      else
+      {
+        pool_misses++;
+        slab = AllocSlab(m_SlabSize, this);
+      }
+    }
+    pool_outstanding++;
+    slab->refs.store(1, std::memory_order_relaxed);
+    return PacketBuffer{slab, sz, headroom};
+  }
+
+  PacketBuffer
+  PacketPool::Copy(const byte_t* ptr, size_t sz, size_t headroom)
+  {
+    auto buf = Acquire(sz, headroom);
+    std::copy_n(ptr, sz, buf.data());
+    return buf;
+  }
+
+  PacketBuffer
+  PacketPool::Adopt(std::vector<byte_t>&& vec)
+  {
+    auto* slab = AllocSlab(0, nullptr);
+    slab->adopted = std::move(vec);
+    slab->capacity = slab->adopted.size();
+    pool_outstanding++;
+    slab->refs.store(1, std::memory_order_relaxed);
+    return PacketBuffer{slab, slab->capacity};
+  }
+
+  void
+  PacketPool::Return(PacketBuffer::Slab* slab)
+  {
+    pool_outstanding--;
+    bool last{false};
+    {
+      std::unique_lock lock{m_Mutex};
+      m_Outstanding--;
+      if (not m_Orphaned and m_Free.size() < m_MaxFree)
+      {
+        if (m_Free.capacity() == 0)
+          m_Free.reserve(m_MaxFree);
+        m_Free.push_back(slab);
+        slab = nullptr;
+      }
+      last = m_Orphaned and m_Outstanding == 0;
+    }
+    if (slab)
+      FreeSlab(slab);
+    if (last)
+      delete this;
+  }
+
+  void
+  PacketPool::Orphan()
+  {
+    bool last{false};
+    {
+      std::unique_lock lock{m_Mutex};
+      m_Orphaned = true;
+      last = m_Outstanding == 0;
+    }
+    if (last)
+      delete this;
+  }
+
+  PacketPool::Stats
+  PacketPool::GlobalStats()
+  {
+    return Stats{
+        pool_hits.load(), pool_misses.load(), pool_oversized.load(), pool_outstanding.load()};
+  }
+
+}  // namespace llarp
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "buffer.hpp"
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace llarp
+{
+  class PacketPool;
+
+  /// Refcounted handle to a packet sized chunk of memory handed out by a PacketPool.  Copies share
+  /// the same memory; the memory goes back to the pool it came from when the last handle referring
+  /// to it goes away, which may happen on any thread.  Each handle has its own view (offset and
+  /// size) into the underlying memory, so slices of one packet can be passed around without
+  /// copying.
+  class PacketBuffer
+  {
+   public:
+    PacketBuffer() = default;
+
+    PacketBuffer(const PacketBuffer& other);
+    PacketBuffer(PacketBuffer&& other) noexcept;
+
+    PacketBuffer&
+    operator=(const PacketBuffer& other);
+    PacketBuffer&
+    operator=(PacketBuffer&& other) noexcept;
+
+    ~PacketBuffer();
+
+    byte_t*
+    data();
+
+    const byte_t*
+    data() const;
+
+    size_t
+    size() const
+    {
+      return m_Size;
+    }
+
+    bool
+    empty() const
+    {
+      return m_Size == 0;
+    }
+
+    /// how far this view can grow with resize()
+    size_t
+    capacity() const;
+
+    /// change the size of our view, cannot grow past capacity()
+    void
+    resize(size_t sz);
+
+    /// how many bytes of the underlying memory sit in front of our view
+    size_t
+    headroom() const
+    {
+      return m_Offset;
+    }
+
+    /// grow our view by len bytes at the front, into our headroom.  the memory is shared with every
+    /// copy of this handle so only do this while we are the only one.  returns false if we do not
+    /// have the headroom.
+    bool
+    push_front(size_t len);
+
+    /// shrink our view by len bytes at the front, they become headroom
+    void
+    pull_front(size_t len);
+
+    byte_t&
+    operator[](size_t idx)
+    {
+      return data()[idx];
+    }
+
+    byte_t
+    operator[](size_t idx) const
+    {
+      return data()[idx];
+    }
+
+    byte_t*
+    begin()
+    {
+      return data();
+    }
+    byte_t*
+    end()
+    {
+      return data() + m_Size;
+    }
+    const byte_t*
+    begin() const
+    {
+      return data();
+    }
+    const byte_t*
+    end() const
+    {
+      return data() + m_Size;
+    }
+
+    /// make a new handle sharing our memory that only sees len bytes starting at offset off
+    PacketBuffer
+    slice(size_t off, size_t len) const;
+
+    /// copy our view into a vector
+    std::vector<byte_t>
+    copy() const;
+
+    /// move our view out into a vector and let go of our memory.  when we are the only handle to
+    /// memory adopted from a vector and our view starts at its front we hand that vector back
+    /// without copying, otherwise this is copy().
+    std::vector<byte_t>
+    take();
+
+    /// number of handles sharing this memory
+    size_t
+    use_count() const;
+
+    explicit operator bool() const
+    {
+      return m_Slab != nullptr;
+    }
+
+    // Implicit conversion so that a PacketBuffer can be passed to anything taking a llarp_buffer_t
+    operator llarp_buffer_t()
+    {
+      return {data(), m_Size};
+    }
+
+   private:
+    friend class PacketPool;
+
+    struct Slab
+    {
+      std::atomic<uint32_t> refs;
+      /// the pool we go back to, nullptr if we are a one off allocation
+      PacketPool* pool;
+      size_t capacity;
+      /// the memory we hand out when we were made by PacketPool::Adopt, otherwise it follows us
+      std::vector<byte_t> adopted;
+
+      byte_t*
+      data()
+      {
+        return adopted.empty() ? reinterpret_cast<byte_t*>(this + 1) : adopted.data();
+      }
+    };
+
+    explicit PacketBuffer(Slab* slab, size_t sz, size_t off = 0)
+        : m_Slab{slab}, m_Offset{off}, m_Size{sz}
+    {}
+
+    void
+    release();
+
+    Slab* m_Slab{nullptr};
+    size_t m_Offset{0};
+    size_t m_Size{0};
+  };
+
+  /// Pool of fixed size slabs backing PacketBuffer.  Every thread gets its own pool of MTU sized
+  /// slabs via PacketPool::Local() and one of link message sized slabs via
+  /// PacketPool::LocalLarge(); buffers can be released from any thread and go back to the pool
+  /// that handed them out.
+  /// Requests bigger than a slab fall through to a one off heap allocation.
+  class PacketPool
+  {
+   public:
+    /// size of a pooled slab, big enough for any link layer packet on a 1500 mtu network
+    static constexpr size_t SlabSize = 2048;
+    /// how many unused slabs a pool keeps around before giving memory back to the system
+    static constexpr size_t MaxFreeSlabs = 4096;
+    /// size of a slab in the large pools, big enough for a whole link message
+    static constexpr size_t LargeSlabSize = 8192;
+    static constexpr size_t MaxFreeLargeSlabs = 512;
+
+    struct Stats
+    {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t oversized;
+      uint64_t outstanding;
+    };
+
+    /// get the pool of SlabSize slabs for the calling thread
+    static PacketPool&
+    Local();
+
+    /// get the pool of LargeSlabSize slabs for the calling thread
+    static PacketPool&
+    LocalLarge();
+
+    /// get a buffer of sz bytes with uninitialized contents, with headroom bytes free in front of
+    /// it to grow into
+    PacketBuffer
+    Acquire(size_t sz = SlabSize, size_t headroom = 0);
+
+    /// get a buffer holding a copy of sz bytes at ptr
+    PacketBuffer
+    Copy(const byte_t* ptr, size_t sz, size_t headroom = 0);
+
+    /// get a buffer that takes over the memory of vec without copying it.  it is a one off
+    /// allocation with no headroom.
+    static PacketBuffer
+    Adopt(std::vector<byte_t>&& vec);
+
+    /// counters summed over every pool in the process
+    static Stats
+    GlobalStats();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool(PacketPool&&) = delete;
+
+   private:
+    friend class PacketBuffer;
+    struct LocalHolder;
+
+    PacketPool(size_t slabSize, size_t maxFree) : m_SlabSize{slabSize}, m_MaxFree{maxFree}
+    {}
+    ~PacketPool();
+
+    static PacketBuffer::Slab*
+    AllocSlab(size_t capacity, PacketPool* pool);
+
+    static void
+    FreeSlab(PacketBuffer::Slab* slab);
+
+    /// called when the last handle to a slab we handed out goes away
+    void
+    Return(PacketBuffer::Slab* slab);
+
+    /// called when the owning thread exits, we stay alive until every outstanding slab is back
+    void
+    Orphan();
+
+    const size_t m_SlabSize;
+    const size_t m_MaxFree;
+    std::mutex m_Mutex;
+    std::vector<PacketBuffer::Slab*> m_Free;
+    size_t m_Outstanding{0};
+    bool m_Orphaned{false};
+  };
+
+}  // namespace llarp
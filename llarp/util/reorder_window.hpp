@@ -0,0 +1,236 @@
+#pragma once
+
+#include "time.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// puts values that carry a sequence number back into order, separately for each flow.
+    /// a value that comes in ahead of a gap in its flow is held until the gap fills, until it has
+    /// waited MaxDelay or until the flow holds MaxHeld values, whichever comes first; after that we
+    /// give up on the gap.  flows do not wait on each other.  not thread safe.
+    template <typename Key_t, typename Val_t, typename Hash_t = std::hash<Key_t>>
+    struct ReorderWindows
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      explicit ReorderWindows(Time_t maxDelay = 10ms, size_t maxHeld = 64)
+          : MaxDelay{maxDelay}, MaxHeld{maxHeld}
+      {}
+
+      /// longest we hold a value waiting on a gap before it
+      const Time_t MaxDelay;
+      /// most values one flow holds at once
+      const size_t MaxHeld;
+      /// flows with nothing held that we have not heard from for this long are forgotten
+      static constexpr Time_t IdleTimeout = 1min;
+
+      /// take val numbered seqno on flow at now and call release(val) for everything that can go
+      /// out in order because of it, val included
+      template <typename Release_t>
+      void
+      Push(const Key_t& flow, uint64_t seqno, Val_t val, Time_t now, Release_t&& release)
+      {
+        Take(flow, seqno, std::optional<Val_t>{std::move(val)}, now, release);
+      }
+
+      /// seqno on flow was used up by something that never comes through here, stop waiting on
+      /// it and call release(val) for everything that can go out in order because of it
+      template <typename Release_t>
+      void
+      Pass(const Key_t& flow, uint64_t seqno, Time_t now, Release_t&& release)
+      {
+        Take(flow, seqno, std::nullopt, now, release);
+      }
+
+      /// give up on the gaps that values have waited on for MaxDelay, calling release(val) on
+      /// everything that goes out because of it, and forget idle flows
+      template <typename Release_t>
+      void
+      Expire(Time_t now, Release_t&& release)
+      {
+        auto itr = m_Flows.begin();
+        while (itr != m_Flows.end())
+        {
+          auto& window = itr->second;
+          if (not window.held.empty() and window.oldest + MaxDelay <= now)
+          {
+            // everything up to the newest value that timed out goes
+            uint64_t upto = window.held.begin()->first;
+            for (const auto& [seqno, held] : window.held)
+            {
+              if (held.queued + MaxDelay <= now)
+                upto = seqno;
+            }
+            Skip(window, upto, release);
+          }
+          if (window.held.empty() and window.lastActive + IdleTimeout <= now)
+            itr = m_Flows.erase(itr);
+          else
+            ++itr;
+        }
+      }
+
+      /// when the next held value times out, nullopt if we hold nothing
+      std::optional<Time_t>
+      NextExpiry() const
+      {
+        if (m_Held == 0)
+          return std::nullopt;
+        std::optional<Time_t> next;
+        for (const auto& [flow, window] : m_Flows)
+        {
+          if (not window.held.empty() and (not next or window.oldest < *next))
+            next = window.oldest;
+        }
+        return *next + MaxDelay;
+      }
+
+      /// how many values and passed seqnos are held waiting on a gap
+      size_t
+      Held() const
+      {
+        return m_Held;
+      }
+
+      size_t
+      Flows() const
+      {
+        return m_Flows.size();
+      }
+
+      /// how many gaps we stopped waiting on
+      uint64_t
+      Skipped() const
+      {
+        return m_Skipped;
+      }
+
+      /// how many values came in after we stopped waiting on them
+      uint64_t
+      Late() const
+      {
+        return m_Late;
+      }
+
+     private:
+      struct Waiting
+      {
+        /// nullopt for a seqno that was passed, it only holds its place
+        std::optional<Val_t> val;
+        Time_t queued;
+      };
+
+      struct Window
+      {
+        uint64_t next = 0;
+        std::map<uint64_t, Waiting> held;
+        /// when the longest held value was queued
+        Time_t oldest = 0s;
+        Time_t lastActive = 0s;
+      };
+
+      template <typename Release_t>
+      void
+      Take(
+          const Key_t& flow,
+          uint64_t seqno,
+          std::optional<Val_t> val,
+          Time_t now,
+          Release_t& release)
+      {
+        auto [itr, isNew] = m_Flows.try_emplace(flow);
+        auto& window = itr->second;
+        window.lastActive = now;
+        if (isNew or seqno == window.next)
+        {
+          window.next = seqno + 1;
+          Release(val, release);
+          Drain(window, release);
+          return;
+        }
+        if (seqno < window.next)
+        {
+          // we already gave up waiting on this one, better late than never
+          if (val)
+            m_Late++;
+          Release(val, release);
+          return;
+        }
+        if (not window.held.try_emplace(seqno, Waiting{std::move(val), now}).second)
+          return;
+        m_Held++;
+        window.oldest = window.held.size() == 1 ? now : std::min(window.oldest, now);
+        if (window.held.size() > MaxHeld)
+          Skip(window, window.held.begin()->first, release);
+      }
+
+      template <typename Release_t>
+      static void
+      Release(std::optional<Val_t>& val, Release_t& release)
+      {
+        if (val)
+          release(std::move(*val));
+      }
+
+      /// release everything held at the front of window that is now in order
+      template <typename Release_t>
+      void
+      Drain(Window& window, Release_t& release)
+      {
+        auto itr = window.held.begin();
+        while (itr != window.held.end() and itr->first == window.next)
+        {
+          window.next++;
+          Release(itr->second.val, release);
+          itr = window.held.erase(itr);
+          m_Held--;
+        }
+        Reset(window);
+      }
+
+      /// stop waiting on the gaps up to upto, releasing everything held up to it and whatever
+      /// comes in order after it
+      template <typename Release_t>
+      void
+      Skip(Window& window, uint64_t upto, Release_t& release)
+      {
+        auto itr = window.held.begin();
+        while (itr != window.held.end() and itr->first <= upto)
+        {
+          if (itr->first != window.next)
+            m_Skipped++;
+          window.next = itr->first + 1;
+          Release(itr->second.val, release);
+          itr = window.held.erase(itr);
+          m_Held--;
+        }
+        Drain(window, release);
+      }
+
+      /// work out oldest again after values left the window
+      static void
+      Reset(Window& window)
+      {
+        if (window.held.empty())
+          return;
+        window.oldest = window.held.begin()->second.queued;
+        for (const auto& [seqno, held] : window.held)
+          window.oldest = std::min(window.oldest, held.queued);
+      }
+
+      std::unordered_map<Key_t, Window, Hash_t> m_Flows;
+      size_t m_Held = 0;
+      uint64_t m_Skipped = 0;
+      uint64_t m_Late = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
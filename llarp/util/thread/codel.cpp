@@ -0,0 +1,71 @@
+#include "codel.hpp"
+
+#include <cmath>
+
+namespace llarp
+{
+  namespace thread
+  {
+    CoDel::CoDel(Time_t target, Time_t interval) : Target{target}, Interval{interval}
+    {}
+
+    bool
+    CoDel::ShouldDrop(Time_t sojourn, Time_t now, bool backlogged)
+    {
+      bool okToDrop = false;
+      if (sojourn < Target or not backlogged)
+        m_FirstAboveTime = 0s;
+      else if (m_FirstAboveTime == 0s)
+        m_FirstAboveTime = now + Interval;
+      else if (now >= m_FirstAboveTime)
+        okToDrop = true;
+
+      if (m_Dropping)
+      {
+        if (not okToDrop)
+        {
+          // the queue went back below target
+          m_Dropping = false;
+          return false;
+        }
+        if (now < m_DropNext)
+          return false;
+        m_Count++;
+        m_DropNext = ControlLaw(m_DropNext);
+        m_Dropped++;
+        return true;
+      }
+      if (not okToDrop)
+        return false;
+
+      m_Dropping = true;
+      m_DropStates++;
+      // if we were dropping recently pick up about where we left off instead of from scratch
+      const auto delta = m_Count - m_LastCount;
+      m_Count = (delta > 1 and now - m_DropNext < Interval * 16) ? delta : 1;
+      m_LastCount = m_Count;
+      m_DropNext = ControlLaw(now);
+      m_Dropped++;
+      return true;
+    }
+
+    CoDel::Time_t
+    CoDel::ControlLaw(Time_t t) const
+    {
+      return t
+          + std::chrono::duration_cast<Time_t>(
+                std::chrono::duration<double, Time_t::period>{Interval} / std::sqrt(m_Count));
+    }
+
+    util::StatusObject
+    CoDel::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"dropped", m_Dropped},
+          {"dropStates", m_DropStates},
+          {"dropping", m_Dropping},
+          {"targetMS", Target.count()},
+          {"intervalMS", Interval.count()}};
+    }
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <cstdint>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// the control law of codel (rfc 8289): decides, as things leave a queue, which of them to
+    /// drop so that the time they spend queued stays around Target.  a queue is only dropped from
+    /// once everything leaving it waited longer than Target for a whole Interval, and then more
+    /// often the longer that keeps up, so bursts go through and standing queues do not.
+    /// not thread safe, lives with whatever takes things off the queue.
+    struct CoDel
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      static constexpr Time_t DefaultTarget = 5ms;
+      static constexpr Time_t DefaultInterval = 100ms;
+
+      explicit CoDel(Time_t target = DefaultTarget, Time_t interval = DefaultInterval);
+
+      const Time_t Target;
+      const Time_t Interval;
+
+      /// something that was queued for sojourn left the queue at now, backlogged if there is more
+      /// than it was queued behind it.  returns true if it should be dropped.
+      bool
+      ShouldDrop(Time_t sojourn, Time_t now, bool backlogged);
+
+      /// how many things we said to drop
+      uint64_t
+      Dropped() const
+      {
+        return m_Dropped;
+      }
+
+      /// how many times we started dropping
+      uint64_t
+      DropStates() const
+      {
+        return m_DropStates;
+      }
+
+      bool
+      Dropping() const
+      {
+        return m_Dropping;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      /// when we next drop while dropping, Interval over the square root of how many we dropped
+      Time_t
+      ControlLaw(Time_t t) const;
+
+      /// when sojourn times above Target will have lasted an Interval, 0 if they are not above it
+      Time_t m_FirstAboveTime = 0s;
+      Time_t m_DropNext = 0s;
+      uint32_t m_Count = 0;
+      uint32_t m_LastCount = 0;
+      bool m_Dropping = false;
+      uint64_t m_Dropped = 0;
+      uint64_t m_DropStates = 0;
+    };
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,148 @@
+#include "work_pool.hpp"
+#include "threading.hpp"
+
+#include <llarp/util/logging.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace thread
+  {
+    static auto logcat = log::Cat("work-pool");
+
+    WorkPool::WorkPool(size_t threads, size_t queueSize)
+    {
+      if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+      m_Workers.reserve(threads);
+      for (size_t idx = 0; idx < threads; ++idx)
+        m_Workers.emplace_back(std::make_unique<Worker>(queueSize));
+      // only start the threads once every queue exists so they can steal from each other
+      for (size_t idx = 0; idx < threads; ++idx)
+      {
+        m_Workers[idx]->thread = std::thread{[this, idx] {
+          util::SetThreadName(fmt::format("llarp-work-{}", idx));
+          Run(idx);
+        }};
+      }
+      log::info(logcat, "started {} worker threads", threads);
+    }
+
+    WorkPool::~WorkPool()
+    {
+      Stop();
+    }
+
+    bool
+    WorkPool::TrySubmit(Job_t&& job)
+    {
+      if (m_Stopping.load())
+        return false;
+      // count the job before it is visible so a worker that finds it never sees us go negative
+      m_Queued++;
+      const auto first = m_NextWorker.fetch_add(1, std::memory_order_relaxed);
+      for (size_t n = 0; n < m_Workers.size(); ++n)
+      {
+        auto& worker = *m_Workers[(first + n) % m_Workers.size()];
+        if (worker.jobs.tryPushBack(std::move(job)) == QueueReturn::Success)
+        {
+          Wakeup();
+          return true;
+        }
+      }
+      m_Queued--;
+      m_Rejected++;
+      return false;
+    }
+
+    void
+    WorkPool::Wakeup()
+    {
+      if (m_Sleeping.load() == 0)
+        return;
+      // take the lock so we cannot slip in between a worker checking for jobs and going to sleep
+      std::lock_guard lock{m_Mutex};
+      m_Cond.notify_one();
+    }
+
+    std::optional<WorkPool::Job_t>
+    WorkPool::Steal(size_t idx)
+    {
+      for (size_t n = 1; n < m_Workers.size(); ++n)
+      {
+        if (auto job = m_Workers[(idx + n) % m_Workers.size()]->jobs.tryPopFront())
+          return job;
+      }
+      return std::nullopt;
+    }
+
+    void
+    WorkPool::Run(size_t idx)
+    {
+      auto& self = *m_Workers[idx];
+      while (true)
+      {
+        auto job = self.jobs.tryPopFront();
+        if (not job)
+        {
+          job = Steal(idx);
+          if (job)
+            m_Stolen++;
+        }
+        if (job)
+        {
+          m_Queued--;
+          m_Running++;
+          try
+          {
+            (*job)();
+          }
+          catch (const std::exception& ex)
+          {
+            log::error(logcat, "worker job threw: {}", ex.what());
+          }
+          m_Running--;
+          m_Completed++;
+          continue;
+        }
+
+        std::unique_lock lock{m_Mutex};
+        if (m_Stopping.load() and m_Queued.load() == 0)
+          return;
+        m_Sleeping++;
+        m_Cond.wait(lock, [this] { return m_Queued.load() > 0 or m_Stopping.load(); });
+        m_Sleeping--;
+      }
+    }
+
+    void
+    WorkPool::Stop()
+    {
+      {
+        std::lock_guard lock{m_Mutex};
+        if (m_Stopping.exchange(true))
+          return;
+        m_Cond.notify_all();
+      }
+      for (auto& worker : m_Workers)
+      {
+        if (worker->thread.joinable())
+          worker->thread.join();
+      }
+    }
+
+    util::StatusObject
+    WorkPool::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"threads", NumThreads()},
+          {"queued", Queued()},
+          {"running", Running()},
+          {"stolen", Stolen()},
+          {"completed", Completed()},
+          {"rejected", Rejected()}};
+    }
+
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "queue.hpp"
+
+#include <llarp/util/status.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// fixed size pool of worker threads for cpu bound jobs.  every worker owns a bounded lock
+    /// free job queue; submitting spreads jobs over the queues round robin without taking a lock
+    /// and a worker whose own queue runs dry steals from the others before going to sleep.
+    /// jobs hand their results back themselves, usually through EventLoop::call.
+    class WorkPool
+    {
+     public:
+      using Job_t = std::function<void(void)>;
+
+      /// how many jobs each worker's queue holds
+      static constexpr size_t DefaultQueueSize = 1024;
+
+      /// start threads workers, 0 means one per logical cpu core
+      explicit WorkPool(size_t threads, size_t queueSize = DefaultQueueSize);
+
+      ~WorkPool();
+
+      WorkPool(const WorkPool&) = delete;
+      WorkPool&
+      operator=(const WorkPool&) = delete;
+
+      /// queue a job to be run on some worker, can be called from any thread.
+      /// fails if every worker's queue is full or we are stopped, job is left alone if we fail.
+      bool
+      TrySubmit(Job_t&& job);
+
+      /// stop taking jobs, let the workers finish what was already queued and join them
+      void
+      Stop();
+
+      size_t
+      NumThreads() const
+      {
+        return m_Workers.size();
+      }
+
+      /// jobs waiting for a worker
+      size_t
+      Queued() const
+      {
+        return m_Queued.load();
+      }
+
+      /// jobs being run right now
+      size_t
+      Running() const
+      {
+        return m_Running.load();
+      }
+
+      /// jobs a worker took from another worker's queue
+      uint64_t
+      Stolen() const
+      {
+        return m_Stolen.load();
+      }
+
+      uint64_t
+      Completed() const
+      {
+        return m_Completed.load();
+      }
+
+      /// jobs we turned away because every queue was full
+      uint64_t
+      Rejected() const
+      {
+        return m_Rejected.load();
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Worker
+      {
+        explicit Worker(size_t queueSize) : jobs{queueSize}
+        {}
+
+        Queue<Job_t> jobs;
+        std::thread thread;
+      };
+
+      void
+      Run(size_t idx);
+
+      /// take a job from any worker's queue but idx's
+      std::optional<Job_t>
+      Steal(size_t idx);
+
+      void
+      Wakeup();
+
+      std::vector<std::unique_ptr<Worker>> m_Workers;
+      std::atomic<size_t> m_NextWorker{0};
+
+      std::mutex m_Mutex;
+      std::condition_variable m_Cond;
+      std::atomic<size_t> m_Sleeping{0};
+      std::atomic<bool> m_Stopping{false};
+
+      std::atomic<size_t> m_Queued{0};
+      std::atomic<size_t> m_Running{0};
+      std::atomic<uint64_t> m_Stolen{0};
+      std::atomic<uint64_t> m_Completed{0};
+      std::atomic<uint64_t> m_Rejected{0};
+    };
+  }  // namespace thread
+}  // namespace llarp
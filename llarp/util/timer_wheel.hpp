@@ -0,0 +1,130 @@
+#pragma once
+
+#include "time.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// hashed timing wheel, holds values that are due at some point in time.
+    /// scheduling is O(1) and advancing only looks at the slots that elapsed since the last advance
+    /// instead of every value we hold.  entries further out than one revolution of the wheel stay
+    /// in their slot until the wheel comes back around to their due time.
+    template <typename Val_t>
+    struct TimerWheel
+    {
+      using Time_t = std::chrono::milliseconds;
+
+      explicit TimerWheel(Time_t resolution = 100ms, size_t slots = 512)
+          : m_Resolution{resolution}, m_Slots(slots)
+      {
+        assert(resolution > 0s);
+        assert(slots > 0);
+      }
+
+      size_t
+      Size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      Empty() const
+      {
+        return m_Size == 0;
+      }
+
+      Time_t
+      Resolution() const
+      {
+        return m_Resolution;
+      }
+
+      /// put val on the wheel to be popped by the first Advance() at or after when, returns the
+      /// time that is from now on, up to one resolution after when
+      Time_t
+      Schedule(Time_t when, Val_t val)
+      {
+        // we go into the slot of the first tick at or after when, things that are already due go
+        // into the next slot so the next advance picks them up
+        const auto tick = std::max(TickOf(when + m_Resolution - 1ms), m_Tick + 1);
+        m_Slots[tick % m_Slots.size()].push_back(Entry{when, tick, std::move(val)});
+        m_Size++;
+        return m_Resolution * tick;
+      }
+
+      /// the earliest time an Advance() could pop something, nullopt if we hold nothing.  this is
+      /// the end of the tick a value falls in, so up to one resolution after its due time.
+      std::optional<Time_t>
+      NextDue() const
+      {
+        if (Empty())
+          return std::nullopt;
+        // values for a later revolution share slots with the ones for this revolution
+        std::optional<uint64_t> next;
+        for (uint64_t idx = 1; idx <= m_Slots.size(); ++idx)
+        {
+          const auto tick = m_Tick + idx;
+          for (const auto& entry : m_Slots[tick % m_Slots.size()])
+          {
+            if (entry.tick <= tick)
+              return m_Resolution * tick;
+            next = std::min(next.value_or(entry.tick), entry.tick);
+          }
+        }
+        return m_Resolution * *next;
+      }
+
+      /// pop every value that is due at or before now and call visit(when, val) on it.
+      /// visit may schedule new values.
+      template <typename Visit_t>
+      void
+      Advance(Time_t now, Visit_t visit)
+      {
+        const auto tick = TickOf(now);
+        if (tick <= m_Tick)
+          return;
+        // if we fell behind by a whole revolution every slot needs a look, but only once
+        const auto elapsed = std::min<uint64_t>(tick - m_Tick, m_Slots.size());
+        std::vector<Entry> due;
+        for (uint64_t idx = 0; idx < elapsed; ++idx)
+        {
+          auto& slot = m_Slots[(tick - idx) % m_Slots.size()];
+          auto itr = std::partition(
+              slot.begin(), slot.end(), [now](const auto& entry) { return entry.when > now; });
+          std::move(itr, slot.end(), std::back_inserter(due));
+          slot.erase(itr, slot.end());
+        }
+        m_Tick = tick;
+        m_Size -= due.size();
+        for (auto& entry : due)
+          visit(entry.when, std::move(entry.val));
+      }
+
+     private:
+      struct Entry
+      {
+        Time_t when;
+        /// the tick we first pop it at
+        uint64_t tick;
+        Val_t val;
+      };
+
+      uint64_t
+      TickOf(Time_t when) const
+      {
+        return when.count() / m_Resolution.count();
+      }
+
+      Time_t m_Resolution;
+      std::vector<std::vector<Entry>> m_Slots;
+      uint64_t m_Tick{0};
+      size_t m_Size{0};
+    };
+  }  // namespace util
+}  // namespace llarp
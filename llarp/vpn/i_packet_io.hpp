@@ -3,6 +3,8 @@
 #include <llarp/net/ip_packet.hpp>
 #include <llarp/util/types.hpp>
 
+#include <vector>
+
 namespace llarp::vpn
 {
   class I_Packet_IO
@@ -27,6 +29,20 @@ namespace llarp::vpn
     virtual bool
     WritePacket(net::IPPacket pkt) = 0;
 
+    /// write a batch of packets to the interface in order
+    /// returns how many of them we dropped
+    virtual size_t
+    WritePackets(std::vector<net::IPPacket> pkts)
+    {
+      size_t dropped = 0;
+      for (auto& pkt : pkts)
+      {
+        if (not WritePacket(std::move(pkt)))
+          dropped++;
+      }
+      return dropped;
+    }
+
     /// get pollable fd for reading
     virtual int
     PollFD() const = 0;
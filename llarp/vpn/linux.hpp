@@ -22,6 +22,22 @@
 #include <llarp.hpp>
 
 #include <llarp/util/fs.hpp>
+#include <llarp/util/packet_pool.hpp>
+#include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <llarp/net/offload.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
 
 namespace llarp::vpn
 {
@@ -34,25 +50,78 @@ namespace llarp::vpn
 
   class LinuxInterface : public NetworkInterface
   {
-    const int m_fd;
+    /// one fd per queue of the tun device, a single queue device has just the one
+    std::vector<int> m_fds;
+
+    /// how many packets a reader thread takes off its queue before waking the event loop
+    static constexpr size_t ReadBatchSize = 64;
+    /// how many read packets can wait for the event loop, over every queue
+    static constexpr size_t ReadQueueSize = 4096;
+
+    // everything below is only used with more than one queue.  each queue gets a thread reading
+    // it into pooled buffers that are handed to the event loop through m_ReadQueue, m_EventFD is
+    // what the event loop polls to learn there is something in it.
+    int m_EventFD = -1;
+    /// written to to make the reader threads exit
+    int m_StopFD = -1;
+    std::unique_ptr<thread::Queue<PacketBuffer>> m_ReadQueue;
+    std::vector<std::thread> m_Readers;
+    std::atomic<uint64_t> m_ReadDropped{0};
+
+    // with offloads on the kernel can hand us tcp super packets, which we cut up as we read them.
+    // single queue reads keep what is left of the last one here.
+    std::deque<net::IPPacket> m_Pending;
+    std::vector<byte_t> m_OffloadBuf;
 
-   public:
-    LinuxInterface(InterfaceInfo info)
-        : NetworkInterface{std::move(info)}, m_fd{::open("/dev/net/tun", O_RDWR)}
+    bool
+    MultiQueue() const
+    {
+      return m_fds.size() > 1;
+    }
 
+    /// close every fd we opened, for the destructor and for a constructor that failed part way
+    void
+    CloseAll()
     {
-      if (m_fd == -1)
-        throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+      for (const auto fd : m_fds)
+        ::close(fd);
+      m_fds.clear();
+      if (m_EventFD != -1)
+        ::close(m_EventFD);
+      if (m_StopFD != -1)
+        ::close(m_StopFD);
+      m_EventFD = m_StopFD = -1;
+    }
+
+    /// open the queues and set the interface up
+    void
+    Open()
+    {
+      m_Info.queues = std::max<size_t>(m_Info.queues, 1);
 
       ifreq ifr{};
       in6_ifreq ifr6{};
-      ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
       std::copy_n(
           m_Info.ifname.c_str(),
           std::min(m_Info.ifname.size(), sizeof(ifr.ifr_name)),
           ifr.ifr_name);
-      if (::ioctl(m_fd, TUNSETIFF, &ifr) == -1)
-        throw std::runtime_error("cannot set interface name: " + std::string{strerror(errno)});
+      // every queue after the first attaches to the interface the first one made
+      m_fds.reserve(m_Info.queues);
+      for (size_t n = 0; n < m_Info.queues; ++n)
+        m_fds.push_back(OpenQueue(ifr));
+
+      if (MultiQueue())
+      {
+        m_EventFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_StopFD = ::eventfd(0, EFD_CLOEXEC);
+        if (m_EventFD == -1 or m_StopFD == -1)
+          throw std::runtime_error("cannot make eventfd: " + std::string{strerror(errno)});
+        for (const auto fd : m_fds)
+          ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+        m_ReadQueue = std::make_unique<thread::Queue<PacketBuffer>>(ReadQueueSize);
+        LogInfo(m_Info.ifname, " opened with ", m_fds.size(), " queues");
+      }
+
       IOCTL control{AF_INET};
 
       control.ioctl(SIOCGIFFLAGS, &ifr);
@@ -92,23 +161,222 @@ namespace llarp::vpn
       control.ioctl(SIOCSIFFLAGS, &ifr);
     }
 
+    /// open one queue of the tun device, ifr carries the name in and the name we got out
+    int
+    OpenQueue(ifreq& ifr)
+    {
+      const int fd = ::open("/dev/net/tun", O_RDWR);
+      if (fd == -1)
+        throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+      ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+      if (m_Info.queues > 1)
+        ifr.ifr_flags |= IFF_MULTI_QUEUE;
+      if (m_Info.offload)
+        ifr.ifr_flags |= IFF_VNET_HDR;
+      if (::ioctl(fd, TUNSETIFF, &ifr) == -1)
+      {
+        const auto err = errno;
+        ::close(fd);
+        throw std::runtime_error("cannot set interface name: " + std::string{strerror(err)});
+      }
+      if (m_Info.offload
+          and ::ioctl(fd, TUNSETOFFLOAD, TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6 | TUN_F_TSO_ECN)
+              == -1)
+      {
+        // we still get the vnet header, just never a super packet
+        LogWarn("cannot turn on tun offloads: ", strerror(errno));
+      }
+      return fd;
+    }
+
+    /// read one packet from a tun with offloads on into buf and pass what it holds to visit a
+    /// packet at a time.  returns false if there was nothing to read.
+    template <typename Visit>
+    bool
+    ReadOffloaded(int fd, std::vector<byte_t>& buf, Visit&& visit)
+    {
+      buf.resize(net::MaxOffloadReadSize);
+      const auto sz = ::read(fd, buf.data(), buf.size());
+      if (sz < 0)
+      {
+        if (errno == EAGAIN or errno == EWOULDBLOCK)
+        {
+          errno = 0;
+          return false;
+        }
+        throw std::error_code{errno, std::system_category()};
+      }
+      if (static_cast<size_t>(sz) < sizeof(net::VNetHeader))
+        return sz > 0;
+
+      net::VNetHeader hdr;
+      std::memcpy(&hdr, buf.data(), sizeof(hdr));
+      if (not net::SplitOffloaded(
+              hdr,
+              buf.data() + sizeof(hdr),
+              sz - sizeof(hdr),
+              [&visit](const byte_t* ptr, size_t len) { visit(ptr, len); }))
+        LogDebug("dropping tun packet we cannot split up, gso type ", int{hdr.gsoType});
+      return true;
+    }
+
+    void
+    ReadQueue(int fd)
+    {
+      std::array<pollfd, 2> fds{pollfd{fd, POLLIN, 0}, pollfd{m_StopFD, POLLIN, 0}};
+      std::vector<byte_t> offloadBuf;
+      while (true)
+      {
+        if (::poll(fds.data(), fds.size(), -1) == -1)
+        {
+          if (errno == EINTR)
+            continue;
+          LogError("tun queue poll failed: ", strerror(errno));
+          return;
+        }
+        if (fds[1].revents)
+          return;
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+          // nothing more will ever come off this queue and poll would keep telling us so
+          LogError("tun queue ", fd, " went away, no longer reading it");
+          return;
+        }
+
+        bool got = false;
+        const auto push = [this, &got](PacketBuffer pkt) {
+          if (m_ReadQueue->tryPushBack(std::move(pkt)) == thread::QueueReturn::Success)
+            got = true;
+          else
+            m_ReadDropped++;
+        };
+        try
+        {
+          for (size_t n = 0; n < ReadBatchSize; ++n)
+          {
+            if (m_Info.offload)
+            {
+              if (not ReadOffloaded(fd, offloadBuf, [&push](const byte_t* ptr, size_t len) {
+                    push(PacketPool::Local().Copy(ptr, len, net::IPPacket::Headroom));
+                  }))
+                break;
+              continue;
+            }
+            auto pkt = net::IPPacket::AcquireBuffer();
+            const auto sz = ::read(fd, pkt.data(), pkt.size());
+            if (sz < 0 and errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR)
+              throw std::error_code{errno, std::system_category()};
+            if (sz <= 0)
+              break;
+            pkt.resize(sz);
+            push(std::move(pkt));
+          }
+        }
+        catch (const std::error_code& ec)
+        {
+          LogError("tun queue read failed: ", ec.message());
+          return;
+        }
+        if (got)
+        {
+          const uint64_t one = 1;
+          [[maybe_unused]] const auto ret = ::write(m_EventFD, &one, sizeof(one));
+        }
+      }
+    }
+
+   public:
+    LinuxInterface(InterfaceInfo info) : NetworkInterface{std::move(info)}
+    {
+      try
+      {
+        Open();
+      }
+      catch (...)
+      {
+        // the destructor does not run for a constructor that threw
+        CloseAll();
+        throw;
+      }
+    }
+
     virtual ~LinuxInterface()
     {
-      ::close(m_fd);
+      Stop();
+      CloseAll();
+    }
+
+    void
+    Start() override
+    {
+      if (not MultiQueue() or not m_Readers.empty())
+        return;
+      for (size_t n = 0; n < m_fds.size(); ++n)
+      {
+        m_Readers.emplace_back([this, n] {
+          util::SetThreadName(fmt::format("llarp-tun-{}", n));
+          ReadQueue(m_fds[n]);
+        });
+      }
+    }
+
+    void
+    Stop() override
+    {
+      if (m_Readers.empty())
+        return;
+      const uint64_t one = 1;
+      [[maybe_unused]] const auto ret = ::write(m_StopFD, &one, sizeof(one));
+      for (auto& reader : m_Readers)
+        reader.join();
+      m_Readers.clear();
+      if (const auto dropped = m_ReadDropped.exchange(0))
+        LogWarn(
+            m_Info.ifname, " dropped ", dropped, " packets the event loop did not keep up with");
     }
 
     int
     PollFD() const override
     {
-      return m_fd;
+      return MultiQueue() ? m_EventFD : m_fds[0];
     }
 
     net::IPPacket
     ReadNextPacket() override
     {
-      std::vector<byte_t> pkt;
-      pkt.resize(net::IPPacket::MaxSize);
-      const auto sz = read(m_fd, pkt.data(), pkt.capacity());
+      if (MultiQueue())
+      {
+        auto pkt = m_ReadQueue->tryPopFront();
+        if (not pkt)
+        {
+          // clear the wakeup then look again, a reader that pushes after this wakes us up again
+          uint64_t count;
+          [[maybe_unused]] const auto ret = ::read(m_EventFD, &count, sizeof(count));
+          pkt = m_ReadQueue->tryPopFront();
+        }
+        if (not pkt)
+          return net::IPPacket{};
+        return net::IPPacket{std::move(*pkt)};
+      }
+
+      if (m_Info.offload)
+      {
+        while (m_Pending.empty())
+        {
+          if (not ReadOffloaded(m_fds[0], m_OffloadBuf, [this](const byte_t* ptr, size_t len) {
+                if (len >= net::IPPacket::MinSize)
+                  m_Pending.emplace_back(
+                      PacketPool::Local().Copy(ptr, len, net::IPPacket::Headroom));
+              }))
+            return net::IPPacket{};
+        }
+        auto pkt = std::move(m_Pending.front());
+        m_Pending.pop_front();
+        return pkt;
+      }
+
+      auto pkt = net::IPPacket::AcquireBuffer();
+      const auto sz = read(m_fds[0], pkt.data(), pkt.size());
       if (sz < 0)
       {
         if (errno == EAGAIN or errno == EWOULDBLOCK)
@@ -119,13 +387,33 @@ namespace llarp::vpn
         throw std::error_code{errno, std::system_category()};
       }
       pkt.resize(sz);
-      return pkt;
+      return net::IPPacket{std::move(pkt)};
     }
 
     bool
     WritePacket(net::IPPacket pkt) override
     {
-      const auto sz = write(m_fd, pkt.data(), pkt.size());
+      // keep every packet of a flow on one queue so they stay in order
+      const int fd = MultiQueue() ? m_fds[pkt.FlowHash() % m_fds.size()] : m_fds[0];
+      if (m_Info.offload)
+      {
+        // what we write is always one whole packet with its checksums done, so the vnet header
+        // in front of it is all zeros.  if nobody else looks at the packet's buffer we put the
+        // header in its headroom and get away with a plain write.
+        auto buf = pkt.steal_buffer();
+        if (buf.use_count() == 1 and buf.push_front(sizeof(net::VNetHeader)))
+        {
+          std::fill_n(buf.data(), sizeof(net::VNetHeader), 0);
+          const auto sz = ::write(fd, buf.data(), buf.size());
+          return sz == static_cast<ssize_t>(buf.size());
+        }
+        net::VNetHeader hdr{};
+        std::array<iovec, 2> iov{
+            iovec{&hdr, sizeof(hdr)}, iovec{buf.data(), buf.size()}};
+        const auto sz = ::writev(fd, iov.data(), iov.size());
+        return sz == static_cast<ssize_t>(sizeof(hdr) + buf.size());
+      }
+      const auto sz = write(fd, pkt.data(), pkt.size());
       if (sz <= 0)
         return false;
       return sz == static_cast<ssize_t>(pkt.size());
@@ -35,6 +35,10 @@ namespace llarp::vpn
     unsigned int index;
     huint32_t dnsaddr;
     std::vector<InterfaceAddress> addrs;
+    /// how many packet queues to open on the interface where the platform can do more than one
+    size_t queues = 1;
+    /// ask the kernel for tcp super packets and leave checksums to us where the platform can
+    bool offload = false;
 
     /// get address number N
     inline net::ipaddr_t
@@ -26,7 +26,7 @@ namespace llarp
           const service::ConvoTag tag,
           const llarp_buffer_t& pktbuf,
           service::ProtocolType proto,
-          uint64_t) override
+          std::optional<uint64_t>) override
       {
         if (handlePacket)
         {
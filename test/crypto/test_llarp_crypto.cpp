@@ -48,6 +48,34 @@ TEST_CASE("PQ crypto")
   REQUIRE(otherShared == shared);
 }
 
+TEST_CASE("xchacha20 batch")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  SharedSecret key;
+  key.Randomize();
+
+  // enough buffers of mixed sizes to fill the wide path more than once and leave some over
+  std::vector<std::vector<byte_t>> batched, single;
+  std::vector<CryptBatchItem> items;
+  for (size_t idx = 0; idx < 21; ++idx)
+  {
+    auto& buf = batched.emplace_back((idx * 97) % 1600);
+    crypto.randbytes(buf.data(), buf.size());
+    single.push_back(buf);
+    TunnelNonce nonce;
+    nonce.Randomize();
+    items.push_back(CryptBatchItem{buf.data(), buf.size(), nonce});
+  }
+
+  REQUIRE(crypto.xchacha20_batch(key, items.data(), items.size()));
+  for (size_t idx = 0; idx < items.size(); ++idx)
+  {
+    const llarp_buffer_t buf{single[idx]};
+    REQUIRE(crypto.xchacha20(buf, key, items[idx].nonce));
+    REQUIRE(single[idx] == batched[idx]);
+  }
+}
+
 #ifdef HAVE_CRYPT
 
 TEST_CASE("passwd hash valid")
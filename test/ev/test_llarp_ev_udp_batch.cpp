@@ -0,0 +1,229 @@
+#include <llarp/ev/ev.hpp>
+#include <llarp/ev/udp_handle.hpp>
+#include <llarp/net/sock_addr.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  /// a plain blocking udp socket on loopback to see what actually went on the wire
+  struct Receiver
+  {
+    int fd;
+    SockAddr addr;
+
+    Receiver()
+    {
+      fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+      REQUIRE(fd != -1);
+      int bufsize = 16 * 1024 * 1024;
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+      SockAddr bind_addr{"127.0.0.1:0"};
+      const auto* sa = static_cast<const sockaddr*>(bind_addr);
+      REQUIRE(::bind(fd, sa, bind_addr.sockaddr_len()) == 0);
+      sockaddr_storage local{};
+      socklen_t len = sizeof(local);
+      REQUIRE(::getsockname(fd, reinterpret_cast<sockaddr*>(&local), &len) == 0);
+      addr = SockAddr{*reinterpret_cast<const sockaddr*>(&local)};
+    }
+
+    ~Receiver()
+    {
+      ::close(fd);
+    }
+
+    /// read datagrams until nothing shows up for timeout, calling f on each
+    template <typename Func>
+    void
+    Drain(std::chrono::milliseconds timeout, Func&& f)
+    {
+      std::vector<byte_t> buf(65536);
+      pollfd pfd{fd, POLLIN, 0};
+      while (::poll(&pfd, 1, timeout.count()) == 1)
+      {
+        const auto got = ::recv(fd, buf.data(), buf.size(), 0);
+        if (got <= 0)
+          break;
+        f(buf.data(), static_cast<size_t>(got));
+      }
+    }
+  };
+
+  /// runs an event loop on its own thread, known to be running before Start returns
+  struct LoopThread
+  {
+    EventLoop_ptr loop;
+    std::thread thread;
+
+    explicit LoopThread(bool batched) : loop{EventLoop::create(1024 * 8, batched)}
+    {}
+
+    void
+    Start()
+    {
+      std::promise<void> started;
+      loop->call_soon([&started] { started.set_value(); });
+      thread = std::thread{[loop = loop] { loop->run(); }};
+      started.get_future().wait();
+    }
+
+    /// handles made on the loop have to go away before it does, so stop while they exist
+    void
+    Stop()
+    {
+      loop->stop();
+      if (thread.joinable())
+        thread.join();
+    }
+
+    ~LoopThread()
+    {
+      Stop();
+    }
+  };
+
+  /// where handle is bound, straight from the kernel
+  SockAddr
+  BoundAddr(UDPHandle& handle)
+  {
+    sockaddr_storage local{};
+    socklen_t len = sizeof(local);
+    REQUIRE(handle.file_descriptor());
+    const auto fd = *handle.file_descriptor();
+    REQUIRE(::getsockname(fd, reinterpret_cast<sockaddr*>(&local), &len) == 0);
+    return SockAddr{*reinterpret_cast<const sockaddr*>(&local)};
+  }
+
+  /// a datagram whose every byte says who sent it, so torn or mixed up sends show
+  std::vector<byte_t>
+  MakeDatagram(uint8_t sender, uint16_t seqno)
+  {
+    std::vector<byte_t> data(100 + (seqno * 37) % 1100);
+    data[0] = sender;
+    data[1] = seqno & 0xff;
+    data[2] = seqno >> 8;
+    for (size_t idx = 3; idx < data.size(); ++idx)
+      data[idx] = static_cast<byte_t>(sender * 31 + seqno + idx);
+    return data;
+  }
+}  // namespace
+
+TEST_CASE("Batched udp takes sends from many threads at once", "[ev][udp]")
+{
+  constexpr uint8_t NumThreads = 8;
+  constexpr uint16_t PerThread = 500;
+
+  Receiver receiver;
+  LoopThread loop{true};
+  auto udp = loop.loop->make_udp([](auto&, auto, auto) {});
+  REQUIRE(udp->listen(SockAddr{"127.0.0.1:0"}));
+  loop.Start();
+
+  std::atomic<size_t> accepted{0};
+  std::vector<std::thread> senders;
+  for (uint8_t sender = 0; sender < NumThreads; ++sender)
+  {
+    senders.emplace_back([&, sender] {
+      for (uint16_t seqno = 0; seqno < PerThread; ++seqno)
+      {
+        auto data = MakeDatagram(sender, seqno);
+        if (udp->send(receiver.addr, llarp_buffer_t{data}))
+          accepted++;
+        // leave the receiver a chance to keep up, we are not testing the kernel here
+        if (seqno % 64 == 0)
+          std::this_thread::sleep_for(1ms);
+      }
+    });
+  }
+
+  std::set<std::pair<uint8_t, uint16_t>> seen;
+  size_t torn = 0;
+  receiver.Drain(500ms, [&](const byte_t* ptr, size_t sz) {
+    const uint8_t sender = ptr[0];
+    const uint16_t seqno = ptr[1] | (ptr[2] << 8);
+    if (MakeDatagram(sender, seqno) != std::vector<byte_t>{ptr, ptr + sz})
+      torn++;
+    else
+      seen.emplace(sender, seqno);
+  });
+  for (auto& thread : senders)
+    thread.join();
+  loop.Stop();
+
+  REQUIRE(torn == 0);
+  REQUIRE(accepted == NumThreads * PerThread);
+  REQUIRE(seen.size() == accepted);
+}
+
+TEST_CASE("Udp sockets can be kept from fragmenting", "[ev][udp]")
+{
+  for (const bool batched : {false, true})
+  {
+    LoopThread loop{batched};
+    auto udp = loop.loop->make_udp([](auto&, auto, auto) {});
+    REQUIRE(udp->listen(SockAddr{"127.0.0.1:0"}));
+    loop.Start();
+    REQUIRE(udp->file_descriptor());
+    REQUIRE(udp->set_dont_fragment());
+
+    int mode = -1;
+    socklen_t len = sizeof(mode);
+    REQUIRE(::getsockopt(*udp->file_descriptor(), IPPROTO_IP, IP_MTU_DISCOVER, &mode, &len) == 0);
+    CHECK(mode == IP_PMTUDISC_PROBE);
+  }
+}
+
+TEST_CASE("Batched udp loopback throughput", "[.][ev][udp][benchmark]")
+{
+  constexpr size_t DatagramSize = 1200;
+  constexpr size_t PerRound = 256;
+  constexpr auto Duration = 1s;
+
+  for (const bool batched : {false, true})
+  {
+    LoopThread loop{batched};
+    std::atomic<size_t> received{0};
+    auto rx = loop.loop->make_udp([&received](auto&, auto, auto) { received++; });
+    REQUIRE(rx->listen(SockAddr{"127.0.0.1:0"}));
+    const auto to = BoundAddr(*rx);
+    auto tx = loop.loop->make_udp([](auto&, auto, auto) {});
+    REQUIRE(tx->listen(SockAddr{"127.0.0.1:0"}));
+
+    // send a round per loop iteration from the loop itself, like the link layer does
+    std::vector<byte_t> data(DatagramSize, 0x42);
+    std::atomic<size_t> sent{0};
+    const auto until = std::chrono::steady_clock::now() + Duration;
+    loop.loop->add_ticker([&] {
+      if (std::chrono::steady_clock::now() >= until)
+        return;
+      for (size_t n = 0; n < PerRound; ++n)
+        sent += tx->send(to, llarp_buffer_t{data});
+      // come straight back for the next round
+      loop.loop->wakeup();
+    });
+    loop.Start();
+    std::this_thread::sleep_for(Duration + 100ms);
+    loop.Stop();
+
+    WARN(
+        (batched ? "batched" : "libuv") << " udp: " << sent.load() << " sent, " << received.load()
+                                        << " received datagrams of " << DatagramSize
+                                        << " bytes in " << Duration.count() << "s");
+    REQUIRE(received > 0);
+  }
+}
@@ -0,0 +1,196 @@
+#include <llarp/iwp/congestion.hpp>
+#include <catch2/catch.hpp>
+
+#include <deque>
+#include <random>
+#include <vector>
+
+using llarp::iwp::CongestionControl;
+
+namespace
+{
+  /// sends Total fragments over a lossy bottleneck link, one ms at a time, and returns how long
+  /// it took for all of them to be acked and how many we sent in all.  with adaptive off we act
+  /// like we used to: send everything at once and retransmit on a fixed timer.
+  struct LinkSim
+  {
+    static constexpr size_t Total = 2000;
+    /// one way delay each way, fragments per ms the link carries and how many it queues
+    static constexpr auto Delay = 20ms;
+    static constexpr size_t Rate = 4;
+    static constexpr size_t Buffer = 100;
+    static constexpr double Loss = 0.005;
+    static constexpr auto FixedRTO = 400ms;
+
+    struct Frag
+    {
+      enum
+      {
+        Unsent,
+        InFlight,
+        Acked
+      } state = Unsent;
+      llarp_time_t sentAt = 0s;
+      bool retransmitted = false;
+      /// this copy of it made it through
+      bool arrives = false;
+      llarp_time_t ackAt = 0s;
+    };
+
+    llarp_time_t elapsed = 0s;
+    size_t sent = 0;
+
+    explicit LinkSim(bool adaptive)
+    {
+      std::mt19937_64 rng{1};
+      std::uniform_real_distribution<double> coin{0, 1};
+      CongestionControl cc{FixedRTO};
+      std::vector<Frag> frags(Total);
+      std::deque<size_t> queue;
+      size_t acked = 0;
+      llarp_time_t now = 0s;
+      for (; acked < Total and now < 60s; now += 1ms)
+      {
+        // the link moves Rate fragments off its queue, acks for them get back Delay later
+        for (size_t n = 0; n < Rate and not queue.empty(); ++n)
+        {
+          auto& frag = frags[queue.front()];
+          queue.pop_front();
+          frag.ackAt = now + 2 * Delay;
+        }
+        bool lost = false;
+        for (auto& frag : frags)
+        {
+          if (frag.state != Frag::InFlight)
+            continue;
+          if (frag.arrives and frag.ackAt != 0s and frag.ackAt <= now)
+          {
+            frag.state = Frag::Acked;
+            acked++;
+            if (adaptive)
+            {
+              cc.OnAcked(1, now);
+              if (not frag.retransmitted)
+                cc.OnRTTSample(now - frag.sentAt);
+            }
+            continue;
+          }
+          const auto rto = adaptive ? cc.RTO() : FixedRTO;
+          if (now - frag.sentAt >= rto)
+          {
+            frag.state = Frag::Unsent;
+            frag.retransmitted = true;
+            if (adaptive)
+              cc.OnLost(1, frag.sentAt, now);
+            lost = true;
+          }
+        }
+        if (lost and adaptive)
+          cc.BackoffRTO();
+
+        size_t budget = adaptive ? cc.SendBudget(now) : Total;
+        size_t sentNow = 0;
+        for (size_t idx = 0; idx < Total and sentNow < budget; ++idx)
+        {
+          auto& frag = frags[idx];
+          if (frag.state != Frag::Unsent)
+            continue;
+          frag.state = Frag::InFlight;
+          frag.sentAt = now;
+          frag.ackAt = 0s;
+          frag.arrives = coin(rng) >= Loss and queue.size() < Buffer;
+          if (frag.arrives)
+            queue.push_back(idx);
+          sentNow++;
+        }
+        if (adaptive)
+          cc.OnSent(sentNow, now);
+        sent += sentNow;
+      }
+      elapsed = now;
+    }
+  };
+}  // namespace
+
+TEST_CASE("CongestionControl estimates rtt and rto", "[iwp][congestion]")
+{
+  CongestionControl cc{400ms};
+  REQUIRE(cc.RTO() == 400ms);
+  REQUIRE(cc.SRTT() == 0s);
+
+  cc.OnRTTSample(100ms);
+  CHECK(cc.SRTT() == 100ms);
+  CHECK(cc.RTTVar() == 50ms);
+  CHECK(cc.RTO() == 300ms);
+
+  cc.OnRTTSample(100ms);
+  CHECK(cc.SRTT() == 100ms);
+  CHECK(cc.RTO() == 250ms);
+
+  cc.BackoffRTO();
+  CHECK(cc.RTO() == 400ms);
+  cc.BackoffRTO();
+  CHECK(cc.RTO() == 400ms);
+
+  // fast links still get a sane floor
+  for (int n = 0; n < 50; ++n)
+    cc.OnRTTSample(1ms);
+  CHECK(cc.RTO() == CongestionControl::MinRTO);
+}
+
+TEST_CASE("CongestionControl grows its window on acks and cuts it per loss", "[iwp][congestion]")
+{
+  static constexpr llarp_time_t now = 10s;
+  CongestionControl cc{400ms};
+  const auto initial = static_cast<size_t>(CongestionControl::InitialWindow);
+  REQUIRE(cc.SendBudget(now) == initial);
+  cc.OnSent(initial, now);
+  REQUIRE(cc.SendBudget(now) == 0);
+
+  // slow start, every ack opens the window by one
+  cc.OnAcked(initial, now + 50ms);
+  CHECK(cc.Window() == 2 * CongestionControl::InitialWindow);
+  CHECK(cc.InFlight() == 0);
+
+  cc.OnSent(10, now + 60ms);
+  cc.OnLost(5, now + 60ms, now + 100ms);
+  CHECK(cc.Window() == Approx(2 * CongestionControl::InitialWindow * CongestionControl::Beta));
+  CHECK(cc.InFlight() == 5);
+  // the rest of the same round going missing does not cut it again
+  cc.OnLost(5, now + 60ms, now + 110ms);
+  CHECK(cc.Window() == Approx(2 * CongestionControl::InitialWindow * CongestionControl::Beta));
+  CHECK(cc.InFlight() == 0);
+
+  // out of slow start the window creeps back up to where it was cut
+  const auto cut = cc.Window();
+  cc.OnRTTSample(50ms);
+  for (auto t = now + 110ms; t < now + 2s; t += 10ms)
+    cc.OnAcked(1, t);
+  CHECK(cc.Window() > cut);
+}
+
+TEST_CASE("CongestionControl paces what the window lets out", "[iwp][congestion]")
+{
+  static constexpr llarp_time_t now = 10s;
+  CongestionControl cc{400ms};
+  cc.OnRTTSample(100ms);
+  // 32 fragments over 100ms, a little faster than that
+  const auto burst = cc.SendBudget(now);
+  CHECK(burst == static_cast<size_t>(CongestionControl::InitialWindow / 4));
+  cc.OnSent(burst, now);
+  CHECK(cc.SendBudget(now) == 0);
+  const auto next = cc.NextSendAt();
+  REQUIRE(next);
+  CHECK(*next > now);
+  CHECK(*next <= now + 3ms);
+  CHECK(cc.SendBudget(*next) >= 1);
+}
+
+TEST_CASE("CongestionControl beats a fixed timer on a lossy link", "[iwp][congestion]")
+{
+  const LinkSim fixed{false}, adaptive{true};
+  INFO("fixed took " << fixed.elapsed.count() << "ms sending " << fixed.sent);
+  INFO("adaptive took " << adaptive.elapsed.count() << "ms sending " << adaptive.sent);
+  CHECK(adaptive.elapsed < fixed.elapsed);
+  CHECK(adaptive.sent < fixed.sent);
+}
@@ -0,0 +1,107 @@
+#include <llarp/iwp/pmtu.hpp>
+#include <catch2/catch.hpp>
+
+using llarp::iwp::PathMTU;
+
+namespace
+{
+  constexpr size_t Base = 1124;
+
+  /// the remote answers the probe of the base size we start with
+  void
+  Answer(PathMTU& pmtu, PathMTU::Time_t now)
+  {
+    REQUIRE(pmtu.NextProbe(now) == Base);
+    REQUIRE(pmtu.ProbeAcked(Base, now));
+    REQUIRE(pmtu.RemoteAnswers());
+  }
+}  // namespace
+
+TEST_CASE("path mtu probes largest first and settles on what gets acked", "[iwp][pmtu]")
+{
+  PathMTU pmtu{Base, 0s};
+  REQUIRE(pmtu.PacketSize() == Base);
+  REQUIRE(pmtu.NextProbeAt() == 0s);
+  PathMTU::Time_t now = 0s;
+  Answer(pmtu, now);
+  REQUIRE(pmtu.NextProbeAt() == now);
+
+  // nothing comes back for the largest size, we give up on it after a few attempts
+  for (size_t i = 0; i < PathMTU::Attempts; ++i)
+  {
+    REQUIRE(pmtu.NextProbe(now) == PathMTU::Candidates[0]);
+    REQUIRE_FALSE(pmtu.NextProbe(now));
+    now += PathMTU::ProbeInterval;
+  }
+  REQUIRE(pmtu.NextProbe(now) == PathMTU::Candidates[1]);
+  REQUIRE(pmtu.ProbeAcked(PathMTU::Candidates[1], now));
+  REQUIRE(pmtu.PacketSize() == PathMTU::Candidates[1]);
+
+  // and we leave it alone for a while before looking for more
+  REQUIRE(pmtu.NextProbeAt() == now + PathMTU::RaiseInterval);
+  REQUIRE_FALSE(pmtu.NextProbe(now + PathMTU::ProbeInterval));
+  REQUIRE(pmtu.NextProbe(now + PathMTU::RaiseInterval) == PathMTU::Candidates[0]);
+}
+
+TEST_CASE("path mtu stops probing remotes that never answer", "[iwp][pmtu]")
+{
+  PathMTU pmtu{Base, 0s};
+  PathMTU::Time_t now = 0s;
+  size_t probes = 0;
+  while (pmtu.NextProbeAt() <= now + PathMTU::ProbeInterval)
+  {
+    if (const auto size = pmtu.NextProbe(now))
+    {
+      REQUIRE(*size == Base);
+      probes++;
+    }
+    now += PathMTU::ProbeInterval;
+  }
+  // only the first round, not a search through every candidate and never again after
+  REQUIRE(probes == PathMTU::Attempts);
+  REQUIRE_FALSE(pmtu.RemoteAnswers());
+  REQUIRE(pmtu.PacketSize() == Base);
+  REQUIRE(pmtu.NextProbeAt() == PathMTU::Time_t::max());
+  // an ack that shows up much later is not for anything we wait on
+  REQUIRE_FALSE(pmtu.ProbeAcked(Base, now));
+}
+
+TEST_CASE("path mtu only takes the ack for the probe it sent", "[iwp][pmtu]")
+{
+  PathMTU pmtu{Base, 0s};
+  // nothing is outstanding yet
+  REQUIRE_FALSE(pmtu.ProbeAcked(PathMTU::Candidates[0], 0s));
+  Answer(pmtu, 0s);
+
+  REQUIRE(pmtu.NextProbe(0s) == PathMTU::Candidates[0]);
+  // a remote that echoes back sizes we did not probe does not move us
+  REQUIRE_FALSE(pmtu.ProbeAcked(PathMTU::Candidates[1], 0s));
+  REQUIRE_FALSE(pmtu.ProbeAcked(PathMTU::Candidates[0] + 1, 0s));
+  REQUIRE_FALSE(pmtu.ProbeAcked(Base - 1, 0s));
+  REQUIRE(pmtu.PacketSize() == Base);
+  REQUIRE(pmtu.ProbeAcked(PathMTU::Candidates[0], 0s));
+  REQUIRE(pmtu.PacketSize() == PathMTU::Candidates[0]);
+  // the same ack twice only counts once
+  REQUIRE_FALSE(pmtu.ProbeAcked(PathMTU::Candidates[0], 0s));
+  // nothing larger to find
+  REQUIRE_FALSE(pmtu.NextProbe(1h));
+}
+
+TEST_CASE("path mtu drops back to the base size on a black hole", "[iwp][pmtu]")
+{
+  PathMTU pmtu{Base, 0s};
+  Answer(pmtu, 0s);
+  PathMTU::Time_t now = 0s;
+  for (size_t i = 0; i < PathMTU::Attempts; ++i, now += PathMTU::ProbeInterval)
+    REQUIRE(pmtu.NextProbe(now) == PathMTU::Candidates[0]);
+  REQUIRE(pmtu.NextProbe(now) == PathMTU::Candidates[1]);
+  REQUIRE(pmtu.ProbeAcked(PathMTU::Candidates[1], now));
+  REQUIRE(pmtu.PacketSize() == PathMTU::Candidates[1]);
+
+  now += 5s;
+  pmtu.BlackHole(now);
+  REQUIRE(pmtu.PacketSize() == Base);
+  // and searches again soon, not after the raise interval
+  REQUIRE(pmtu.NextProbeAt() == now + PathMTU::ProbeInterval);
+  REQUIRE(pmtu.NextProbe(now + PathMTU::ProbeInterval) == PathMTU::Candidates[0]);
+}
@@ -0,0 +1,200 @@
+#include <llarp/ev/ev.hpp>
+#include <llarp/iwp/congestion.hpp>
+#include <llarp/link/pump_timers.hpp>
+#include <llarp/link/session.hpp>
+#include <llarp/router_contact.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  /// a session with one fragment in flight that never gets acked, so every pump is a
+  /// retransmission that comes due an rto after the last one, the way iwp::Session asks for them
+  struct RetransmittingSession : public ILinkSession
+  {
+    static constexpr size_t Retransmits = 10;
+
+    iwp::CongestionControl congestion{1s};
+    llarp_time_t lastFlush = 0s;
+    std::vector<llarp_time_t> flushes;
+
+    explicit RetransmittingSession(llarp_time_t now)
+    {
+      // a fast link, the rto bottoms out at MinRTO
+      congestion.OnRTTSample(1ms);
+      lastFlush = now;
+    }
+
+    void
+    Pump() override
+    {}
+
+    /// what Pump does once we are due, with the time we were pumped at
+    void
+    PumpAt(llarp_time_t now)
+    {
+      if (now < lastFlush + congestion.RTO())
+        return;
+      flushes.push_back(now - lastFlush);
+      lastFlush = now;
+    }
+
+    llarp_time_t
+    NextPumpAt(llarp_time_t) const override
+    {
+      if (flushes.size() >= Retransmits)
+        return lastFlush + 1min;
+      return lastFlush + congestion.RTO();
+    }
+
+    void Tick(llarp_time_t) override
+    {}
+
+    bool
+    SendMessageBuffer(Message_t, CompletionHandler, uint16_t) override
+    {
+      return false;
+    }
+
+    void
+    Start() override
+    {}
+
+    void
+    Close() override
+    {}
+
+    bool
+    SendKeepAlive() override
+    {
+      return false;
+    }
+
+    bool
+    IsEstablished() const override
+    {
+      return true;
+    }
+
+    bool
+    TimedOut(llarp_time_t) const override
+    {
+      return false;
+    }
+
+    PubKey
+    GetPubKey() const override
+    {
+      return {};
+    }
+
+    bool
+    IsInbound() const override
+    {
+      return false;
+    }
+
+    const SockAddr&
+    GetRemoteEndpoint() const override
+    {
+      return remote;
+    }
+
+    RouterContact
+    GetRemoteRC() const override
+    {
+      return {};
+    }
+
+    size_t
+    SendQueueBacklog() const override
+    {
+      return 0;
+    }
+
+    ILinkLayer*
+    GetLinkLayer() const override
+    {
+      return nullptr;
+    }
+
+    bool
+    RenegotiateSession() override
+    {
+      return false;
+    }
+
+    bool
+    ShouldPing() const override
+    {
+      return false;
+    }
+
+    SessionStats
+    GetSessionStats() const override
+    {
+      return {};
+    }
+
+    util::StatusObject
+    ExtractStatus() const override
+    {
+      return {};
+    }
+
+    void
+    HandlePlaintext() override
+    {}
+
+    SockAddr remote;
+  };
+}  // namespace
+
+TEST_CASE("Link sessions are pumped when their rto is up, not on the link tick", "[link][pump]")
+{
+  auto loop = EventLoop::create();
+  std::shared_ptr<RetransmittingSession> session;
+  std::promise<void> done;
+
+  // the same thing ILinkLayer does: pump whatever is due and put it back on for its next pump
+  SessionPumpTimers timers{[&](llarp_time_t now) {
+    timers.Advance(now, [&](const auto&) {
+      session->PumpAt(now);
+      if (session->flushes.size() == RetransmittingSession::Retransmits)
+        done.set_value();
+      timers.Schedule(session, std::max(session->NextPumpAt(now), now), now);
+    });
+  }};
+
+  loop->call_soon([&] {
+    const auto now = loop->time_now();
+    session = std::make_shared<RetransmittingSession>(now);
+    timers.Start(loop);
+    timers.Schedule(session, session->NextPumpAt(now), now);
+  });
+  std::thread thread{[loop] { loop->run(); }};
+  const auto status = done.get_future().wait_for(5s);
+  loop->call_soon([&] { timers.Stop(); });
+  loop->stop();
+  thread.join();
+
+  REQUIRE(status == std::future_status::ready);
+  REQUIRE(session->congestion.RTO() == iwp::CongestionControl::MinRTO);
+  for (const auto& interval : session->flushes)
+  {
+    INFO("retransmitted " << interval.count() << "ms after the last send");
+    CHECK(interval >= iwp::CongestionControl::MinRTO);
+  }
+  // a loaded machine can be late now and then, but nothing like the 100ms link layer tick
+  std::sort(session->flushes.begin(), session->flushes.end());
+  const auto median = session->flushes[session->flushes.size() / 2];
+  INFO("median retransmission interval " << median.count() << "ms");
+  REQUIRE(median < iwp::CongestionControl::MinRTO + 2 * SessionPumpTimers::Resolution);
+}
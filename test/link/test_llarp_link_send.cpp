@@ -0,0 +1,233 @@
+#include <llarp/constants/link_layer.hpp>
+#include <llarp/link/link_manager.hpp>
+#include <llarp/link/server.hpp>
+#include <llarp/messages/relay.hpp>
+#include <llarp/router/outbound_message_handler.hpp>
+#include <llarp/util/packet_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using llarp::PacketPool;
+
+namespace
+{
+  /// an established session that keeps every message it is asked to send
+  struct RecordingSession : public llarp::ILinkSession
+  {
+    std::vector<Message_t> sent;
+
+    bool
+    SendMessageBuffer(Message_t msg, CompletionHandler, uint16_t) override
+    {
+      sent.push_back(std::move(msg));
+      return true;
+    }
+
+    void
+    Pump() override
+    {}
+
+    void Tick(llarp_time_t) override
+    {}
+
+    void
+    Start() override
+    {}
+
+    void
+    Close() override
+    {}
+
+    bool
+    SendKeepAlive() override
+    {
+      return false;
+    }
+
+    bool
+    IsEstablished() const override
+    {
+      return true;
+    }
+
+    bool
+    TimedOut(llarp_time_t) const override
+    {
+      return false;
+    }
+
+    llarp::PubKey
+    GetPubKey() const override
+    {
+      return {};
+    }
+
+    bool
+    IsInbound() const override
+    {
+      return false;
+    }
+
+    const llarp::SockAddr&
+    GetRemoteEndpoint() const override
+    {
+      return remote;
+    }
+
+    llarp::RouterContact
+    GetRemoteRC() const override
+    {
+      return {};
+    }
+
+    size_t
+    SendQueueBacklog() const override
+    {
+      return sent.size();
+    }
+
+    llarp::ILinkLayer*
+    GetLinkLayer() const override
+    {
+      return nullptr;
+    }
+
+    bool
+    RenegotiateSession() override
+    {
+      return false;
+    }
+
+    bool
+    ShouldPing() const override
+    {
+      return false;
+    }
+
+    llarp_time_t
+    NextPumpAt(llarp_time_t) const override
+    {
+      return llarp_time_t::max();
+    }
+
+    llarp::SessionStats
+    GetSessionStats() const override
+    {
+      return {};
+    }
+
+    llarp::util::StatusObject
+    ExtractStatus() const override
+    {
+      return {};
+    }
+
+    void
+    HandlePlaintext() override
+    {}
+
+    llarp::SockAddr remote;
+  };
+
+  /// a link layer that only has the sessions we give it, never touches the network
+  struct RecordingLink : public llarp::ILinkLayer
+  {
+    RecordingLink()
+        : ILinkLayer{
+            std::make_shared<llarp::KeyManager>(),
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr,
+            nullptr}
+    {}
+
+    std::shared_ptr<RecordingSession>
+    AddSession(const llarp::RouterID& remote)
+    {
+      auto session = std::make_shared<RecordingSession>();
+      Lock_t l{m_AuthedLinksMutex};
+      m_AuthedLinks.emplace(remote, session);
+      return session;
+    }
+
+    std::shared_ptr<llarp::ILinkSession>
+    NewOutboundSession(const llarp::RouterContact&, const llarp::AddressInfo&) override
+    {
+      return nullptr;
+    }
+
+    void
+    RecvFrom(const llarp::SockAddr&, llarp::ILinkSession::RXPacket_t) override
+    {}
+
+    std::string_view
+    Name() const override
+    {
+      return "recording";
+    }
+
+    uint16_t
+    Rank() const override
+    {
+      return 0;
+    }
+  };
+}  // namespace
+
+TEST_CASE("Relay messages are encoded once and never copied on the way out", "[link]")
+{
+  // the outbound message handler encodes each relay message and hands it to the link manager,
+  // which picks the link layer and session that fragments it
+  constexpr size_t NumMessages = 1000;
+  const auto remote = llarp::RouterID{llarp::PubKey{}};
+  auto link = std::make_shared<RecordingLink>();
+  auto session = link->AddSession(remote);
+  llarp::LinkManager links{};
+  links.AddLink(link);
+
+  llarp::RelayUpstreamMessage msg;
+  // as large as relay traffic gets
+  msg.X = decltype(msg.X){MAX_LINK_MSG_SIZE - 128};
+  msg.X.Randomize();
+  msg.Y.Randomize();
+
+  // warm up, the pool starts out empty
+  {
+    auto warm = PacketPool::LocalLarge().Acquire(MAX_LINK_MSG_SIZE);
+  }
+  const auto before = PacketPool::GlobalStats();
+  size_t copies = 0;
+  size_t bytes = 0;
+  for (size_t n = 0; n < NumMessages; ++n)
+  {
+    auto encoded = llarp::OutboundMessageHandler::EncodeMessage(msg);
+    REQUIRE(encoded);
+    const auto* data = encoded->data();
+    bytes += encoded->size();
+    REQUIRE(links.SendTo(remote, *encoded, nullptr, 0));
+    REQUIRE(session->sent.size() == 1);
+    if (session->sent.back().data() != data)
+      copies++;
+    // the session lets go of it once the remote acked every fragment
+    encoded.reset();
+    session->sent.clear();
+  }
+  const auto after = PacketPool::GlobalStats();
+  const auto allocs = (after.misses - before.misses) + (after.oversized - before.oversized);
+
+  INFO("per relay message: " << double(allocs) / NumMessages << " allocations, "
+                             << double(copies) / NumMessages << " copies of "
+                             << bytes / NumMessages << " bytes");
+  REQUIRE(bytes / NumMessages <= MAX_LINK_MSG_SIZE);
+  REQUIRE(allocs == 0);
+  REQUIRE(copies == 0);
+  REQUIRE(after.outstanding == before.outstanding);
+}
@@ -0,0 +1,149 @@
+#include <llarp/net/ip_range_map.hpp>
+#include <llarp/net/net_bits.hpp>
+#include <llarp/net/traffic_policy.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+
+namespace
+{
+  using namespace llarp;
+
+  huint128_t
+  RandomAddr(std::mt19937_64& rng)
+  {
+    // keep to a few top bits most of the time so ranges actually overlap
+    const auto top = rng() % 4 ? (rng() % 8) << 61 : rng();
+    return huint128_t{uint128_t{top, rng()}};
+  }
+
+  IPRange
+  RandomRange(std::mt19937_64& rng)
+  {
+    if (rng() % 2)
+    {
+      const auto addr = huint32_t{static_cast<uint32_t>(rng() % 4 ? (rng() % 16) << 28 : rng())};
+      return IPRange{net::ExpandV4(addr), netmask_ipv6_bits(96 + rng() % 33)};
+    }
+    return IPRange{RandomAddr(rng), netmask_ipv6_bits(rng() % 129)};
+  }
+}  // namespace
+
+TEST_CASE("IPRangeMap finds the same entries as looking at every range", "[net][ip-range-map]")
+{
+  std::mt19937_64 rng{42};
+  net::IPRangeMap<std::string> map;
+  std::vector<std::pair<IPRange, std::string>> all;
+  for (size_t n = 0; n < 2000; ++n)
+  {
+    auto range = RandomRange(rng);
+    auto value = std::to_string(rng() % 500);
+    map.Insert(range, value);
+    all.emplace_back(range, value);
+  }
+  // netmasks that are not a prefix still have to work
+  const IPRange odd{
+      net::ExpandV4(huint32_t{0x0a000001}), huint128_t{uint128_t{~0UL, 0xffff'ffff'00ff'00ffUL}}};
+  map.Insert(odd, "odd");
+  all.emplace_back(odd, "odd");
+
+  const auto check = [&]() {
+    for (size_t n = 0; n < 2000; ++n)
+    {
+      huint128_t addr;
+      if (n % 2)
+        addr = net::ExpandV4(huint32_t{static_cast<uint32_t>(rng())});
+      else
+        addr = RandomAddr(rng);
+      if (n == 0)
+        addr = net::ExpandV4(huint32_t{0x0a330033});
+
+      std::set<net::IPRangeMap<std::string>::Entry_t> expected;
+      for (const auto& entry : all)
+      {
+        if (entry.first.Contains(addr))
+          expected.insert(entry);
+      }
+      REQUIRE(map.FindAllEntries(addr) == expected);
+    }
+  };
+  check();
+
+  map.RemoveIf([](const auto& entry) { return entry.second.size() == 2; });
+  all.erase(
+      std::remove_if(
+          all.begin(), all.end(), [](const auto& entry) { return entry.second.size() == 2; }),
+      all.end());
+  check();
+
+  CHECK(map.ContainsValue("odd"));
+  CHECK_FALSE(map.ContainsValue("42"));
+  map.RemoveIf([](const auto& entry) { return entry.second == "odd"; });
+  CHECK_FALSE(map.ContainsValue("odd"));
+}
+
+TEST_CASE("IPRangeTrie picks the longest match", "[net][ip-range-map]")
+{
+  net::IPRangeTrie<int> trie;
+  trie.Insert(IPRange::FromIPv4(0, 0, 0, 0, 0), 0);
+  trie.Insert(IPRange::FromIPv4(10, 0, 0, 0, 8), 8);
+  trie.Insert(IPRange::FromIPv4(10, 10, 0, 0, 16), 16);
+  trie.Insert(IPRange::FromIPv4(10, 10, 10, 0, 24), 24);
+
+  const auto longest = [&trie](uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    const auto* val = trie.FindLongestMatch(net::ExpandV4(ipaddr_ipv4_bits(a, b, c, d)));
+    return val ? *val : -1;
+  };
+  CHECK(longest(10, 10, 10, 1) == 24);
+  CHECK(longest(10, 10, 11, 1) == 16);
+  CHECK(longest(10, 11, 10, 1) == 8);
+  CHECK(longest(11, 10, 10, 1) == 0);
+  CHECK(trie.Size() == 4);
+  // ipv6 addresses are not inside any of the ipv4 ranges, 0.0.0.0/0 included
+  CHECK(trie.FindLongestMatch(huint128_t{uint128_t{0xfd00UL << 48, 1}}) == nullptr);
+}
+
+TEST_CASE("TrafficPolicy allows traffic to its ranges", "[net][ip-range-map]")
+{
+  net::TrafficPolicy policy;
+  policy.AddRange(IPRange::FromIPv4(10, 0, 0, 0, 8));
+  policy.AddRange(IPRange::FromIPv4(192, 168, 0, 0, 16));
+
+  const auto packetTo = [](uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    std::vector<byte_t> bytes(20);
+    bytes[0] = 0x45;
+    bytes[16] = a;
+    bytes[17] = b;
+    bytes[18] = c;
+    bytes[19] = d;
+    return net::IPPacket{std::move(bytes)};
+  };
+
+  CHECK(policy.AllowsTraffic(packetTo(10, 1, 2, 3)));
+  CHECK(policy.AllowsTraffic(packetTo(192, 168, 44, 1)));
+  CHECK_FALSE(policy.AllowsTraffic(packetTo(192, 169, 0, 1)));
+  CHECK_FALSE(policy.AllowsTraffic(packetTo(8, 8, 8, 8)));
+
+  // swapping one range for another keeps the same number of ranges, the old one must still go
+  policy.SetRanges({IPRange::FromIPv4(10, 0, 0, 0, 8), IPRange::FromIPv4(8, 8, 8, 0, 24)});
+  REQUIRE(policy.Ranges().size() == 2);
+  CHECK(policy.AllowsTraffic(packetTo(10, 1, 2, 3)));
+  CHECK(policy.AllowsTraffic(packetTo(8, 8, 8, 8)));
+  CHECK_FALSE(policy.AllowsTraffic(packetTo(192, 168, 44, 1)));
+
+  // and a decoded policy is indexed as well
+  std::array<byte_t, 256> tmp{};
+  llarp_buffer_t buf{tmp};
+  REQUIRE(policy.BEncode(&buf));
+  buf.sz = buf.cur - buf.base;
+  buf.cur = buf.base;
+  net::TrafficPolicy decoded;
+  REQUIRE(decoded.BDecode(&buf));
+  CHECK(decoded.Ranges() == policy.Ranges());
+  CHECK(decoded.AllowsTraffic(packetTo(8, 8, 8, 8)));
+  CHECK_FALSE(decoded.AllowsTraffic(packetTo(192, 168, 44, 1)));
+}
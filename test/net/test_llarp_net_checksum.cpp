@@ -0,0 +1,163 @@
+#include <catch2/catch.hpp>
+
+#include <llarp/net/checksum_batch.hpp>
+#include <llarp/net/ip.hpp>
+#include <llarp/net/ip_packet.hpp>
+
+#include <oxenc/endian.h>
+
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+
+  /// a packet of random bytes that is mostly well formed enough to get its checksums rewritten
+  std::vector<byte_t>
+  RandomPacket(std::mt19937_64& rng)
+  {
+    static constexpr uint8_t protos[] = {6, 17, 136, 33, 1, 0, 43, 60, 44};
+    const bool v4 = rng() % 2;
+    std::vector<byte_t> pkt(20 + rng() % 180);
+    for (auto& b : pkt)
+      b = rng();
+    if (v4)
+    {
+      // mostly sane header lengths, sometimes not
+      pkt[0] = 0x40 | (rng() % 4 ? 5 : rng() % 16);
+      pkt[9] = protos[rng() % 4];
+      // mostly not a fragment
+      if (rng() % 4)
+        pkt[6] = pkt[7] = 0;
+    }
+    else
+    {
+      pkt[0] = 0x60 | (pkt[0] & 0x0f);
+      if (pkt.size() > 6)
+        pkt[6] = protos[rng() % std::size(protos)];
+    }
+    return pkt;
+  }
+
+  huint128_t
+  RandomAddr(std::mt19937_64& rng)
+  {
+    return huint128_t{uint128_t{rng(), rng()}};
+  }
+}  // namespace
+
+TEST_CASE("Batched address deltas match the scalar sum", "[net][checksum]")
+{
+  std::mt19937_64 rng{1234};
+  constexpr size_t num = 37;
+  std::vector<uint32_t> old(num * net::AddressLanes), now(num * net::AddressLanes);
+  for (size_t idx = 0; idx < old.size(); ++idx)
+  {
+    old[idx] = rng();
+    now[idx] = rng();
+  }
+  std::vector<uint32_t> got(num);
+  net::address_deltas(old.data(), now.data(), got.data(), num);
+  for (size_t n = 0; n < num; ++n)
+  {
+    uint32_t sum = 0;
+    for (size_t idx = n * net::AddressLanes; idx < (n + 1) * net::AddressLanes; ++idx)
+    {
+      sum += (old[idx] & 0xFFff) + (old[idx] >> 16);
+      sum += (~now[idx] & 0xFFff) + (~now[idx] >> 16);
+    }
+    CHECK(got[n] == sum);
+  }
+}
+
+TEST_CASE("Batched address rewrites match rewriting one packet at a time", "[net][checksum]")
+{
+  std::mt19937_64 rng{5678};
+  for (size_t round = 0; round < 50; ++round)
+  {
+    // go past a chunk now and then, and leave the simd code leftovers
+    const size_t num = 1 + rng() % 150;
+    std::vector<net::IPPacket> batch, single;
+    std::vector<net::AddressRewrite> rewrites;
+    for (size_t n = 0; n < num; ++n)
+    {
+      const auto bytes = RandomPacket(rng);
+      batch.emplace_back(byte_view_t{bytes.data(), bytes.size()});
+      single.emplace_back(byte_view_t{bytes.data(), bytes.size()});
+    }
+    for (auto& pkt : batch)
+      rewrites.push_back(net::AddressRewrite{&pkt, RandomAddr(rng), RandomAddr(rng)});
+
+    net::RewriteAddresses(rewrites.data(), rewrites.size());
+
+    for (size_t n = 0; n < num; ++n)
+    {
+      auto& pkt = single[n];
+      const auto& rw = rewrites[n];
+      if (pkt.IsV4())
+        pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(rw.src)), xhtonl(net::TruncateV6(rw.dst)));
+      else if (pkt.IsV6())
+        pkt.UpdateIPv6Address(rw.src, rw.dst);
+      REQUIRE(batch[n].view() == pkt.view());
+    }
+  }
+}
+
+TEST_CASE("Batched address rewrites leave good checksums good", "[net][checksum]")
+{
+  std::vector<byte_t> bytes(20 + 8 + 32);
+  bytes[0] = 0x45;
+  oxenc::write_host_as_big<uint16_t>(bytes.size(), bytes.data() + 2);
+  bytes[8] = 64;
+  bytes[9] = 17;
+  oxenc::write_host_as_big<uint32_t>(0x0a000001, bytes.data() + 12);
+  oxenc::write_host_as_big<uint32_t>(0x0a000002, bytes.data() + 16);
+  auto* udp = bytes.data() + 20;
+  oxenc::write_host_as_big<uint16_t>(1234, udp);
+  oxenc::write_host_as_big<uint16_t>(53, udp + 2);
+  oxenc::write_host_as_big<uint16_t>(bytes.size() - 20, udp + 4);
+  for (size_t idx = 8; idx < bytes.size() - 20; ++idx)
+    udp[idx] = idx;
+
+  // udp checksum covers a pseudo header of the addresses, protocol and length
+  const auto udpCheck = [](const byte_t* pkt, size_t sz) {
+    uint32_t sum = 0;
+    for (size_t idx = 12; idx < 20; idx += 2)
+    {
+      uint16_t word;
+      std::memcpy(&word, pkt + idx, 2);
+      sum += word;
+    }
+    sum += oxenc::host_to_big<uint16_t>(17);
+    sum += oxenc::host_to_big<uint16_t>(sz - 20);
+    return net::ipchksum(pkt + 20, sz - 20, sum);
+  };
+  const auto ipcheck = net::ipchksum(bytes.data(), 20);
+  std::memcpy(bytes.data() + 10, &ipcheck, 2);
+  const auto l4check = udpCheck(bytes.data(), bytes.size());
+  std::memcpy(udp + 6, &l4check, 2);
+  REQUIRE(udpCheck(bytes.data(), bytes.size()) == 0);
+
+  std::vector<net::IPPacket> pkts;
+  std::vector<net::AddressRewrite> rewrites;
+  for (size_t n = 0; n < 9; ++n)
+    pkts.emplace_back(byte_view_t{bytes.data(), bytes.size()});
+  for (size_t n = 0; n < pkts.size(); ++n)
+    rewrites.push_back(net::AddressRewrite{
+        &pkts[n],
+        net::ExpandV4(huint32_t{0xac100000 + uint32_t(n)}),
+        net::ExpandV4(huint32_t{0xc0a80000 + uint32_t(n) * 77})});
+  net::RewriteAddresses(rewrites.data(), rewrites.size());
+
+  for (size_t n = 0; n < pkts.size(); ++n)
+  {
+    const auto& pkt = pkts[n];
+    CHECK(pkt.srcv4() == huint32_t{0xac100000 + uint32_t(n)});
+    CHECK(pkt.dstv4() == huint32_t{0xc0a80000 + uint32_t(n) * 77});
+    CHECK(net::ipchksum(pkt.data(), 20) == 0);
+    CHECK(udpCheck(pkt.data(), pkt.size()) == 0);
+  }
+}
@@ -0,0 +1,212 @@
+#include <catch2/catch.hpp>
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/offload.hpp>
+
+#include <oxenc/endian.h>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+
+  /// sum the pseudo header and l4 data of pkt, a good checksum comes out as 0
+  uint16_t
+  CheckL4(const std::vector<byte_t>& pkt, size_t ipLen, uint8_t proto)
+  {
+    const bool v4 = (pkt[0] >> 4) == 4;
+    uint32_t sum = 0;
+    const auto* addrs = pkt.data() + (v4 ? 12 : 8);
+    for (size_t idx = 0; idx < (v4 ? 8 : 32); idx += 2)
+    {
+      uint16_t word;
+      std::memcpy(&word, addrs + idx, 2);
+      sum += word;
+    }
+    sum += oxenc::host_to_big<uint16_t>(proto);
+    sum += oxenc::host_to_big<uint16_t>(pkt.size() - ipLen);
+    return net::ipchksum(pkt.data() + ipLen, pkt.size() - ipLen, sum);
+  }
+
+  std::vector<byte_t>
+  MakeTCP(bool v4, size_t payload, byte_t flags)
+  {
+    const size_t ipLen = v4 ? 20 : 40;
+    std::vector<byte_t> pkt(ipLen + 20 + payload);
+    if (v4)
+    {
+      pkt[0] = 0x45;
+      oxenc::write_host_as_big<uint16_t>(pkt.size(), pkt.data() + 2);
+      oxenc::write_host_as_big<uint16_t>(1000, pkt.data() + 4);
+      pkt[8] = 64;
+      pkt[9] = 6;
+      for (size_t idx = 12; idx < 20; ++idx)
+        pkt[idx] = idx;
+    }
+    else
+    {
+      pkt[0] = 0x60;
+      oxenc::write_host_as_big<uint16_t>(pkt.size() - ipLen, pkt.data() + 4);
+      pkt[6] = 6;
+      pkt[7] = 64;
+      for (size_t idx = 8; idx < 40; ++idx)
+        pkt[idx] = idx;
+    }
+    auto* tcp = pkt.data() + ipLen;
+    oxenc::write_host_as_big<uint16_t>(1234, tcp);
+    oxenc::write_host_as_big<uint16_t>(80, tcp + 2);
+    oxenc::write_host_as_big<uint32_t>(0xffff'f000, tcp + 4);
+    tcp[12] = 5 << 4;
+    tcp[13] = flags;
+    for (size_t idx = 0; idx < payload; ++idx)
+      tcp[20 + idx] = idx * 7;
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("Offloaded tcp super packets are cut into segments", "[net][offload]")
+{
+  const bool v4 = GENERATE(true, false);
+  const size_t ipLen = v4 ? 20 : 40;
+  constexpr size_t payload = 2500;
+  constexpr uint16_t mss = 1000;
+  // fin, psh and cwr
+  auto super = MakeTCP(v4, payload, 0x89);
+  const auto original = super;
+
+  net::VNetHeader hdr{};
+  hdr.flags = net::VNetHeader::NeedsChecksum;
+  hdr.gsoType = v4 ? net::VNetHeader::GSOTCPv4 : net::VNetHeader::GSOTCPv6;
+  hdr.gsoSize = mss;
+
+  std::vector<std::vector<byte_t>> segs;
+  REQUIRE(net::SplitOffloaded(hdr, super.data(), super.size(), [&](const byte_t* ptr, size_t sz) {
+    segs.emplace_back(ptr, ptr + sz);
+  }));
+  REQUIRE(segs.size() == 3);
+
+  size_t off = 0;
+  for (size_t n = 0; n < segs.size(); ++n)
+  {
+    const auto& seg = segs[n];
+    const size_t chunk = n + 1 < segs.size() ? mss : payload - 2 * mss;
+    REQUIRE(seg.size() == ipLen + 20 + chunk);
+    const auto* tcp = seg.data() + ipLen;
+
+    if (v4)
+    {
+      CHECK(oxenc::load_big_to_host<uint16_t>(seg.data() + 2) == seg.size());
+      CHECK(oxenc::load_big_to_host<uint16_t>(seg.data() + 4) == 1000 + n);
+      CHECK(net::ipchksum(seg.data(), ipLen) == 0);
+    }
+    else
+      CHECK(oxenc::load_big_to_host<uint16_t>(seg.data() + 4) == seg.size() - ipLen);
+
+    // sequence numbers carry on from one segment to the next, wrapping around
+    CHECK(oxenc::load_big_to_host<uint32_t>(tcp + 4) == uint32_t(0xffff'f000 + off));
+    const bool last = n + 1 == segs.size();
+    CHECK(bool(tcp[13] & 0x01) == last);
+    CHECK(bool(tcp[13] & 0x08) == last);
+    CHECK(bool(tcp[13] & 0x80) == (n == 0));
+    CHECK(CheckL4(seg, ipLen, 6) == 0);
+    CHECK(std::equal(
+        seg.begin() + ipLen + 20, seg.end(), original.begin() + ipLen + 20 + off));
+    off += chunk;
+  }
+}
+
+TEST_CASE("Offloaded packets get their checksums finished", "[net][offload]")
+{
+  auto pkt = MakeTCP(true, 333, 0x10);
+  // what the kernel leaves for us: the pseudo header sum, not inverted, where the checksum goes
+  uint32_t sum = 0;
+  for (size_t idx = 12; idx < 20; idx += 2)
+  {
+    uint16_t word;
+    std::memcpy(&word, pkt.data() + idx, 2);
+    sum += word;
+  }
+  sum += oxenc::host_to_big<uint16_t>(6);
+  sum += oxenc::host_to_big<uint16_t>(pkt.size() - 20);
+  const uint16_t pseudo = ~net::ipchksum(nullptr, 0, sum);
+  std::memcpy(pkt.data() + 20 + 16, &pseudo, 2);
+
+  net::VNetHeader hdr{};
+  hdr.flags = net::VNetHeader::NeedsChecksum;
+  hdr.csumStart = 20;
+  hdr.csumOffset = 16;
+
+  size_t calls = 0;
+  REQUIRE(net::SplitOffloaded(hdr, pkt.data(), pkt.size(), [&](const byte_t* ptr, size_t sz) {
+    ++calls;
+    CHECK(ptr == pkt.data());
+    CHECK(sz == pkt.size());
+  }));
+  CHECK(calls == 1);
+  CHECK(CheckL4(pkt, 20, 6) == 0);
+}
+
+TEST_CASE("Offloaded packets that make no sense are refused", "[net][offload]")
+{
+  auto pkt = MakeTCP(true, 100, 0);
+  net::VNetHeader hdr{};
+  hdr.gsoType = net::VNetHeader::GSOTCPv6;
+  hdr.gsoSize = 50;
+  const auto never = [](const byte_t*, size_t) { FAIL("should not be called"); };
+  // v4 packet claiming to be v6
+  CHECK_FALSE(net::SplitOffloaded(hdr, pkt.data(), pkt.size(), never));
+  // segments too big to ever send
+  hdr.gsoType = net::VNetHeader::GSOTCPv4;
+  hdr.gsoSize = 60000;
+  CHECK_FALSE(net::SplitOffloaded(hdr, pkt.data(), pkt.size(), never));
+  // checksum past the end
+  hdr = net::VNetHeader{};
+  hdr.flags = net::VNetHeader::NeedsChecksum;
+  hdr.csumStart = pkt.size() - 1;
+  hdr.csumOffset = 16;
+  CHECK_FALSE(net::SplitOffloaded(hdr, pkt.data(), pkt.size(), never));
+}
+
+TEST_CASE("IPPackets move their buffer and copy their bytes", "[net]")
+{
+  const auto bytes = MakeTCP(true, 100, 0);
+  net::IPPacket pkt{byte_view_t{bytes.data(), bytes.size()}};
+  REQUIRE(pkt.size() == bytes.size());
+  const auto* const data = pkt.data();
+
+  const auto copies = net::IPPacket::Copies();
+  auto moved = std::move(pkt);
+  CHECK(moved.data() == data);
+  CHECK(pkt.empty());
+  CHECK(net::IPPacket::Copies() == copies);
+
+  auto copied = moved;
+  CHECK(copied.data() != moved.data());
+  CHECK(std::equal(copied.data(), copied.data() + copied.size(), bytes.begin()));
+  CHECK(net::IPPacket::Copies() == copies + 1);
+
+  // buffers from AcquireBuffer have room for a vnet header in front
+  auto buf = moved.steal_buffer();
+  CHECK(moved.empty());
+  CHECK(buf.headroom() >= sizeof(net::VNetHeader));
+}
+
+TEST_CASE("IPPackets take over vectors without copying", "[net]")
+{
+  auto bytes = MakeTCP(true, 100, 0);
+  const auto size = bytes.size();
+  const auto* const data = bytes.data();
+  const auto copies = net::IPPacket::Copies();
+
+  net::IPPacket pkt{std::move(bytes)};
+  REQUIRE(pkt.size() == size);
+  CHECK(pkt.data() == data);
+
+  const auto stolen = pkt.steal();
+  CHECK(stolen.data() == data);
+  CHECK(stolen.size() == size);
+  CHECK(pkt.empty());
+  CHECK(net::IPPacket::Copies() == copies);
+}
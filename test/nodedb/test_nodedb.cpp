@@ -1,10 +1,19 @@
 #include <catch2/catch.hpp>
 
 #include <llarp/config/config.hpp>
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
 #include <llarp/router_contact.hpp>
 #include <llarp/nodedb.hpp>
+#include <llarp/dht/kademlia.hpp>
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <set>
+#include <thread>
 
 using llarp_nodedb = llarp::NodeDB;
+using namespace std::literals;
 
 TEST_CASE("FindClosestTo returns correct number of elements", "[nodedb][dht]")
 {
@@ -65,3 +74,132 @@ TEST_CASE("FindClosestTo returns properly ordered set", "[nodedb][dht]")
   REQUIRE(c.pubkey == results[0].pubkey);
   REQUIRE(b.pubkey == results[1].pubkey);
 }
+
+TEST_CASE("FindManyClosestTo agrees with sorting everything by xor distance", "[nodedb][dht]")
+{
+  llarp_nodedb nodeDB;
+
+  std::vector<llarp::RouterContact> all;
+  for (int i = 0; i < 500; ++i)
+  {
+    llarp::RouterContact rc;
+    rc.pubkey.Randomize();
+    // some keys sharing long prefixes
+    if (i % 5 == 0)
+      std::fill_n(rc.pubkey.begin(), 20, 0x5a);
+    nodeDB.Put(rc);
+    all.push_back(rc);
+  }
+  // replace and remove some so the index has to keep up
+  nodeDB.Put(all[1]);
+  nodeDB.Remove(all[2].pubkey);
+  all.erase(all.begin() + 2);
+  REQUIRE(nodeDB.NumLoaded() == all.size());
+
+  for (int n = 0; n < 50; ++n)
+  {
+    llarp::dht::Key_t key;
+    key.Randomize();
+    if (n % 2 == 0)
+      std::fill_n(key.begin(), 19, 0x5a);
+
+    std::vector<llarp::RouterContact> expected = all;
+    std::sort(expected.begin(), expected.end(), llarp::dht::XorMetric{key});
+
+    const auto results = nodeDB.FindManyClosestTo(key, 16);
+    REQUIRE(results.size() == 16);
+    for (size_t idx = 0; idx < results.size(); ++idx)
+      REQUIRE(results[idx].pubkey == expected[idx].pubkey);
+
+    REQUIRE(nodeDB.FindClosestTo(key).pubkey == expected.front().pubkey);
+  }
+}
+
+TEST_CASE("GetRandom only returns rcs that pass the filter", "[nodedb]")
+{
+  llarp_nodedb nodeDB;
+  REQUIRE_FALSE(nodeDB.GetRandom([](const auto&) { return true; }));
+
+  std::vector<llarp::RouterContact> all;
+  for (int i = 0; i < 100; ++i)
+  {
+    llarp::RouterContact rc;
+    rc.pubkey.Randomize();
+    rc.pubkey[0] = i;
+    nodeDB.Put(rc);
+    all.push_back(rc);
+  }
+  // removing from the middle moves other entries around underneath us
+  for (int i = 0; i < 100; i += 3)
+    nodeDB.Remove(all[i].pubkey);
+
+  // a filter that rejects nearly everything has to fall back to scanning
+  const auto only = all[50].pubkey;
+  const auto maybe = nodeDB.GetRandom([only](const auto& rc) { return rc.pubkey == only; });
+  REQUIRE(maybe);
+  REQUIRE(maybe->pubkey == only);
+
+  REQUIRE_FALSE(nodeDB.GetRandom([&all](const auto& rc) { return rc.pubkey == all[0].pubkey; }));
+
+  std::set<llarp::RouterID> seen;
+  for (int n = 0; n < 2000; ++n)
+  {
+    const auto rc = nodeDB.GetRandom([](const auto& rc) { return rc.pubkey[0] % 2 == 0; });
+    REQUIRE(rc);
+    REQUIRE(rc->pubkey[0] % 2 == 0);
+    REQUIRE(rc->pubkey[0] % 3 != 0);
+    seen.insert(rc->pubkey);
+  }
+  // every even entry we did not remove
+  REQUIRE(seen.size() == 33);
+}
+
+TEST_CASE("NodeDB writes its changes to disk in the order they were made", "[nodedb]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager cmanager(&crypto);
+  auto makeRC = [&]() {
+    llarp::RouterContact rc;
+    llarp::SecretKey sign, encr;
+    crypto.identity_keygen(sign);
+    crypto.encryption_keygen(encr);
+    rc.enckey = encr.toPublic();
+    rc.pubkey = sign.toPublic();
+    rc.last_updated = llarp::time_now_ms();
+    REQUIRE(rc.Sign(sign));
+    return rc;
+  };
+
+  const auto dir = fs::temp_directory_path() / "llarp_test_nodedb_order";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  const auto first = makeRC();
+  const auto second = makeRC();
+  {
+    // every disk job on its own thread, like a pool with nothing else to do would run them
+    std::vector<std::thread> threads;
+    llarp_nodedb nodeDB{dir, [&threads](auto job) { threads.emplace_back(std::move(job)); }};
+    nodeDB.LoadFromDisk();
+
+    const auto now = llarp::time_now_ms();
+    nodeDB.Put(first);
+    nodeDB.Tick(now + 10min);
+    // removing first has to land after putting it or it comes back on the next start
+    nodeDB.Remove(first.pubkey);
+    nodeDB.Put(second);
+    nodeDB.Tick(now + 20min);
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  std::vector<std::thread> threads;
+  llarp_nodedb loaded{dir, [&threads](auto job) { threads.emplace_back(std::move(job)); }};
+  loaded.LoadFromDisk();
+  for (auto& thread : threads)
+    thread.join();
+  CHECK_FALSE(loaded.Has(first.pubkey));
+  CHECK(loaded.Has(second.pubkey));
+  CHECK(loaded.NumLoaded() == 1);
+  fs::remove_all(dir);
+}
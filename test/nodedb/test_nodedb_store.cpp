@@ -0,0 +1,156 @@
+#include <catch2/catch.hpp>
+
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/nodedb_store.hpp>
+#include <llarp/router_contact.hpp>
+#include <llarp/util/file.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager cmanager(&crypto);
+
+  llarp::RouterContact
+  MakeRC()
+  {
+    llarp::RouterContact rc;
+    llarp::SecretKey sign, encr;
+    cmanager.instance()->identity_keygen(sign);
+    cmanager.instance()->encryption_keygen(encr);
+    rc.enckey = encr.toPublic();
+    rc.pubkey = sign.toPublic();
+    REQUIRE(rc.Sign(sign));
+    return rc;
+  }
+
+  struct TempStore
+  {
+    fs::path file = fs::temp_directory_path() / "llarp_test_nodedb_store.dat";
+    llarp::NodeDBStore store{file};
+
+    TempStore()
+    {
+      fs::remove(file);
+    }
+
+    ~TempStore()
+    {
+      fs::remove(file);
+    }
+  };
+}  // namespace
+
+TEST_CASE("NodeDBStore round trips puts and removes", "[nodedb]")
+{
+  TempStore tmp;
+  auto& store = tmp.store;
+
+  std::unordered_map<llarp::RouterID, llarp::RouterContact> rcs;
+  // no file is not a store
+  REQUIRE_FALSE(store.Load(rcs));
+
+  std::vector<llarp::RouterContact> first{MakeRC(), MakeRC(), MakeRC()};
+  REQUIRE(store.Rewrite(first));
+
+  auto second = MakeRC();
+  const llarp::RouterID removed{first[1].pubkey};
+  REQUIRE(store.Append({second}, {removed}));
+
+  const auto records = store.Load(rcs);
+  REQUIRE(records);
+  CHECK(*records == 5);
+  REQUIRE(rcs.size() == 3);
+  CHECK(rcs.count(removed) == 0);
+  CHECK(rcs.at(llarp::RouterID{first[0].pubkey}) == first[0]);
+  CHECK(rcs.at(llarp::RouterID{first[2].pubkey}) == first[2]);
+  CHECK(rcs.at(llarp::RouterID{second.pubkey}) == second);
+
+  // compacting leaves one record per rc
+  std::vector<llarp::RouterContact> live;
+  for (const auto& item : rcs)
+    live.push_back(item.second);
+  REQUIRE(store.Rewrite(live));
+  rcs.clear();
+  CHECK(store.Load(rcs) == 3);
+  CHECK(rcs.size() == 3);
+}
+
+TEST_CASE("NodeDBStore drops a torn record at the end", "[nodedb]")
+{
+  TempStore tmp;
+  auto& store = tmp.store;
+
+  const auto kept = MakeRC();
+  REQUIRE(store.Rewrite({kept}));
+  const auto goodSize = fs::file_size(tmp.file);
+  REQUIRE(store.Append({MakeRC()}, {}));
+
+  // cut the last record short as if we went down halfway through writing it
+  fs::resize_file(tmp.file, fs::file_size(tmp.file) - 3);
+
+  std::unordered_map<llarp::RouterID, llarp::RouterContact> rcs;
+  CHECK(store.Load(rcs) == 1);
+  REQUIRE(rcs.size() == 1);
+  CHECK(rcs.begin()->second == kept);
+  CHECK(fs::file_size(tmp.file) == goodSize);
+
+  // and we can keep appending after it
+  const auto next = MakeRC();
+  REQUIRE(store.Append({next}, {}));
+  rcs.clear();
+  CHECK(store.Load(rcs) == 2);
+  CHECK(rcs.count(llarp::RouterID{next.pubkey}) == 1);
+}
+
+#ifdef __linux__
+TEST_CASE("NodeDBStore takes back a failed append", "[nodedb]")
+{
+  TempStore tmp;
+  auto& store = tmp.store;
+
+  const auto kept = MakeRC();
+  REQUIRE(store.Rewrite({kept}));
+  const auto goodSize = fs::file_size(tmp.file);
+
+  // let a few bytes of the append onto the disk before the file size limit stops it
+  const auto oldHandler = std::signal(SIGXFSZ, SIG_IGN);
+  rlimit oldLimit;
+  REQUIRE(::getrlimit(RLIMIT_FSIZE, &oldLimit) == 0);
+  rlimit limit = oldLimit;
+  limit.rlim_cur = goodSize + 16;
+  REQUIRE(::setrlimit(RLIMIT_FSIZE, &limit) == 0);
+  const bool appended = store.Append({MakeRC()}, {});
+  ::setrlimit(RLIMIT_FSIZE, &oldLimit);
+  std::signal(SIGXFSZ, oldHandler);
+
+  REQUIRE_FALSE(appended);
+  CHECK(fs::file_size(tmp.file) == goodSize);
+
+  // what we append next is not lost behind a torn record
+  const auto next = MakeRC();
+  REQUIRE(store.Append({next}, {}));
+  std::unordered_map<llarp::RouterID, llarp::RouterContact> rcs;
+  CHECK(store.Load(rcs) == 2);
+  CHECK(rcs.count(llarp::RouterID{kept.pubkey}) == 1);
+  CHECK(rcs.count(llarp::RouterID{next.pubkey}) == 1);
+}
+#endif
+
+TEST_CASE("NodeDBStore refuses files that are not a store", "[nodedb]")
+{
+  TempStore tmp;
+  llarp::util::dump_file(tmp.file, std::string{"definitely not a nodedb"});
+
+  std::unordered_map<llarp::RouterID, llarp::RouterContact> rcs;
+  CHECK_FALSE(tmp.store.Load(rcs));
+  CHECK(rcs.empty());
+}
@@ -0,0 +1,58 @@
+#include <llarp/config/config.hpp>
+#include <llarp/path/hop_selection.hpp>
+#include <llarp/net/ip.hpp>
+#include <llarp/net/net_bits.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+#include <vector>
+
+namespace
+{
+  llarp::RouterContact
+  MakeRC(uint8_t id, uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+  {
+    llarp::RouterContact rc;
+    rc.pubkey[0] = id;
+    llarp::AddressInfo ai{};
+    ai.ip = llarp::net::HUIntToIn6(llarp::net::ExpandV4(llarp::ipaddr_ipv4_bits(a, b, c, d)));
+    rc.addrs.push_back(ai);
+    return rc;
+  }
+}  // namespace
+
+TEST_CASE("hop selection keys are checked like whole rcs", "[path]")
+{
+  llarp::PeerSelectionConfig conf{};
+  conf.m_UniqueHopsNetmaskSize = 24;
+
+  const std::vector<llarp::RouterContact> rcs{
+      MakeRC(1, 10, 0, 0, 1),
+      MakeRC(2, 10, 0, 1, 1),
+      MakeRC(3, 10, 0, 0, 2),
+      MakeRC(4, 10, 1, 0, 1),
+      MakeRC(5, 10, 0, 1, 9)};
+
+  // every subset of rcs, the last one in it is the candidate and the rest are the hops so far
+  for (unsigned mask = 1; mask < (1u << rcs.size()); ++mask)
+  {
+    std::set<llarp::RouterContact> all;
+    std::vector<llarp::path::HopSelectionKey> keys;
+    for (size_t idx = 0; idx < rcs.size(); ++idx)
+    {
+      if (mask & (1u << idx))
+      {
+        all.insert(rcs[idx]);
+        keys.emplace_back(rcs[idx]);
+      }
+    }
+    const auto candidate = keys.back();
+    keys.pop_back();
+    REQUIRE(conf.Acceptable(candidate, keys.data(), keys.size()) == conf.Acceptable(all));
+  }
+
+  conf.m_UniqueHopsNetmaskSize = 0;
+  const llarp::path::HopSelectionKey same{rcs[0]};
+  REQUIRE(conf.Acceptable(same, &same, 1));
+}
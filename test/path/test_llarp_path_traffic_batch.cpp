@@ -0,0 +1,181 @@
+#include <llarp/crypto/encrypted.hpp>
+#include <llarp/path/traffic_batch.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <functional>
+#include <set>
+#include <vector>
+
+using namespace llarp;
+
+namespace
+{
+  struct FakeRelayMessage
+  {
+    Encrypted<64> X;
+    TunnelNonce Y;
+  };
+
+  using Batch_t = path::TrafficBatch<FakeRelayMessage>;
+}  // namespace
+
+TEST_CASE("TrafficBatch push and crypt items", "[path]")
+{
+  Batch_t batch;
+  REQUIRE(batch.empty());
+  REQUIRE(batch.begin() == batch.end());
+
+  std::array<byte_t, 16> data;
+  data.fill(0x42);
+  TunnelNonce nonce;
+  nonce.Randomize();
+  REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+  REQUIRE(batch.size() == 1);
+
+  const auto& msg = *batch.begin();
+  REQUIRE(msg.X.size() == data.size());
+  REQUIRE(std::equal(data.begin(), data.end(), msg.X.data()));
+  REQUIRE(msg.Y == nonce);
+
+  const auto items = batch.CryptItems();
+  REQUIRE(items[0].data == batch.begin()->X.data());
+  REQUIRE(items[0].size == data.size());
+  REQUIRE(items[0].nonce == nonce);
+}
+
+TEST_CASE("TrafficBatch limits", "[path]")
+{
+  Batch_t batch;
+  TunnelNonce nonce;
+
+  SECTION("too big for a message")
+  {
+    std::array<byte_t, 65> data{};
+    REQUIRE_FALSE(batch.Push(llarp_buffer_t{data}, nonce));
+    REQUIRE(batch.empty());
+  }
+
+  SECTION("full")
+  {
+    std::array<byte_t, 8> data{};
+    for (size_t idx = 0; idx < Batch_t::Capacity; ++idx)
+      REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+    REQUIRE(batch.full());
+    REQUIRE_FALSE(batch.Push(llarp_buffer_t{data}, nonce));
+    REQUIRE(batch.size() == Batch_t::Capacity);
+  }
+}
+
+TEST_CASE("TrafficBatch reuses slots", "[path]")
+{
+  std::array<byte_t, 8> data{};
+  TunnelNonce nonce;
+  const FakeRelayMessage* slot = nullptr;
+  {
+    Batch_t batch;
+    REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+    slot = &*batch.begin();
+  }
+
+  Batch_t batch;
+  REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+  REQUIRE(&*batch.begin() == slot);
+
+  // moving hands the slots over and leaves the old batch empty
+  Batch_t other{std::move(batch)};
+  REQUIRE(batch.empty());
+  REQUIRE(other.size() == 1);
+  REQUIRE(&*other.begin() == slot);
+}
+
+TEST_CASE("TrafficBatch slots are shared between hops one at a time", "[path]")
+{
+  std::array<byte_t, 8> data{};
+  TunnelNonce nonce;
+  std::set<const FakeRelayMessage*> used;
+  {
+    // two hops with a message each only hold a slot each
+    Batch_t first, second;
+    REQUIRE(first.Push(llarp_buffer_t{data}, nonce));
+    REQUIRE(second.Push(llarp_buffer_t{data}, nonce));
+    used.insert(&*first.begin());
+    used.insert(&*second.begin());
+  }
+  const auto free = Batch_t::FreeSlots();
+  REQUIRE(free >= 2);
+
+  // and another hop picks up both of them
+  Batch_t third;
+  REQUIRE(third.Push(llarp_buffer_t{data}, nonce));
+  REQUIRE(third.Push(llarp_buffer_t{data}, nonce));
+  for (const auto& msg : third)
+    REQUIRE(used.count(&msg));
+  REQUIRE(Batch_t::FreeSlots() == free - 2);
+
+  // a message too big for a slot gives the slot straight back
+  std::array<byte_t, 65> big{};
+  REQUIRE_FALSE(third.Push(llarp_buffer_t{big}, nonce));
+  REQUIRE(Batch_t::FreeSlots() == free - 2);
+}
+
+TEST_CASE("TrafficBatch keeps a bounded number of free slots", "[path]")
+{
+  std::array<byte_t, 8> data{};
+  TunnelNonce nonce;
+  {
+    std::vector<Batch_t> batches(Batch_t::MaxFree / Batch_t::Capacity + 2);
+    for (auto& batch : batches)
+    {
+      while (not batch.full())
+        REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+    }
+  }
+  REQUIRE(Batch_t::FreeSlots() == Batch_t::MaxFree);
+}
+
+TEST_CASE("BatchHandoff carries a batch through a std::function", "[path]")
+{
+  using Handoff_t = path::BatchHandoff<Batch_t>;
+  std::array<byte_t, 8> data{};
+  TunnelNonce nonce;
+  Batch_t batch;
+  REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+  const auto* slot = &*batch.begin();
+
+  std::function<void(void)> job = [handoff = Handoff_t{std::move(batch)}, slot]() mutable {
+    auto taken = handoff.Take();
+    REQUIRE(taken.size() == 1);
+    REQUIRE(&*taken.begin() == slot);
+  };
+  auto copy = job;
+  job = nullptr;
+  copy();
+  copy = nullptr;
+
+  // the holder is parked for the next handoff instead of freed
+  const auto free = Handoff_t::FreeHolders();
+  REQUIRE(free >= 1);
+  {
+    Handoff_t handoff{Batch_t{}};
+    REQUIRE(Handoff_t::FreeHolders() == free - 1);
+  }
+  REQUIRE(Handoff_t::FreeHolders() == free);
+}
+
+TEST_CASE("BatchHandoff gives messages back when the job never runs", "[path]")
+{
+  using Handoff_t = path::BatchHandoff<Batch_t>;
+  std::array<byte_t, 8> data{};
+  TunnelNonce nonce;
+  Batch_t batch;
+  REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+  REQUIRE(batch.Push(llarp_buffer_t{data}, nonce));
+  const auto free = Batch_t::FreeSlots();
+  {
+    std::function<void(void)> job = [handoff = Handoff_t{std::move(batch)}]() mutable {
+      handoff.Take();
+    };
+  }
+  REQUIRE(Batch_t::FreeSlots() == std::min(free + 2, Batch_t::MaxFree));
+}
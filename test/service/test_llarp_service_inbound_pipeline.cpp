@@ -0,0 +1,180 @@
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/service/inbound_pipeline.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace llarp;
+using service::InboundFramePipeline;
+
+namespace
+{
+  /// a pipeline whose worker pool only runs jobs when we say so, on an event loop that is us
+  struct PipelineHarness
+  {
+    service::Identity remote;
+    SharedSecret sessionKey;
+
+    std::vector<InboundFramePipeline::Job_t> work;
+    std::vector<std::shared_ptr<service::ProtocolMessage>> delivered;
+    size_t failed = 0;
+
+    InboundFramePipeline pipeline{InboundFramePipeline::Handlers{
+        [this](auto job) { work.push_back(std::move(job)); },
+        [](auto job) { job(); },
+        []() {},
+        [this](auto, auto, auto msg) { delivered.push_back(std::move(msg)); },
+        [this](auto, auto, auto) { failed++; }}};
+
+    PipelineHarness()
+    {
+      remote.RegenerateKeys();
+      sessionKey.Randomize();
+    }
+
+    /// a data frame the remote sent us on tag
+    service::ProtocolFrame
+    Frame(const service::ConvoTag& tag, uint64_t seqno)
+    {
+      service::ProtocolMessage msg;
+      msg.sender = remote.pub;
+      msg.tag = tag;
+      msg.seqno = seqno;
+      service::ProtocolFrame frame;
+      frame.N.Randomize();
+      frame.T = tag;
+      REQUIRE(frame.EncryptAndMAC(msg, sessionKey));
+      return frame;
+    }
+
+    void
+    Push(const service::ProtocolFrame& frame)
+    {
+      pipeline.Push(nullptr, frame, sessionKey, remote.pub, nullptr);
+    }
+
+    /// run the worker job queued idx'th since the last Flush
+    void
+    RunWork(size_t idx)
+    {
+      REQUIRE(idx < work.size());
+      REQUIRE(work[idx]);
+      auto job = std::move(work[idx]);
+      work[idx] = nullptr;
+      job();
+    }
+
+    std::vector<uint64_t>
+    DeliveredSeqNos() const
+    {
+      std::vector<uint64_t> seqnos;
+      for (const auto& msg : delivered)
+        seqnos.push_back(msg->seqno);
+      return seqnos;
+    }
+  };
+}  // namespace
+
+TEST_CASE("Inbound frame pipeline releases chunks oldest first", "[service][pipeline]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  PipelineHarness harness;
+  service::ConvoTag tag;
+  tag.Randomize();
+
+  std::vector<uint64_t> sent;
+  for (uint64_t seqno = 0; seqno < 2 * InboundFramePipeline::ChunkSize; ++seqno)
+  {
+    harness.Push(harness.Frame(tag, seqno));
+    sent.push_back(seqno);
+  }
+  harness.pipeline.Flush();
+  REQUIRE(harness.work.size() == 2);
+  REQUIRE(harness.pipeline.Depth() == sent.size());
+
+  // the second chunk is done first but has to wait for the one in front of it
+  harness.RunWork(1);
+  harness.pipeline.Flush();
+  CHECK(harness.delivered.empty());
+
+  harness.RunWork(0);
+  harness.pipeline.Flush();
+  CHECK(harness.DeliveredSeqNos() == sent);
+  CHECK(harness.failed == 0);
+  CHECK(harness.pipeline.Depth() == 0);
+}
+
+TEST_CASE("Inbound frame pipeline sorts each tag within a released run", "[service][pipeline]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  PipelineHarness harness;
+  service::ConvoTag first, second;
+  first.Randomize();
+  second.Randomize();
+
+  // two sessions interleaved, each arriving out of order, spread over two chunks
+  const std::vector<std::pair<service::ConvoTag, uint64_t>> arrivals{
+      {first, 5}, {second, 3}, {first, 1}, {first, 4}, {second, 0}, {first, 0},
+      {second, 2}, {first, 3}, {second, 1}, {first, 2}, {first, 9}, {second, 4},
+      {first, 7}, {first, 8}, {second, 6}, {first, 6}, {second, 5}, {second, 7}};
+  REQUIRE(arrivals.size() > InboundFramePipeline::ChunkSize);
+  for (const auto& [tag, seqno] : arrivals)
+    harness.Push(harness.Frame(tag, seqno));
+  harness.pipeline.Flush();
+  REQUIRE(harness.work.size() == 2);
+  harness.RunWork(1);
+  harness.RunWork(0);
+  harness.pipeline.Flush();
+  REQUIRE(harness.delivered.size() == arrivals.size());
+
+  std::map<service::ConvoTag, std::vector<uint64_t>> perTag;
+  for (size_t idx = 0; idx < harness.delivered.size(); ++idx)
+  {
+    const auto& msg = harness.delivered[idx];
+    // a tag's messages come out in one go
+    if (idx > 0 and harness.delivered[idx - 1]->tag != msg->tag)
+      CHECK(perTag.count(msg->tag) == 0);
+    perTag[msg->tag].push_back(msg->seqno);
+  }
+  REQUIRE(perTag.size() == 2);
+  for (const auto& [tag, seqnos] : perTag)
+    CHECK(std::is_sorted(seqnos.begin(), seqnos.end()));
+  CHECK(perTag[first].size() == 10);
+  CHECK(perTag[second].size() == 8);
+}
+
+TEST_CASE("Inbound frame pipeline drops frames past MaxInFlight", "[service][pipeline]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  PipelineHarness harness;
+  service::ConvoTag tag;
+  tag.Randomize();
+  const auto frame = harness.Frame(tag, 0);
+
+  constexpr size_t Extra = 10;
+  for (size_t n = 0; n < InboundFramePipeline::MaxInFlight + Extra; ++n)
+    harness.Push(frame);
+  CHECK(harness.pipeline.Depth() == InboundFramePipeline::MaxInFlight);
+  CHECK(harness.pipeline.ExtractStatus()["dropped"] == Extra);
+
+  // what the workers hold still counts
+  harness.pipeline.Flush();
+  harness.Push(frame);
+  CHECK(harness.pipeline.ExtractStatus()["dropped"] == Extra + 1);
+
+  for (size_t idx = 0; idx < harness.work.size(); ++idx)
+    harness.RunWork(idx);
+  harness.work.clear();
+  harness.pipeline.Flush();
+  CHECK(harness.delivered.size() == InboundFramePipeline::MaxInFlight);
+  CHECK(harness.pipeline.Depth() == 0);
+
+  // and once they are done there is room again
+  harness.Push(frame);
+  CHECK(harness.pipeline.Depth() == 1);
+  CHECK(harness.pipeline.ExtractStatus()["dropped"] == Extra + 1);
+}
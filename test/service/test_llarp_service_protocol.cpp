@@ -0,0 +1,76 @@
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/service/protocol.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("ProtocolFrame session mac", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+
+  SharedSecret sessionKey;
+  sessionKey.Randomize();
+  // both ends of the session
+  service::Identity alice, bob;
+  alice.RegenerateKeys();
+  bob.RegenerateKeys();
+  const auto& sender = alice.pub.Addr();
+
+  service::ProtocolMessage msg;
+  msg.sender = alice.pub;
+  msg.tag.Randomize();
+  msg.seqno = 42;
+  std::array<byte_t, 128> payload;
+  payload.fill(0x42);
+  msg.PutBuffer(llarp_buffer_t{payload});
+
+  service::ProtocolFrame frame;
+  frame.N.Randomize();
+  frame.T = msg.tag;
+  REQUIRE(frame.EncryptAndMAC(msg, sessionKey));
+  REQUIRE(frame.HasMAC());
+  REQUIRE(frame.Z.IsZero());
+  REQUIRE(frame.VerifyMAC(sessionKey, sender));
+
+  SECTION("decrypts")
+  {
+    service::ProtocolMessage got;
+    REQUIRE(frame.DecryptPayloadInto(sessionKey, got));
+    REQUIRE(got.seqno == msg.seqno);
+    REQUIRE(got.payload == msg.payload);
+  }
+
+  SECTION("survives encoding")
+  {
+    std::array<byte_t, service::MAX_PROTOCOL_MESSAGE_SIZE> tmp;
+    llarp_buffer_t buf{tmp};
+    REQUIRE(frame.BEncode(&buf));
+    buf.sz = buf.cur - buf.base;
+    buf.cur = buf.base;
+    service::ProtocolFrame decoded;
+    REQUIRE(decoded.BDecode(&buf));
+    REQUIRE(decoded == frame);
+    REQUIRE(decoded.VerifyMAC(sessionKey, sender));
+  }
+
+  SECTION("wrong key")
+  {
+    SharedSecret other;
+    other.Randomize();
+    REQUIRE_FALSE(frame.VerifyMAC(other, sender));
+  }
+
+  SECTION("reflected back to its sender")
+  {
+    // alice's own frame sent back to her looks like it came from bob on the same session
+    REQUIRE_FALSE(frame.VerifyMAC(sessionKey, bob.pub.Addr()));
+  }
+
+  SECTION("tampered")
+  {
+    frame.D.data()[0] ^= 1;
+    REQUIRE_FALSE(frame.VerifyMAC(sessionKey, sender));
+  }
+}
@@ -2,8 +2,10 @@
 
 #include <llarp/crypto/crypto.hpp>
 #include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/rc_verify_cache.hpp>
 #include <llarp/router_contact.hpp>
 #include <llarp/net/net_int.hpp>
+#include <llarp/util/thread/work_pool.hpp>
 #include <llarp/util/time.hpp>
 
 namespace
@@ -123,4 +125,78 @@ TEST_CASE("RouterContact Decode Mixed Versions", "[RC][RouterContact]")
     REQUIRE(rc_vec[i] == rc_vec_out[i]);
 }
 
+TEST_CASE("RCVerifyCache skips signatures it has seen", "[RC][RouterContact][signature][verify]")
+{
+  std::vector<RouterContact> rcs(RCVerifyCache::ParallelThreshold * 2);
+  for (auto& rc : rcs)
+  {
+    SecretKey sign, encr;
+    cmanager.instance()->identity_keygen(sign);
+    cmanager.instance()->encryption_keygen(encr);
+    rc.version = 1;
+    rc.enckey = encr.toPublic();
+    rc.pubkey = sign.toPublic();
+    REQUIRE(rc.Sign(sign));
+  }
+  // a bad signature is never remembered
+  rcs[3].signature[0] ^= 1;
+
+  RCVerifyCache cache;
+  std::vector<const RouterContact*> check;
+  for (const auto& rc : rcs)
+    check.push_back(&rc);
+
+  auto good = cache.VerifyMany(check);
+  for (size_t idx = 0; idx < rcs.size(); ++idx)
+    CHECK(good[idx] == (idx != 3));
+  CHECK(cache.Hits() == 0);
+  CHECK(cache.Misses() == rcs.size());
+  CHECK(cache.Size() == rcs.size() - 1);
+
+  good = cache.VerifyMany(check);
+  for (size_t idx = 0; idx < rcs.size(); ++idx)
+    CHECK(good[idx] == (idx != 3));
+  CHECK(cache.Hits() == rcs.size() - 1);
+
+  CHECK(rcs[0].Verify(time_now_ms(), true, cache));
+  CHECK_FALSE(rcs[3].Verify(time_now_ms(), true, cache));
+  CHECK(cache.Hits() == rcs.size());
+
+  // what we save comes back as hits
+  const auto file = fs::temp_directory_path() / "llarp_test_rc_verify_cache.dat";
+  REQUIRE(cache.Save(file));
+  RCVerifyCache loaded;
+  CHECK(loaded.Load(file) == rcs.size() - 1);
+  fs::remove(file);
+  CHECK(loaded.VerifySignature(rcs[1]));
+  CHECK(loaded.Hits() == 1);
+  CHECK(loaded.Misses() == 0);
+
+  // spreading the checks over workers gets the same answers
+  thread::WorkPool workers{3};
+  RCVerifyCache spread;
+  good = spread.VerifyMany(check, &workers);
+  for (size_t idx = 0; idx < rcs.size(); ++idx)
+    CHECK(good[idx] == (idx != 3));
+  CHECK(spread.Size() == rcs.size() - 1);
+  workers.Stop();
+  CHECK(workers.Completed() > 0);
+}
+
+TEST_CASE("RCVerifyCache forgets the oldest digests", "[RC][RouterContact]")
+{
+  RCVerifyCache cache{2};
+  RCVerifyCache::Digest_t a, b, c;
+  a.Randomize();
+  b.Randomize();
+  c.Randomize();
+  cache.Add(a);
+  cache.Add(b);
+  cache.Add(c);
+  CHECK(cache.Size() == 2);
+  CHECK_FALSE(cache.Contains(a));
+  CHECK(cache.Contains(b));
+  CHECK(cache.Contains(c));
+}
+
 } // namespace llarp
@@ -0,0 +1,87 @@
+#include <llarp/util/deficit_round_robin.hpp>
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <string>
+
+using DRR = llarp::util::DeficitRoundRobin<std::string, int>;
+
+TEST_CASE("deficit round robin shares bytes, not entries", "[util][drr]")
+{
+  DRR drr{1000};
+  // one flow sends large entries, the other small ones
+  for (int i = 0; i < 100; ++i)
+  {
+    int big = i, small = i;
+    REQUIRE(drr.Push("big", big, 1000));
+    for (int j = 0; j < 10; ++j)
+      REQUIRE(drr.Push("small", small, 100));
+  }
+  REQUIRE(drr.Flows() == 2);
+  REQUIRE(drr.Queued() == 1100);
+  REQUIRE(drr.Bytes() == 200'000);
+
+  std::map<size_t, size_t> bytes;
+  size_t total = 0;
+  while (total < 50'000)
+  {
+    auto maybe = drr.Pop();
+    REQUIRE(maybe);
+    bytes[maybe->second] += maybe->second;
+    total += maybe->second;
+  }
+  REQUIRE(bytes[1000] == bytes[100]);
+}
+
+TEST_CASE("deficit round robin keeps each flow in order", "[util][drr]")
+{
+  DRR drr{500};
+  for (int i = 0; i < 10; ++i)
+  {
+    int a = i, b = i + 100;
+    drr.Push("a", a, 300);
+    drr.Push("b", b, 700);
+  }
+  int nextA = 0, nextB = 100;
+  while (auto maybe = drr.Pop())
+  {
+    if (maybe->first < 100)
+      REQUIRE(maybe->first == nextA++);
+    else
+      REQUIRE(maybe->first == nextB++);
+  }
+  REQUIRE(nextA == 10);
+  REQUIRE(nextB == 110);
+  REQUIRE(drr.Empty());
+  REQUIRE(drr.Flows() == 0);
+  REQUIRE(drr.Bytes() == 0);
+}
+
+TEST_CASE("deficit round robin bounds flows and drops removed ones", "[util][drr]")
+{
+  DRR drr{100};
+  for (int i = 0; i < 5; ++i)
+  {
+    int val = i;
+    REQUIRE(drr.Push("a", val, 10, 3) == (i < 3));
+    // a rejected entry is left to the caller
+    if (i >= 3)
+      REQUIRE(val == i);
+  }
+  int val = 42;
+  REQUIRE(drr.Push("b", val, 10));
+  REQUIRE(drr.Queued() == 4);
+  REQUIRE(drr.Queued("a") == 3);
+  REQUIRE(drr.Queued("nothing") == 0);
+
+  size_t dropped = 0;
+  drr.Remove("a", [&dropped](int) { dropped++; });
+  REQUIRE(dropped == 3);
+  REQUIRE(drr.Flows() == 1);
+  drr.Remove("nothing", [](int) { FAIL("nothing to drop"); });
+
+  auto maybe = drr.Pop();
+  REQUIRE(maybe);
+  REQUIRE(maybe->first == 42);
+  REQUIRE_FALSE(drr.Pop());
+}
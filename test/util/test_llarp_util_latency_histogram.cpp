@@ -0,0 +1,41 @@
+#include <llarp/util/latency_histogram.hpp>
+#include <catch2/catch.hpp>
+
+using llarp::util::LatencyHistogram;
+
+TEST_CASE("LatencyHistogram buckets samples by upper bound", "[histogram]")
+{
+  LatencyHistogram hist;
+  REQUIRE(hist.Count() == 0);
+  REQUIRE(hist.Mean() == 0us);
+
+  hist.Add(50us);
+  hist.Add(100us);
+  hist.Add(101us);
+  hist.Add(3ms);
+  hist.Add(1s);
+
+  REQUIRE(hist.Count() == 5);
+  REQUIRE(hist.BucketCount(0) == 2);
+  REQUIRE(hist.BucketCount(1) == 1);
+  REQUIRE(hist.BucketCount(5) == 1);
+  REQUIRE(hist.BucketCount(LatencyHistogram::Bounds.size()) == 1);
+  REQUIRE(hist.Max() == 1s);
+  REQUIRE(hist.Mean() == (50us + 100us + 101us + 3ms + 1s) / 5);
+
+  auto status = hist.ExtractStatus();
+  REQUIRE(status["count"].get<uint64_t>() == 5);
+  REQUIRE(status["buckets"].size() == LatencyHistogram::Bounds.size() + 1);
+
+  hist.Clear();
+  REQUIRE(hist.Count() == 0);
+  REQUIRE(hist.Max() == 0us);
+}
+
+TEST_CASE("LatencyHistogram clamps negative samples to zero", "[histogram]")
+{
+  LatencyHistogram hist;
+  hist.Add(-5us);
+  REQUIRE(hist.BucketCount(0) == 1);
+  REQUIRE(hist.Max() == 0us);
+}
@@ -0,0 +1,156 @@
+#include <llarp/util/packet_pool.hpp>
+#include <llarp/constants/link_layer.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+using llarp::PacketBuffer;
+using llarp::PacketPool;
+
+TEST_CASE("PacketPool reuses released slabs", "[packet-pool]")
+{
+  auto& pool = PacketPool::Local();
+  // warm up the pool so we have at least one free slab
+  {
+    auto warm = pool.Acquire();
+  }
+  const auto before = PacketPool::GlobalStats();
+  {
+    auto buf = pool.Acquire(1200);
+    REQUIRE(buf.size() == 1200);
+    REQUIRE(buf.capacity() == PacketPool::SlabSize);
+  }
+  const auto after = PacketPool::GlobalStats();
+  REQUIRE(after.hits == before.hits + 1);
+  REQUIRE(after.misses == before.misses);
+  REQUIRE(after.outstanding == before.outstanding);
+}
+
+TEST_CASE("PacketBuffer copies share memory", "[packet-pool]")
+{
+  auto& pool = PacketPool::Local();
+  const std::string_view data{"hello world"};
+  auto buf = pool.Copy(reinterpret_cast<const byte_t*>(data.data()), data.size());
+  REQUIRE(buf.use_count() == 1);
+  {
+    PacketBuffer other{buf};
+    REQUIRE(buf.use_count() == 2);
+    REQUIRE(other.data() == buf.data());
+    other[0] = 'j';
+  }
+  REQUIRE(buf.use_count() == 1);
+  REQUIRE(buf[0] == 'j');
+
+  auto moved = std::move(buf);
+  REQUIRE(not buf);
+  REQUIRE(moved.use_count() == 1);
+  REQUIRE(moved.size() == data.size());
+}
+
+TEST_CASE("PacketBuffer slices", "[packet-pool]")
+{
+  auto& pool = PacketPool::Local();
+  auto buf = pool.Acquire(100);
+  for (size_t idx = 0; idx < buf.size(); ++idx)
+    buf[idx] = idx;
+  auto sliced = buf.slice(10, 20);
+  REQUIRE(sliced.size() == 20);
+  REQUIRE(sliced[0] == 10);
+  REQUIRE(sliced.data() == buf.data() + 10);
+  REQUIRE(buf.use_count() == 2);
+  buf = PacketBuffer{};
+  REQUIRE(sliced.use_count() == 1);
+  REQUIRE(sliced[19] == 29);
+}
+
+TEST_CASE("PacketBuffer oversized allocations bypass the pool", "[packet-pool]")
+{
+  const auto before = PacketPool::GlobalStats();
+  {
+    auto buf = PacketPool::Local().Acquire(PacketPool::SlabSize * 4);
+    REQUIRE(buf.size() == PacketPool::SlabSize * 4);
+  }
+  const auto after = PacketPool::GlobalStats();
+  REQUIRE(after.oversized == before.oversized + 1);
+  REQUIRE(after.outstanding == before.outstanding);
+}
+
+TEST_CASE("PacketBuffer outlives the thread that allocated it", "[packet-pool]")
+{
+  PacketBuffer buf;
+  std::thread{[&buf] { buf = PacketPool::Local().Acquire(64); }}.join();
+  REQUIRE(buf.size() == 64);
+  buf[63] = 1;
+  buf = PacketBuffer{};
+}
+
+TEST_CASE("PacketBuffer headroom", "[packet-pool]")
+{
+  auto buf = PacketPool::Local().Acquire(100, 16);
+  REQUIRE(buf.size() == 100);
+  REQUIRE(buf.headroom() == 16);
+  REQUIRE(buf.capacity() == PacketPool::SlabSize - 16);
+  buf[0] = 42;
+  auto* const start = buf.data();
+
+  REQUIRE(buf.push_front(10));
+  REQUIRE(buf.data() == start - 10);
+  REQUIRE(buf.size() == 110);
+  REQUIRE(buf[10] == 42);
+  REQUIRE(buf.headroom() == 6);
+  REQUIRE_FALSE(buf.push_front(7));
+  REQUIRE(buf.size() == 110);
+
+  buf.pull_front(10);
+  REQUIRE(buf.data() == start);
+  REQUIRE(buf[0] == 42);
+  REQUIRE(buf.headroom() == 16);
+}
+
+TEST_CASE("PacketBuffer adopts a vector without copying it", "[packet-pool]")
+{
+  std::vector<byte_t> vec(300, 7);
+  const auto* const mem = vec.data();
+  auto buf = PacketPool::Adopt(std::move(vec));
+  REQUIRE(buf.data() == mem);
+  REQUIRE(buf.size() == 300);
+  REQUIRE(buf.headroom() == 0);
+  REQUIRE_FALSE(buf.push_front(1));
+
+  // someone else looking at it means we have to copy
+  {
+    const auto other = buf;
+    const auto copied = PacketBuffer{buf}.take();
+    REQUIRE(copied.data() != mem);
+    REQUIRE(copied.size() == 300);
+  }
+
+  // and once we are alone we get the same memory back, cut down to our view
+  buf.resize(200);
+  const auto back = buf.take();
+  REQUIRE(back.data() == mem);
+  REQUIRE(back.size() == 200);
+  REQUIRE(buf.empty());
+  REQUIRE_FALSE(buf);
+}
+
+TEST_CASE("PacketPool large slabs hold a whole link message", "[packet-pool]")
+{
+  auto& pool = PacketPool::LocalLarge();
+  REQUIRE(&pool != &PacketPool::Local());
+  const auto before = PacketPool::GlobalStats();
+  {
+    auto buf = pool.Acquire(MAX_LINK_MSG_SIZE);
+    REQUIRE(buf.capacity() == PacketPool::LargeSlabSize);
+  }
+  {
+    auto buf = pool.Acquire(MAX_LINK_MSG_SIZE);
+  }
+  const auto after = PacketPool::GlobalStats();
+  REQUIRE(after.oversized == before.oversized);
+  REQUIRE(after.hits + after.misses == before.hits + before.misses + 2);
+  REQUIRE(after.hits >= before.hits + 1);
+  REQUIRE(after.outstanding == before.outstanding);
+}
@@ -0,0 +1,117 @@
+#include <llarp/util/reorder_window.hpp>
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using ReorderWindows_t = llarp::util::ReorderWindows<int, int>;
+
+TEST_CASE("ReorderWindows puts each flow back in order", "[reorder-window]")
+{
+  static constexpr llarp_time_t now = 10s;
+  ReorderWindows_t windows{10ms, 8};
+  std::vector<int> out;
+  const auto release = [&out](int val) { out.push_back(val); };
+
+  windows.Push(1, 5, 5, now, release);
+  windows.Push(1, 7, 7, now, release);
+  windows.Push(1, 8, 8, now, release);
+  // a gap on flow 1 does not hold up flow 2
+  windows.Push(2, 100, 100, now, release);
+  REQUIRE(out == std::vector<int>{5, 100});
+  REQUIRE(windows.Held() == 2);
+
+  windows.Push(1, 6, 6, now + 1ms, release);
+  REQUIRE(out == std::vector<int>{5, 100, 6, 7, 8});
+  REQUIRE(windows.Held() == 0);
+  REQUIRE(windows.NextExpiry() == std::nullopt);
+  REQUIRE(windows.Skipped() == 0);
+}
+
+TEST_CASE("ReorderWindows gives up on gaps after a while", "[reorder-window]")
+{
+  static constexpr llarp_time_t now = 10s;
+  ReorderWindows_t windows{10ms, 8};
+  std::vector<int> out;
+  const auto release = [&out](int val) { out.push_back(val); };
+
+  windows.Push(1, 0, 0, now, release);
+  windows.Push(1, 2, 2, now, release);
+  windows.Push(1, 3, 3, now + 5ms, release);
+  windows.Push(1, 5, 5, now + 8ms, release);
+  REQUIRE(windows.NextExpiry() == now + 10ms);
+
+  windows.Expire(now + 9ms, release);
+  REQUIRE(out == std::vector<int>{0});
+
+  // 2 timed out and 3 is right behind it, 5 still waits on 4
+  windows.Expire(now + 10ms, release);
+  REQUIRE(out == std::vector<int>{0, 2, 3});
+  REQUIRE(windows.Skipped() == 1);
+  REQUIRE(windows.NextExpiry() == now + 18ms);
+
+  // 1 shows up after we stopped waiting on it
+  windows.Push(1, 1, 1, now + 11ms, release);
+  REQUIRE(out == std::vector<int>{0, 2, 3, 1});
+  REQUIRE(windows.Late() == 1);
+
+  windows.Expire(now + 18ms, release);
+  REQUIRE(out == std::vector<int>{0, 2, 3, 1, 5});
+  REQUIRE(windows.Held() == 0);
+
+  // idle flows are forgotten
+  REQUIRE(windows.Flows() == 1);
+  windows.Expire(now + 2min, release);
+  REQUIRE(windows.Flows() == 0);
+}
+
+TEST_CASE("ReorderWindows holds a bounded number of values per flow", "[reorder-window]")
+{
+  static constexpr llarp_time_t now = 10s;
+  ReorderWindows_t windows{10ms, 4};
+  std::vector<int> out;
+  const auto release = [&out](int val) { out.push_back(val); };
+
+  windows.Push(1, 0, 0, now, release);
+  for (int seqno = 2; seqno < 6; ++seqno)
+    windows.Push(1, seqno, seqno, now, release);
+  REQUIRE(out == std::vector<int>{0});
+  REQUIRE(windows.Held() == 4);
+
+  // one more than we hold pushes the gap out and everything in order behind it
+  windows.Push(1, 7, 7, now, release);
+  REQUIRE(out == std::vector<int>{0, 2, 3, 4, 5});
+  REQUIRE(windows.Held() == 1);
+  REQUIRE(windows.Skipped() == 1);
+
+  // duplicates of a held value are dropped
+  windows.Push(1, 7, 7, now, release);
+  REQUIRE(windows.Held() == 1);
+}
+
+TEST_CASE("ReorderWindows does not wait on seqnos that were passed", "[reorder-window]")
+{
+  static constexpr llarp_time_t now = 10s;
+  ReorderWindows_t windows{10ms, 8};
+  std::vector<int> out;
+  const auto release = [&out](int val) { out.push_back(val); };
+
+  windows.Push(1, 0, 0, now, release);
+  // 1 was used up by something else, 2 goes straight out
+  windows.Pass(1, 1, now, release);
+  windows.Push(1, 2, 2, now, release);
+  REQUIRE(out == std::vector<int>{0, 2});
+
+  // passed out of order it fills the gap the same as a value would, without a release
+  windows.Push(1, 4, 4, now, release);
+  windows.Pass(1, 3, now, release);
+  REQUIRE(out == std::vector<int>{0, 2, 4});
+
+  // and a passed seqno ahead of a gap only holds its place
+  windows.Pass(1, 6, now, release);
+  windows.Push(1, 7, 7, now, release);
+  windows.Push(1, 5, 5, now, release);
+  REQUIRE(out == std::vector<int>{0, 2, 4, 5, 7});
+  REQUIRE(windows.Held() == 0);
+  REQUIRE(windows.Skipped() == 0);
+  REQUIRE(windows.Late() == 0);
+}
@@ -0,0 +1,96 @@
+#include <llarp/util/timer_wheel.hpp>
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using TimerWheel_t = llarp::util::TimerWheel<int>;
+
+TEST_CASE("TimerWheel pops values once they are due", "[timer-wheel]")
+{
+  static constexpr llarp_time_t now = 10s;
+  TimerWheel_t wheel{100ms, 16};
+  wheel.Schedule(now + 150ms, 1);
+  wheel.Schedule(now + 300ms, 2);
+  REQUIRE(wheel.Size() == 2);
+
+  std::vector<int> popped;
+  const auto visit = [&popped](auto, int val) { popped.push_back(val); };
+
+  wheel.Advance(now, visit);
+  REQUIRE(popped.empty());
+  wheel.Advance(now + 100ms, visit);
+  REQUIRE(popped.empty());
+  wheel.Advance(now + 200ms, visit);
+  REQUIRE(popped == std::vector<int>{1});
+  wheel.Advance(now + 300ms, visit);
+  REQUIRE(popped == std::vector<int>{1, 2});
+  REQUIRE(wheel.Empty());
+}
+
+TEST_CASE("TimerWheel keeps values further out than one revolution", "[timer-wheel]")
+{
+  static constexpr llarp_time_t now = 10s;
+  TimerWheel_t wheel{100ms, 4};
+  wheel.Schedule(now + 1s, 1);
+
+  std::vector<int> popped;
+  const auto visit = [&popped](auto, int val) { popped.push_back(val); };
+
+  for (llarp_time_t t = now; t < now + 1s; t += 100ms)
+    wheel.Advance(t, visit);
+  REQUIRE(popped.empty());
+  wheel.Advance(now + 1s, visit);
+  REQUIRE(popped == std::vector<int>{1});
+}
+
+TEST_CASE("TimerWheel catches up after a long gap", "[timer-wheel]")
+{
+  static constexpr llarp_time_t now = 10s;
+  TimerWheel_t wheel{100ms, 8};
+  wheel.Advance(now, [](auto, int) {});
+  for (int i = 0; i < 8; ++i)
+    wheel.Schedule(now + (i + 1) * 100ms, i);
+  wheel.Schedule(now + 1min, 100);
+
+  size_t popped = 0;
+  wheel.Advance(now + 30s, [&popped](auto, int) { popped++; });
+  REQUIRE(popped == 8);
+  REQUIRE(wheel.Size() == 1);
+}
+
+TEST_CASE("TimerWheel values scheduled in the past fire on the next advance", "[timer-wheel]")
+{
+  static constexpr llarp_time_t now = 10s;
+  TimerWheel_t wheel{100ms, 8};
+  wheel.Advance(now, [](auto, int) {});
+  wheel.Schedule(now - 5s, 1);
+
+  std::vector<int> popped;
+  // values scheduled from inside the visitor are not popped by the same advance
+  wheel.Advance(now + 100ms, [&](auto, int val) {
+    popped.push_back(val);
+    wheel.Schedule(now, val + 1);
+  });
+  REQUIRE(popped == std::vector<int>{1});
+  wheel.Advance(now + 200ms, [&](auto, int val) { popped.push_back(val); });
+  REQUIRE(popped == std::vector<int>{1, 2});
+}
+
+TEST_CASE("TimerWheel knows when it next has something due", "[timer-wheel]")
+{
+  static constexpr llarp_time_t now = 10s;
+  TimerWheel_t wheel{5ms, 8};
+  REQUIRE(wheel.NextDue() == std::nullopt);
+  wheel.Advance(now, [](auto, int) {});
+
+  // a revolution is only 40ms, this one shares a slot with the one after it
+  wheel.Schedule(now + 1s + 7ms, 1);
+  REQUIRE(wheel.NextDue() == now + 1s + 10ms);
+  wheel.Schedule(now + 7ms, 2);
+  REQUIRE(wheel.NextDue() == now + 10ms);
+
+  std::vector<int> popped;
+  wheel.Advance(*wheel.NextDue(), [&popped](auto, int val) { popped.push_back(val); });
+  REQUIRE(popped == std::vector<int>{2});
+  REQUIRE(wheel.NextDue() == now + 1s + 10ms);
+}
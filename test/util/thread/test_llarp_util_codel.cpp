@@ -0,0 +1,173 @@
+#include <llarp/util/thread/codel.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <utility>
+
+using namespace llarp::thread;
+using namespace std::literals;
+
+namespace
+{
+  /// a sender that backs off on loss and otherwise keeps speeding up, like tcp or our own link
+  /// layer, pushing through a queue in front of a link that takes one item per ms, the way a path
+  /// flow of the outbound message handler is drained.  with a target nothing waits longer than
+  /// codel never drops and the queue only drops what does not fit.
+  struct LinkSim
+  {
+    static constexpr size_t Capacity = 512;
+    static constexpr auto Duration = 20s;
+    /// only the second half counts, once the sender found the link rate
+    static constexpr auto Warmup = 10s;
+    /// the sender hears about a loss after this and only backs off once per this
+    static constexpr auto RTT = 40ms;
+
+    explicit LinkSim(CoDel::Time_t target) : codel{target}
+    {}
+
+    /// what was sent and when it was queued
+    std::deque<std::pair<int, CoDel::Time_t>> queue;
+    CoDel codel;
+    uint64_t tailDropped = 0;
+
+    double rate = 0.5;
+    double credit = 0;
+    CoDel::Time_t lastBackoff = 0s;
+
+    size_t delivered = 0;
+    CoDel::Time_t totalSojourn = 0s;
+    CoDel::Time_t maxSojourn = 0s;
+
+    void
+    Lost(CoDel::Time_t now)
+    {
+      if (now - lastBackoff < RTT)
+        return;
+      rate = std::max(rate / 2, 0.05);
+      lastBackoff = now;
+    }
+
+    /// take the first thing codel does not drop off the queue
+    std::optional<int>
+    PopFront(CoDel::Time_t now)
+    {
+      while (not queue.empty())
+      {
+        const auto [value, queued] = queue.front();
+        queue.pop_front();
+        if (not codel.ShouldDrop(now - queued, now, not queue.empty()))
+          return value;
+        Lost(now);
+      }
+      return std::nullopt;
+    }
+
+    void
+    Run()
+    {
+      // codel never sees a time of 0
+      for (auto now = 1ms; now < Duration; now += 1ms)
+      {
+        rate += 0.002;
+        for (credit += rate; credit >= 1; credit -= 1)
+        {
+          if (queue.size() < Capacity)
+            queue.emplace_back(now.count(), now);
+          else
+          {
+            tailDropped++;
+            Lost(now);
+          }
+        }
+        auto item = PopFront(now);
+        if (not item or now < Warmup)
+          continue;
+        const auto sojourn = now - CoDel::Time_t{*item};
+        delivered++;
+        totalSojourn += sojourn;
+        maxSojourn = std::max(maxSojourn, sojourn);
+      }
+    }
+
+    CoDel::Time_t
+    MeanSojourn() const
+    {
+      return totalSojourn / std::max<size_t>(delivered, 1);
+    }
+
+    double
+    Utilization() const
+    {
+      return double(delivered) / CoDel::Time_t{Duration - Warmup}.count();
+    }
+  };
+}  // namespace
+
+TEST_CASE("CoDel leaves short bursts alone", "[codel]")
+{
+  CoDel codel;
+  CoDel::Time_t now = 1s;
+  // everything waited well over target, but not for a whole interval
+  for (size_t n = 0; n < 50; ++n, now += 1ms)
+    REQUIRE_FALSE(codel.ShouldDrop(50ms, now, true));
+  // and as soon as it is back under target we start over
+  REQUIRE_FALSE(codel.ShouldDrop(1ms, now, true));
+  for (size_t n = 0; n < 90; ++n, now += 1ms)
+    REQUIRE_FALSE(codel.ShouldDrop(50ms, now, true));
+  // nor do we drop the last thing in the queue
+  now += 1s;
+  REQUIRE_FALSE(codel.ShouldDrop(50ms, now, false));
+  REQUIRE(codel.Dropped() == 0);
+}
+
+TEST_CASE("CoDel drops more often the longer a standing queue lasts", "[codel]")
+{
+  CoDel codel;
+  CoDel::Time_t now = 1s;
+  std::vector<CoDel::Time_t> drops;
+  for (; now < 3s; now += 1ms)
+  {
+    if (codel.ShouldDrop(20ms, now, true))
+      drops.push_back(now);
+  }
+  REQUIRE(codel.DropStates() == 1);
+  REQUIRE(codel.Dropping());
+  REQUIRE(drops.size() > 10);
+  // first drop an interval after it went above target
+  REQUIRE(drops.front() == 1s + CoDel::DefaultInterval);
+  // and the gaps between drops shrink
+  REQUIRE(drops[1] - drops[0] > drops.back() - drops[drops.size() - 2]);
+
+  // back under target and we stop
+  REQUIRE_FALSE(codel.ShouldDrop(1ms, now, true));
+  REQUIRE_FALSE(codel.Dropping());
+}
+
+TEST_CASE("CoDel keeps queueing delay bounded above link rate", "[codel]")
+{
+  LinkSim fifo{CoDel::Time_t::max()};
+  fifo.Run();
+  LinkSim codel{CoDel::DefaultTarget};
+  codel.Run();
+
+  INFO("fifo: mean sojourn " << fifo.MeanSojourn().count() << "ms, max "
+                             << fifo.maxSojourn.count() << "ms, utilization "
+                             << fifo.Utilization());
+  INFO("codel: mean sojourn " << codel.MeanSojourn().count() << "ms, max "
+                              << codel.maxSojourn.count() << "ms, utilization "
+                              << codel.Utilization() << ", dropped "
+                              << codel.codel.Dropped() << ", tail dropped "
+                              << codel.tailDropped);
+
+  // a tail dropping fifo sits full of standing queue
+  REQUIRE(fifo.MeanSojourn() > 200ms);
+  // codel keeps it around target without giving up much of the link
+  REQUIRE(codel.MeanSojourn() < 50ms);
+  REQUIRE(codel.maxSojourn < 200ms);
+  REQUIRE(codel.tailDropped == 0);
+  REQUIRE(codel.Utilization() > 0.8);
+  REQUIRE(fifo.codel.Dropped() == 0);
+}
@@ -0,0 +1,72 @@
+#include <llarp/util/thread/work_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+using llarp::thread::WorkPool;
+
+using namespace std::literals;
+
+TEST_CASE("WorkPool runs every submitted job", "[work-pool]")
+{
+  std::atomic<size_t> ran{0};
+  {
+    WorkPool pool{4, 64};
+    REQUIRE(pool.NumThreads() == 4);
+    for (size_t n = 0; n < 200; ++n)
+    {
+      while (not pool.TrySubmit([&ran] { ran++; }))
+        std::this_thread::yield();
+    }
+    pool.Stop();
+    REQUIRE(pool.Completed() == 200);
+    REQUIRE(pool.Queued() == 0);
+    REQUIRE(pool.Running() == 0);
+  }
+  REQUIRE(ran == 200);
+}
+
+TEST_CASE("WorkPool workers steal from busy workers", "[work-pool]")
+{
+  WorkPool pool{2, 64};
+  std::atomic<bool> release{false};
+  std::atomic<size_t> ran{0};
+
+  // keep one worker busy, everything queued behind it has to be stolen by the other
+  REQUIRE(pool.TrySubmit([&release] {
+    while (not release)
+      std::this_thread::sleep_for(1ms);
+  }));
+  while (pool.Running() == 0)
+    std::this_thread::sleep_for(1ms);
+  for (size_t n = 0; n < 20; ++n)
+    REQUIRE(pool.TrySubmit([&ran] { ran++; }));
+  while (ran < 20)
+    std::this_thread::sleep_for(1ms);
+  release = true;
+  pool.Stop();
+  REQUIRE(pool.Stolen() > 0);
+  REQUIRE(pool.Completed() == 21);
+}
+
+TEST_CASE("WorkPool turns jobs away when stopped or full", "[work-pool]")
+{
+  WorkPool pool{1, 2};
+  std::atomic<bool> release{false};
+  REQUIRE(pool.TrySubmit([&release] {
+    while (not release)
+      std::this_thread::sleep_for(1ms);
+  }));
+  while (pool.Running() == 0)
+    std::this_thread::sleep_for(1ms);
+  REQUIRE(pool.TrySubmit([] {}));
+  REQUIRE(pool.TrySubmit([] {}));
+  REQUIRE_FALSE(pool.TrySubmit([] {}));
+  REQUIRE(pool.Rejected() == 1);
+  release = true;
+  pool.Stop();
+  REQUIRE_FALSE(pool.TrySubmit([] {}));
+}